@@ -16,3 +16,4 @@
 #pragma once
 
 #include <dd/learn/learn_hello.h>
+#include <dd/learn/learn_benchmark.h>
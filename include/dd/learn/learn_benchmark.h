@@ -0,0 +1,31 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::learn {
+
+    /* Compares util::FlatHashMap against std::unordered_map for the key sizes used by the caches */
+    void BenchmarkFlatHashMap();
+
+    /* Per sample cost of a minified texture read from level 0 against its mip, with CPU caches standing in for the texture cache */
+    void BenchmarkMipSampling();
+
+    /* Bytes copied and time to first use of the sample's files, loaded into a new buffer against read from a mapped view */
+    void BenchmarkFileAccess();
+
+    /* Decode MB/s of a LoadStbImages batch on one thread against every core */
+    void BenchmarkImageDecode();
+}
@@ -19,9 +19,9 @@ namespace dd::learn {
 
     void SetupTriangle();
 
-    void CalcTriangle();
+    void CalcTriangle(float step_time);
 
-    void DrawTriangle(vk::CommandBuffer *command_buffer);
+    void DrawTriangle(vk::CommandBuffer *command_buffer, float alpha);
 
     void CleanTriangle();
 }
@@ -15,4 +15,15 @@
  */
 #pragma once
 
-#include <dd/res/res_fileloader.hpp>
\ No newline at end of file
+#include <dd/res/res_fileloader.hpp>
+#include <dd/res/res_lz.hpp>
+#include <dd/res/res_mappedfile.hpp>
+#include <dd/res/res_ioqueue.hpp>
+#include <dd/res/res_archive.hpp>
+#include <dd/res/res_mipmap.hpp>
+#include <dd/res/res_bcencoder.hpp>
+#include <dd/res/res_cookedtexture.hpp>
+#include <dd/res/res_resourcecache.hpp>
+#include <dd/res/res_meshoptimizer.hpp>
+#include <dd/res/res_meshsimplifier.hpp>
+#include <dd/res/res_mesh.hpp>
\ No newline at end of file
@@ -0,0 +1,109 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    /*
+     * Single file archive
+     *
+     * [ArchiveHeader][ArchiveEntry array][Slot array][Name data] ... [4 KiB aligned blobs]
+     *
+     * Slots are an open addressed table of entry indices keyed by util::HashString of the entry name.
+     * Uncompressed blobs are consumed in place from the mapped archive.
+     */
+    constexpr u32 ArchiveMagic     = 0x5241'4444; /* "DDAR" */
+    constexpr u32 ArchiveVersion   = 1;
+    constexpr u32 ArchiveAlignment = 0x1000;
+    constexpr u32 ArchiveEmptySlot = 0xffff'ffff;
+
+    enum ArchiveCompression : u32 {
+        ArchiveCompression_None = 0,
+        ArchiveCompression_Lz   = 1,
+    };
+
+    struct ArchiveHeader {
+        u32 magic;
+        u32 version;
+        u32 entry_count;
+        u32 slot_count;
+        u64 entry_offset;
+        u64 slot_offset;
+        u64 name_offset;
+        u64 name_size;
+        u64 file_size;
+    };
+    static_assert(sizeof(ArchiveHeader) == 0x38);
+
+    struct ArchiveEntry {
+        u64                name_hash;
+        u64                offset;
+        u64                size;
+        u64                stored_size;
+        u32                name_offset;
+        ArchiveCompression compression;
+    };
+    static_assert(sizeof(ArchiveEntry) == 0x28);
+
+    class Archive {
+        private:
+            MappedFile           m_file;
+            const ArchiveHeader *m_header;
+            const ArchiveEntry  *m_entry_array;
+            const u32           *m_slot_array;
+            const char          *m_name_data;
+        public:
+            constexpr Archive() : m_file(), m_header(nullptr), m_entry_array(nullptr), m_slot_array(nullptr), m_name_data(nullptr) {/*...*/}
+
+            void Initialize(const char *path);
+            void Finalize();
+
+            /* Returns nullptr if missing */
+            const ArchiveEntry *FindEntry(u64 name_hash) const;
+
+            const ArchiveEntry *FindEntry(const char *name) const {
+                return this->FindEntry(util::HashString(name));
+            }
+
+            /* Zero copy access, only valid for uncompressed entries until Finalize */
+            const void *GetEntryView(const ArchiveEntry *entry) const {
+                DD_ASSERT(entry->compression == ArchiveCompression_None);
+                return m_file.GetViewAs<u8>(entry->offset);
+            }
+
+            /* Copies or decompresses into a buffer of entry->size bytes */
+            void ReadEntry(const ArchiveEntry *entry, void *out_buffer) const;
+
+            /* Hints the kernel to page in an entry ahead of use */
+            void PrefetchEntry(const ArchiveEntry *entry) {
+                m_file.Prefetch(entry->offset, entry->stored_size);
+            }
+
+            const char *GetEntryName(const ArchiveEntry *entry) const { return m_name_data + entry->name_offset; }
+
+            constexpr ALWAYS_INLINE u32                 GetEntryCount()      const { return m_header->entry_count; }
+            constexpr ALWAYS_INLINE const ArchiveEntry *GetEntry(u32 index)  const { return std::addressof(m_entry_array[index]); }
+    };
+
+    struct ArchivePackEntry {
+        const char *path;
+        const char *name;
+        bool        is_compressible;
+    };
+
+    /* Compressed blobs are kept only when they save at least 1/8 of the entry */
+    void PackArchive(const char *archive_path, const ArchivePackEntry *pack_entry_array, u32 pack_entry_count);
+}
@@ -0,0 +1,66 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    enum BcFormat : u32 {
+        BcFormat_Bc1 = 0, /* RGB, 8 bytes per block, alpha is dropped */
+        BcFormat_Bc3 = 1, /* RGBA, BC1 color with an 8 step alpha block */
+        BcFormat_Bc7 = 2, /* RGBA, 16 bytes per block */
+    };
+
+    /* BC7 search effort, BC1 and BC3 always refine once */
+    enum BcQuality : u32 {
+        BcQuality_Fast   = 0, /* Mode 6, principal axis endpoints */
+        BcQuality_Normal = 1, /* Mode 6 with least squares endpoint refinement */
+        BcQuality_Slow   = 2, /* Modes 5 and 6 with every channel rotation and p-bit pair */
+    };
+
+    constexpr u32 BcBlockDimension = 4;
+    constexpr u32 MaxBcEncodeThreads = 64;
+    constexpr u32 BcEncodeWorkerStackSize = 0x10000;
+
+    constexpr ALWAYS_INLINE u32 GetBcBlockSize(BcFormat format) {
+        return (format == BcFormat_Bc1) ? 8 : 16;
+    }
+
+    constexpr ALWAYS_INLINE size_t CalcBcImageSize(BcFormat format, u32 width, u32 height) {
+        const size_t block_count_x = (width + BcBlockDimension - 1) / BcBlockDimension;
+        const size_t block_count_y = (height + BcBlockDimension - 1) / BcBlockDimension;
+        return block_count_x * block_count_y * GetBcBlockSize(format);
+    }
+
+    /* Blocks are 16 RGBA8 texels in row order */
+    void EncodeBc1Block(void *out_block, const u8 *block_rgba);
+    void EncodeBc3Block(void *out_block, const u8 *block_rgba);
+    void EncodeBc7Block(void *out_block, const u8 *block_rgba, BcQuality quality);
+
+    struct BcEncodeInfo {
+        BcFormat  format;
+        BcQuality quality;
+        u32       thread_count;
+
+        constexpr void SetDefaults() {
+            format       = BcFormat_Bc7;
+            quality      = BcQuality_Normal;
+            thread_count = 0;
+        }
+    };
+
+    /* Encodes a tightly packed RGBA8 image on thread_count threads including the caller, 0 uses every core. Partial edge blocks replicate the last row and column */
+    void EncodeBcImage(void *out_blocks, const u8 *image_rgba, u32 width, u32 height, const BcEncodeInfo *bc_encode_info);
+}
@@ -0,0 +1,98 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    /*
+     * Cooked texture
+     *
+     * [CookedTextureHeader][Mip 0]...[Mip n]
+     *
+     * Texels are stored in upload order, rows already flipped and channels expanded, so loading is only I/O.
+     * Uncompressed textures are RGBA8 with a block dimension of 1, block compressed textures use 4x4 blocks.
+     */
+    constexpr u32 CookedTextureMagic        = 0x5854'4444; /* "DDTX" */
+    constexpr u32 CookedTextureVersion      = 2;
+    constexpr u32 MaxCookedTextureMips      = 16;
+    constexpr u32 CookedTextureMipAlignment = 0x200;
+
+    enum CookedTextureFlag : u32 {
+        CookedTextureFlag_None        = 0,
+        CookedTextureFlag_Srgb        = (1 << 0),
+        CookedTextureFlag_FlippedRows = (1 << 1),
+    };
+
+    struct CookedTextureMip {
+        u64 offset;
+        u64 size;
+        u32 width;
+        u32 height;
+    };
+    static_assert(sizeof(CookedTextureMip) == 0x18);
+
+    struct CookedTextureHeader {
+        u32              magic;
+        u32              version;
+        u32              width;
+        u32              height;
+        u32              mip_levels;
+        u32              vk_format;
+        u32              flags;
+        u16              block_dimension;
+        u16              block_size;
+        CookedTextureMip mip_array[MaxCookedTextureMips];
+    };
+    static_assert(sizeof(CookedTextureHeader) <= CookedTextureMipAlignment);
+
+    struct CookTextureInfo {
+        bool      is_srgb;
+        bool      is_mipmapped;
+        bool      is_block_compressed;
+        MipFilter mip_filter;
+        BcFormat  bc_format;
+        BcQuality bc_quality;
+
+        constexpr void SetDefaults() {
+            is_srgb             = true;
+            is_mipmapped        = true;
+            is_block_compressed = false;
+            mip_filter          = MipFilter_Box;
+            bc_format           = BcFormat_Bc7;
+            bc_quality          = BcQuality_Normal;
+        }
+    };
+
+    /* Decodes source_path with stb and writes a cooked texture */
+    void CookTexture(const char *cooked_path, const char *source_path, const CookTextureInfo *cook_texture_info);
+
+    struct CookedTexture {
+        MappedFile                 file;
+        const CookedTextureHeader *header;
+
+        const void *GetMipData(u32 level) const {
+            DD_ASSERT(level < header->mip_levels);
+            return file.GetViewAs<u8>(header->mip_array[level].offset);
+        }
+
+        constexpr ALWAYS_INLINE const CookedTextureMip *GetMip(u32 level) const { return std::addressof(header->mip_array[level]); }
+    };
+
+    /* Maps and validates a cooked texture, the mips stay readable until FreeCookedTexture */
+    void LoadCookedTexture(const char *path, CookedTexture *out_cooked_texture);
+
+    void FreeCookedTexture(CookedTexture *cooked_texture);
+}
@@ -17,11 +17,64 @@
 
 namespace dd::res {
 
+    struct FileStats {
+        u64 bytes_copied;
+        u64 bytes_mapped;
+        u32 copy_count;
+        u32 map_count;
+    };
+
+    namespace impl {
+        void RecordCopiedBytes(u64 size);
+        void RecordMappedBytes(u64 size);
+    }
+
+    /* Totals since startup, copies are loads into new buffers and maps are MappedFile views */
+    void GetFileStats(FileStats *out_file_stats);
+
     void LoadFile(const char *path, void **out_file, u32 *out_file_size);
 
     void LoadTextFile(const char *path, char **out_file, u32 *out_file_size);
 
     void LoadStbImage(const char *path, s32 desired_channels, unsigned char **out_image_data, s32 *out_width, s32 *out_height, s32 *out_channels);
 
+    struct StbImageLoad {
+        const char    *path;
+        const void    *file;
+        u32            file_size;
+        s32            desired_channels;
+        unsigned char *destination;
+        size_t         destination_size;
+
+        unsigned char *image_data;
+        s32            width;
+        s32            height;
+        s32            channels;
+        bool           is_success;
+    };
+
+    struct StbImageBatchStats {
+        u64    file_bytes;
+        u64    decoded_bytes;
+        s64    decode_tick;
+        u32    thread_count;
+        u32    in_place_count;
+        double decode_mb_per_second;
+    };
+
+    /*
+     * Decodes a batch on thread_count threads including the caller, 0 uses every core.
+     * Images are read from file when set, else mapped from path. An image that fits its destination is decoded in place,
+     * falling back to a copy when stb needs the space for an intermediate. Otherwise image_data keeps the stb allocation
+     * and must be released with FreeStbImage.
+     */
+    void LoadStbImages(StbImageLoad *load_array, u32 load_count, u32 thread_count, StbImageBatchStats *out_stats);
+
+    /* For file data already in memory, such as an IoQueue read */
+    void DecodeStbImage(const void *file, u32 file_size, s32 desired_channels, unsigned char **out_image_data, s32 *out_width, s32 *out_height, s32 *out_channels);
+
+    /* Reads the header only, channels are the channels in the file */
+    bool GetStbImageInfo(const void *file, u32 file_size, s32 *out_width, s32 *out_height, s32 *out_channels);
+
     void FreeStbImage(unsigned char *image_data);
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    struct IoRequest;
+
+    using IoCallback = void (*)(IoRequest *request);
+
+    enum IoResult : u32 {
+        IoResult_Pending    = 0,
+        IoResult_Success    = 1,
+        IoResult_OpenFailed = 2,
+        IoResult_ReadFailed = 3,
+    };
+
+    /* Caller owned, must stay alive until delivered. Fields past user_data are written by the queue */
+    struct IoRequest {
+        const char *path;
+        void       *buffer;
+        u64         offset;
+        u32         size;
+        IoCallback  callback;
+        void       *user_data;
+
+        u32      bytes_read;
+        IoResult result;
+
+        OVERLAPPED              overlapped;
+        Handle                  file;
+        IoRequest              *pending_next;
+        util::IntrusiveMpscNode completion_node;
+    };
+
+    struct IoQueueInfo {
+        u32  worker_count;
+        u32  worker_stack_size;
+        u32  max_in_flight;
+        bool is_completion_port_disabled;
+
+        constexpr void SetDefaults() {
+            worker_count                = 2;
+            worker_stack_size           = 0x4000;
+            max_in_flight               = 64;
+            is_completion_port_disabled = false;
+        }
+    };
+
+    /*
+     * Batched async reads. Requests are issued as overlapped reads on an io completion port,
+     * the workers harvest completions and keep up to max_in_flight reads queued on the disk.
+     * Without a port the workers fall back to blocking reads.
+     *
+     * A null buffer is allocated with new[] to the remaining file size, a zero size reads to end of file.
+     * A request with a callback is delivered on a worker, otherwise it is returned by PollCompletions.
+     */
+    class IoQueue {
+        public:
+            static constexpr u32       MaxWorkers           = 8;
+            static constexpr u32       MaxCompletionEntries = 16;
+            static constexpr ULONG_PTR ReadKey              = 0;
+            static constexpr ULONG_PTR SubmitKey            = 1;
+            static constexpr ULONG_PTR ExitKey              = 2;
+        private:
+            using CompletionQueue = util::IntrusiveMpscTraits<IoRequest, &IoRequest::completion_node>::Queue;
+        private:
+            Handle                  m_completion_port;
+            Handle                  m_worker_thread_array[MaxWorkers];
+            u32                     m_worker_count;
+            u32                     m_max_in_flight;
+            u32                     m_in_flight_count;
+            u32                     m_outstanding_count;
+            bool                    m_is_exit;
+            IoRequest              *m_pending_head;
+            IoRequest              *m_pending_tail;
+            util::CriticalSection   m_cs;
+            util::ConditionVariable m_pending_cv;
+            util::ConditionVariable m_idle_cv;
+            CompletionQueue         m_completion_queue;
+            CompletionQueue::Batch  m_poll_batch;
+        private:
+            static unsigned long WorkerThreadMain(void *arg);
+
+            void CompletionPortWorkerMain();
+            void BlockingWorkerMain();
+
+            IoRequest *PopPending(u32 max_count);
+
+            bool OpenRequest(IoRequest *request, bool is_overlapped);
+            void IssuePending();
+            void CompleteRequest(IoRequest *request, IoResult result, u32 bytes_read);
+        public:
+            constexpr IoQueue() : m_completion_port(nullptr), m_worker_thread_array{}, m_worker_count(0), m_max_in_flight(0), m_in_flight_count(0), m_outstanding_count(0), m_is_exit(false), m_pending_head(nullptr), m_pending_tail(nullptr), m_cs(), m_pending_cv(), m_idle_cv(), m_completion_queue(), m_poll_batch(nullptr) {/*...*/}
+
+            void Initialize(const IoQueueInfo *io_queue_info);
+            void Finalize();
+
+            void Submit(IoRequest *request_array, u32 request_count);
+
+            /* Returns delivered requests without callbacks, oldest first */
+            u32 PollCompletions(IoRequest **out_request_array, u32 max_count);
+
+            /* Blocks until every submitted request has been delivered */
+            void WaitIdle();
+
+            bool IsIdle();
+
+            constexpr ALWAYS_INLINE bool IsCompletionPortEnabled() const { return m_completion_port != nullptr; }
+    };
+}
@@ -0,0 +1,36 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    /*
+     * Byte aligned LZ77 in the style of an lz4 block. Each sequence is a token of literal and match length nibbles,
+     * the literals, then a 16 bit offset. The final sequence only carries literals.
+     */
+    constexpr size_t LzMinMatch = 4;
+    constexpr size_t LzMaxOffset = 0xffff;
+
+    constexpr ALWAYS_INLINE size_t CalcLzCompressBound(size_t size) {
+        return size + (size / 255) + 16;
+    }
+
+    /* Returns the compressed size, or 0 when the output does not fit in dst_capacity */
+    size_t CompressLz(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+    /* Returns false on malformed input or when the output is not exactly dst_size */
+    bool DecompressLz(const void *src, size_t src_size, void *dst, size_t dst_size);
+}
@@ -0,0 +1,51 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    enum MappedFileAccess : u32 {
+        MappedFileAccess_Random     = 0,
+        MappedFileAccess_Sequential = 1,
+        MappedFileAccess_WillNeed   = 2,
+    };
+
+    /* Read only view of a whole file. The view is allocation granularity aligned so it can be consumed in place */
+    class MappedFile {
+        private:
+            Handle  m_file;
+            Handle  m_mapping;
+            void   *m_view;
+            u64     m_size;
+        public:
+            constexpr MappedFile() : m_file(nullptr), m_mapping(nullptr), m_view(nullptr), m_size(0) {/*...*/}
+
+            void Initialize(const char *path, MappedFileAccess access);
+            void Finalize();
+
+            /* Asks the kernel to read a range in ahead of use */
+            void Prefetch(u64 offset, u64 size);
+
+            constexpr ALWAYS_INLINE const void *GetView() const { return m_view; }
+            constexpr ALWAYS_INLINE u64         GetSize() const { return m_size; }
+
+            template <typename T>
+            ALWAYS_INLINE const T *GetViewAs(u64 offset) const {
+                DD_ASSERT(offset < m_size && (offset % alignof(T)) == 0);
+                return reinterpret_cast<const T*>(reinterpret_cast<uintptr_t>(m_view) + offset);
+            }
+    };
+}
@@ -0,0 +1,190 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::vk {
+    class Context;
+    class MemoryPool;
+    class Buffer;
+}
+
+namespace dd::res {
+
+    /*
+     * Mesh
+     *
+     * [MeshHeader][MeshSubmesh...][Stream 0]...[Stream n][Indices]
+     *
+     * Streams and indices are stored exactly as the gpu consumes them at MeshDataAlignment offsets from data_offset,
+     * so loading is one copy of the data region into a memory pool. Quantized positions are snorm16 in the unit cube
+     * and are restored with "position * position_scale + position_offset".
+     *
+     * Every lod shares the vertex streams, their indices follow lod 0 in the index stream and
+     * submeshes are stored lod major with submesh_count entries per lod.
+     */
+    constexpr u32 MeshMagic         = 0x534d'4444; /* "DDMS" */
+    constexpr u32 MeshVersion       = 2;
+    constexpr u32 MeshDataAlignment = 0x100;
+    constexpr u32 MaxMeshLods       = 8;
+
+    enum MeshAttribute : u32 {
+        MeshAttribute_Position = 0,
+        MeshAttribute_Normal   = 1,
+        MeshAttribute_TexCoord = 2,
+        MeshAttribute_Count    = 3,
+    };
+
+    enum MeshFlag : u32 {
+        MeshFlag_None              = 0,
+        MeshFlag_QuantizedPosition = (1 << 0),
+        MeshFlag_QuantizedNormal   = (1 << 1),
+        MeshFlag_HalfTexCoord      = (1 << 2),
+        MeshFlag_Optimized         = (1 << 3),
+    };
+
+    struct MeshBounds {
+        float aabb_min[3];
+        float aabb_max[3];
+        float sphere_center[3];
+        float sphere_radius;
+    };
+    static_assert(sizeof(MeshBounds) == 0x28);
+
+    /* A vk_format of VK_FORMAT_UNDEFINED marks an absent stream */
+    struct MeshStream {
+        u64 offset;
+        u64 size;
+        u32 vk_format;
+        u32 stride;
+    };
+    static_assert(sizeof(MeshStream) == 0x18);
+
+    /* error is the simplification error in model units, 0 for lod 0 */
+    struct MeshLod {
+        u32   index_offset;
+        u32   index_count;
+        float error;
+        u32   reserved0;
+    };
+    static_assert(sizeof(MeshLod) == 0x10);
+
+    struct MeshSubmesh {
+        u32        index_offset;
+        u32        index_count;
+        u64        material_hash;
+        MeshBounds bounds;
+    };
+    static_assert(sizeof(MeshSubmesh) == 0x38);
+
+    struct MeshHeader {
+        u32        magic;
+        u32        version;
+        u32        flags;
+        u32        vertex_count;
+        u32        index_count;
+        u32        vk_index_type;
+        u32        submesh_count;
+        u32        lod_count;
+        u64        data_offset;
+        u64        data_size;
+        MeshStream stream_array[MeshAttribute_Count];
+        MeshStream index_stream;
+        float      position_scale[3];
+        float      position_offset[3];
+        MeshBounds bounds;
+        MeshLod    lod_array[MaxMeshLods];
+    };
+    static_assert(sizeof(MeshHeader) == 0x150);
+
+    struct SourceSubmesh {
+        u32 index_offset;
+        u32 index_count;
+        u64 material_hash;
+    };
+
+    /* Unindexed float attributes as imported, normals and texcoords may be null */
+    struct SourceMesh {
+        float         *position_array;
+        float         *normal_array;
+        float         *texcoord_array;
+        u32           *index_array;
+        SourceSubmesh *submesh_array;
+        u32            vertex_count;
+        u32            index_count;
+        u32            submesh_count;
+    };
+
+    /* Lods past lod 0 of a SourceMesh indexing its vertices, submeshes are lod major and offsets are into index_array */
+    struct SourceMeshLods {
+        u32           *index_array;
+        SourceSubmesh *submesh_array;
+        MeshLod        lod_array[MaxMeshLods - 1];
+        u32            index_count;
+        u32            lod_count;
+    };
+
+    /* Triangulates faces and welds identical position/texcoord/normal triples, each "usemtl" starts a submesh */
+    void ImportObj(const char *path, SourceMesh *out_source_mesh);
+
+    void FreeSourceMesh(SourceMesh *source_mesh);
+
+    struct CookMeshInfo {
+        bool             is_position_quantized;
+        bool             is_normal_quantized;
+        bool             is_texcoord_half;
+        bool             is_optimized;
+        OptimizeMeshInfo optimize_mesh_info;
+        MeshLodInfo      mesh_lod_info;
+
+        constexpr void SetDefaults() {
+            is_position_quantized = false;
+            is_normal_quantized   = false;
+            is_texcoord_half      = false;
+            is_optimized          = true;
+            optimize_mesh_info.SetDefaults();
+            mesh_lod_info.SetDefaults();
+        }
+    };
+
+    /* is_optimized only marks the file, source_mesh must already have been through OptimizeSourceMesh. source_lods may be null */
+    void WriteMesh(const char *mesh_path, const SourceMesh *source_mesh, const SourceMeshLods *source_lods, const CookMeshInfo *cook_mesh_info);
+
+    /* Imports source_path by extension, optimizes it and writes a mesh. out_optimize_stats may be null */
+    void CookMesh(const char *mesh_path, const char *source_path, const CookMeshInfo *cook_mesh_info, MeshOptimizeStats *out_optimize_stats);
+
+    struct Mesh {
+        MeshHeader      header;
+        MeshSubmesh    *submesh_array;
+        vk::MemoryPool *memory_pool;
+        vk::Buffer     *stream_buffer_array[MeshAttribute_Count];
+        vk::Buffer     *index_buffer;
+
+        constexpr ALWAYS_INLINE bool HasAttribute(MeshAttribute attribute) const { return header.stream_array[attribute].vk_format != 0; }
+
+        constexpr ALWAYS_INLINE const MeshStream *GetStream(MeshAttribute attribute) const { return std::addressof(header.stream_array[attribute]); }
+
+        constexpr ALWAYS_INLINE const MeshLod     *GetLod(u32 lod)                   const { return std::addressof(header.lod_array[lod]); }
+        constexpr ALWAYS_INLINE const MeshSubmesh *GetSubmesh(u32 lod, u32 submesh) const { return std::addressof(submesh_array[lod * header.submesh_count + submesh]); }
+    };
+
+    /* Maps the mesh and copies its data region into one device local pool, buffers are views at the stored offsets. Unoptimized meshes are optimized on the way */
+    void LoadMesh(const vk::Context *context, const char *path, Mesh *out_mesh);
+
+    void FreeMesh(const vk::Context *context, Mesh *mesh);
+
+    /* Coarsest lod whose error projects to at most max_pixel_error pixels, distance is from the eye to the nearest point of the mesh */
+    u32 SelectMeshLod(const MeshHeader *header, float distance, const util::PerspectiveProjection *projection, float viewport_height, float max_pixel_error);
+}
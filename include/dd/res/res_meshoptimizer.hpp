@@ -0,0 +1,99 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    struct SourceMesh;
+    struct MeshHeader;
+    struct MeshSubmesh;
+
+    namespace impl {
+
+        /* Triangles using each vertex, packed by a counting sort. live_count_array starts as the use count of every vertex */
+        struct VertexAdjacency {
+            u32 *offset_array;
+            u32 *triangle_array;
+            u32 *live_count_array;
+        };
+
+        void BuildVertexAdjacency(VertexAdjacency *out_adjacency, const u32 *index_array, u32 index_count, u32 vertex_count);
+        void FreeVertexAdjacency(VertexAdjacency *adjacency);
+    }
+
+    constexpr u32   DefaultVertexCacheSize   = 16;
+    constexpr float DefaultOverdrawThreshold = 1.05f;
+
+    /* Simulated fifo post transform cache, acmr is transforms per triangle and atvr is transforms per referenced vertex */
+    struct VertexCacheStats {
+        u32   transform_count;
+        u32   triangle_count;
+        u32   unique_vertex_count;
+        float acmr;
+        float atvr;
+    };
+
+    void AnalyzeVertexCache(VertexCacheStats *out_stats, const u32 *index_array, u32 index_count, u32 vertex_count, u32 cache_size);
+
+    /* Tipsify, triangles are fanned around the vertex that stays in cache longest. out_index_array must not alias index_array */
+    void OptimizeVertexCache(u32 *out_index_array, const u32 *index_array, u32 index_count, u32 vertex_count, u32 cache_size);
+
+    /*
+     * Splits cache optimized indices into clusters and draws the most outward facing clusters first.
+     * A cluster ends where the cache restarts or where its acmr is within threshold of the whole mesh,
+     * so a larger threshold trades vertex cache efficiency for less overdraw.
+     */
+    void OptimizeOverdraw(u32 *out_index_array, const u32 *index_array, u32 index_count, const float *position_array, u32 vertex_count, u32 cache_size, float threshold);
+
+    /* Orders vertices by first use and rewrites indices, unreferenced vertices go last. Returns the referenced vertex count */
+    u32 BuildVertexFetchRemap(u32 *out_remap_array, u32 *index_array, u32 index_count, u32 vertex_count);
+
+    /* out_stream must not alias stream */
+    void RemapVertexStream(void *out_stream, const void *stream, u32 stride, u32 vertex_count, const u32 *remap_array);
+
+    struct OptimizeMeshInfo {
+        u32   cache_size;
+        float overdraw_threshold;
+        bool  is_welded;
+        bool  is_overdraw_optimized;
+
+        constexpr void SetDefaults() {
+            cache_size            = DefaultVertexCacheSize;
+            overdraw_threshold    = DefaultOverdrawThreshold;
+            is_welded             = true;
+            is_overdraw_optimized = true;
+        }
+    };
+
+    struct MeshOptimizeStats {
+        VertexCacheStats before;
+        VertexCacheStats after;
+        u32              source_vertex_count;
+        u32              vertex_count;
+    };
+
+    /* Merges vertices with bitwise identical attributes. Returns the new vertex count */
+    u32 WeldVertices(SourceMesh *source_mesh);
+
+    /* Weld, then vertex cache and overdraw order per submesh, then vertex fetch order over the whole mesh */
+    void OptimizeSourceMesh(SourceMesh *source_mesh, const OptimizeMeshInfo *optimize_mesh_info, MeshOptimizeStats *out_stats);
+
+    /*
+     * Optimizes a cooked data region in place for meshes cooked without MeshFlag_Optimized.
+     * Streams may be quantized, so only vertex cache and vertex fetch order are applied.
+     */
+    void OptimizeMeshData(MeshHeader *header, const MeshSubmesh *submesh_array, void *data, const OptimizeMeshInfo *optimize_mesh_info, MeshOptimizeStats *out_stats);
+}
@@ -0,0 +1,68 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    struct SourceMesh;
+    struct SourceMeshLods;
+
+    /*
+     * Quadric error simplifier
+     *
+     * Edges collapse onto one of their vertices so no new vertices are created and every lod shares the source streams.
+     * Errors are relative to the largest extent of the mesh. Vertices on uv or normal seams and non manifold edges never move,
+     * border vertices only slide along the border unless is_border_locked is set.
+     */
+    struct SimplifyMeshInfo {
+        u32   target_index_count;
+        float target_error;
+        float attribute_weight;
+        bool  is_border_locked;
+
+        constexpr void SetDefaults() {
+            target_index_count = 0;
+            target_error       = 0.01f;
+            attribute_weight   = 1.0f;
+            is_border_locked   = true;
+        }
+    };
+
+    /* Stops at whichever of target_index_count and target_error is reached first. out_index_array needs index_count entries, returns the new index count */
+    u32 SimplifyMesh(u32 *out_index_array, const u32 *index_array, u32 index_count, const SourceMesh *source_mesh, const SimplifyMeshInfo *simplify_mesh_info, float *out_error);
+
+    /* lod_count includes lod 0, each lod targets index_ratio of the previous one within max_error */
+    struct MeshLodInfo {
+        u32   lod_count;
+        float index_ratio;
+        float max_error;
+        float attribute_weight;
+        bool  is_border_locked;
+
+        constexpr void SetDefaults() {
+            lod_count        = 4;
+            index_ratio      = 0.5f;
+            max_error        = 0.05f;
+            attribute_weight = 1.0f;
+            is_border_locked = true;
+        }
+    };
+
+    /* Simplifies every submesh of each lod from the previous lod, the chain ends early once a lod stops shrinking */
+    void GenerateMeshLods(SourceMeshLods *out_source_lods, const SourceMesh *source_mesh, const MeshLodInfo *mesh_lod_info);
+
+    void FreeSourceMeshLods(SourceMeshLods *source_lods);
+}
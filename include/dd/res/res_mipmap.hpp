@@ -0,0 +1,57 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    enum MipFilter : u32 {
+        MipFilter_Box    = 0, /* 2x2 average, odd edges are clamped */
+        MipFilter_Kaiser = 1, /* Separable 8 tap Kaiser windowed sinc, keeps detail the box filter blurs without ringing much */
+    };
+
+    constexpr ALWAYS_INLINE u32 CalcMipLevels(u32 width, u32 height) {
+        u32 size   = (width < height) ? height : width;
+        u32 levels = 1;
+        while (1 < size) {
+            size = size >> 1;
+            ++levels;
+        }
+        return levels;
+    }
+
+    constexpr ALWAYS_INLINE u32 CalcMipDimension(u32 size, u32 level) {
+        const u32 mip_size = size >> level;
+        return (mip_size == 0) ? 1 : mip_size;
+    }
+
+    constexpr ALWAYS_INLINE size_t CalcMipChainSizeRgba8(u32 width, u32 height, u32 mip_levels) {
+        size_t size = 0;
+        for (u32 i = 0; i < mip_levels; ++i) {
+            size += static_cast<size_t>(CalcMipDimension(width, i)) * CalcMipDimension(height, i) * 4;
+        }
+        return size;
+    }
+
+    /* sRGB transfer functions, both are table lookups */
+    float ConvertSrgbToLinear(u8 value);
+    u8    ConvertLinearToSrgb(float value);
+
+    /* Filters an RGBA8 level into the next. sRGB color is filtered in linear space, alpha is always linear */
+    void DownsampleMipRgba8(u8 *out_mip, const u8 *mip, u32 width, u32 height, bool is_srgb, MipFilter filter);
+
+    /* Fills levels 1 and up of a tightly packed chain whose level 0 is already written */
+    void GenerateMipChainRgba8(u8 *chain, u32 width, u32 height, u32 mip_levels, bool is_srgb, MipFilter filter);
+}
@@ -0,0 +1,218 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::res {
+
+    /* Called once an entry is evicted or the cache is finalized, user_data is whatever was passed to Insert */
+    using ResourceDestroyFunction = void (*)(void *resource, void *user_data);
+
+    /* Destroys objects following the Finalize(const Context*) convention that were allocated with new */
+    template <typename T, typename C>
+    void FinalizeAndDeleteResource(void *resource, void *user_data) {
+        T *object = reinterpret_cast<T*>(resource);
+        object->Finalize(reinterpret_cast<const C*>(user_data));
+        delete object;
+    }
+
+    /* Keys are a path hash seeded with a hash of the creation parameters */
+    constexpr ALWAYS_INLINE u64 MakeResourceKey(const char *path, u64 parameter_hash = 0) {
+        return util::HashString(path, parameter_hash);
+    }
+
+    /* Parameters with padding or floating point members must be hashed by the caller */
+    template <typename P> requires std::has_unique_object_representations<P>::value
+    ALWAYS_INLINE u64 MakeResourceKey(const char *path, const P& parameters) {
+        return util::HashString(path, util::HashObject(parameters));
+    }
+
+    struct ResourceCacheInfo {
+        size_t memory_budget;
+        u32    expected_count;
+
+        constexpr void SetDefaults() {
+            memory_budget  = 0x1000'0000;
+            expected_count = 256;
+        }
+    };
+
+    struct ResourceCacheStats {
+        u64    hit_count;
+        u64    miss_count;
+        u64    eviction_count;
+        size_t memory_used;
+        u32    entry_count;
+    };
+
+    template <typename T>
+    class ResourceHandle;
+
+    /* Unique per type without rtti, used to catch a key reused for a different resource type */
+    template <typename T>
+    struct ResourceTypeTag {
+        static constexpr u8 Tag = 0;
+    };
+
+    /*
+     * Shares resources by key so repeated loads create one object. Entries are refcounted through ResourceHandle,
+     * unreferenced entries stay resident in LRU order and are destroyed once the memory budget is exceeded.
+     * Referenced entries are never evicted, so the budget can be overrun while they are alive.
+     * Destroying a resource the GPU may still be using is the destroy function's responsibility.
+     */
+    class ResourceCache {
+        public:
+            template <typename T>
+            friend class ResourceHandle;
+        private:
+            struct Entry {
+                u64                      key;
+                const void              *type_tag;
+                void                    *resource;
+                size_t                   memory_size;
+                ResourceDestroyFunction  destroy_function;
+                void                    *destroy_user_data;
+                u32                      reference_count;
+                Entry                   *lru_prev;
+                Entry                   *lru_next;
+            };
+            using EntryMap = util::FlatHashMap<u64, Entry*>;
+        private:
+            EntryMap              m_entry_map;
+            Entry                *m_lru_head;
+            Entry                *m_lru_tail;
+            size_t                m_memory_budget;
+            size_t                m_memory_used;
+            u64                   m_hit_count;
+            u64                   m_miss_count;
+            u64                   m_eviction_count;
+            util::CriticalSection m_cache_cs;
+        private:
+            void LinkLru(Entry *entry);
+            void UnlinkLru(Entry *entry);
+
+            /* Unlinks unreferenced entries until under budget, returns them chained through lru_next to be destroyed outside the lock */
+            Entry *EvictLru(bool is_evict_all);
+            static void DestroyEntries(Entry *entry);
+
+            Entry *FindEntry(u64 key, const void *type_tag);
+            Entry *InsertEntry(u64 key, const void *type_tag, void *resource, size_t memory_size, ResourceDestroyFunction destroy_function, void *destroy_user_data);
+
+            void AddReference(Entry *entry);
+            void ReleaseReference(Entry *entry);
+        public:
+            constexpr ResourceCache() : m_entry_map(), m_lru_head(nullptr), m_lru_tail(nullptr), m_memory_budget(0), m_memory_used(0), m_hit_count(0), m_miss_count(0), m_eviction_count(0), m_cache_cs() {/*...*/}
+
+            void Initialize(const ResourceCacheInfo *cache_info);
+
+            /* Every handle must be released first */
+            void Finalize();
+
+            /* Returns an invalid handle on a miss */
+            template <typename T>
+            ResourceHandle<T> Find(u64 key) {
+                return ResourceHandle<T>(this, this->FindEntry(key, std::addressof(ResourceTypeTag<T>::Tag)));
+            }
+
+            /* If another thread inserted the key first the new resource is destroyed and the existing one is returned */
+            template <typename T>
+            ResourceHandle<T> Insert(u64 key, T *resource, size_t memory_size, ResourceDestroyFunction destroy_function, void *destroy_user_data) {
+                return ResourceHandle<T>(this, this->InsertEntry(key, std::addressof(ResourceTypeTag<T>::Tag), resource, memory_size, destroy_function, destroy_user_data));
+            }
+
+            /* Create is T*(size_t *out_memory_size), only invoked on a miss */
+            template <typename T, typename F>
+            ResourceHandle<T> Acquire(u64 key, F create, ResourceDestroyFunction destroy_function, void *destroy_user_data) {
+                ResourceHandle<T> handle = this->Find<T>(key);
+                if (handle.IsValid() == true) { return handle; }
+
+                size_t memory_size = 0;
+                T *resource = create(std::addressof(memory_size));
+                DD_ASSERT(resource != nullptr);
+                return this->Insert<T>(key, resource, memory_size, destroy_function, destroy_user_data);
+            }
+
+            /* Destroys every unreferenced entry */
+            void Trim();
+
+            void SetMemoryBudget(size_t memory_budget);
+
+            ResourceCacheStats GetStats();
+    };
+
+    template <typename T>
+    class ResourceHandle {
+        private:
+            friend class ResourceCache;
+        private:
+            ResourceCache        *m_cache;
+            ResourceCache::Entry *m_entry;
+        private:
+            constexpr ResourceHandle(ResourceCache *cache, ResourceCache::Entry *entry) : m_cache((entry != nullptr) ? cache : nullptr), m_entry(entry) {/*...*/}
+        public:
+            constexpr ResourceHandle() : m_cache(nullptr), m_entry(nullptr) {/*...*/}
+
+            ResourceHandle(const ResourceHandle& rhs) : m_cache(rhs.m_cache), m_entry(rhs.m_entry) {
+                if (m_entry != nullptr) {
+                    m_cache->AddReference(m_entry);
+                }
+            }
+
+            ResourceHandle(ResourceHandle&& rhs) : m_cache(rhs.m_cache), m_entry(rhs.m_entry) {
+                rhs.m_cache = nullptr;
+                rhs.m_entry = nullptr;
+            }
+
+            ~ResourceHandle() {
+                this->Release();
+            }
+
+            ResourceHandle &operator=(const ResourceHandle& rhs) {
+                if (rhs.m_entry != nullptr) {
+                    rhs.m_cache->AddReference(rhs.m_entry);
+                }
+                this->Release();
+                m_cache = rhs.m_cache;
+                m_entry = rhs.m_entry;
+                return *this;
+            }
+
+            ResourceHandle &operator=(ResourceHandle&& rhs) {
+                if (this != std::addressof(rhs)) {
+                    this->Release();
+                    m_cache     = rhs.m_cache;
+                    m_entry     = rhs.m_entry;
+                    rhs.m_cache = nullptr;
+                    rhs.m_entry = nullptr;
+                }
+                return *this;
+            }
+
+            void Release() {
+                if (m_entry != nullptr) {
+                    m_cache->ReleaseReference(m_entry);
+                }
+                m_cache = nullptr;
+                m_entry = nullptr;
+            }
+
+            constexpr ALWAYS_INLINE bool IsValid() const { return m_entry != nullptr; }
+
+            ALWAYS_INLINE T *Get() const        { return (m_entry != nullptr) ? reinterpret_cast<T*>(m_entry->resource) : nullptr; }
+            ALWAYS_INLINE T *operator->() const { DD_ASSERT(m_entry != nullptr); return reinterpret_cast<T*>(m_entry->resource); }
+
+            ALWAYS_INLINE u64 GetKey() const { DD_ASSERT(m_entry != nullptr); return m_entry->key; }
+    };
+}
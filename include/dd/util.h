@@ -21,7 +21,9 @@
 #include <dd/util/util_alignment.hpp>
 #include <dd/util/util_member.hpp>
 #include <dd/util/util_intrusivelist.hpp>
+#include <dd/util/util_intrusivempsc.hpp>
 #include <dd/util/util_intrusivetreenode.hpp>
+#include <dd/util/util_flattree.hpp>
 #include <dd/util/util_critsec.hpp>
 #include <dd/util/util_condvar.hpp>
 #include <dd/util/util_typestorage.hpp>
@@ -44,9 +46,15 @@
 #include <dd/util/math/util_matrix44.hpp>
 #include <dd/util/math/util_clamp.hpp>
 
+#include <dd/util/util_hash.hpp>
+#include <dd/util/util_flathashmap.hpp>
+
 #include <dd/util/util_logicalframebuffer.hpp>
 #include <dd/util/util_viewport.hpp>
 #include <dd/util/util_camera.hpp>
 #include <dd/util/util_projection.hpp>
+#include <dd/util/util_scenegraph.hpp>
 
 #include <dd/util/util_time.h>
+#include <dd/util/util_framestats.h>
+#include <dd/util/util_profiler.h>
@@ -46,12 +46,18 @@ namespace dd::util::sse4 {
         constexpr ALWAYS_INLINE v128() : mm() {/*...*/}
         constexpr ALWAYS_INLINE v128(const v128& rhs) : mm(rhs.mm) {/*...*/}
 
+        constexpr ALWAYS_INLINE v128& operator=(const v128& rhs) {
+            mm = rhs.mm;
+            return *this;
+        }
+
         constexpr ALWAYS_INLINE v128(__m128i rhs) : mm(rhs) {/*Takes care of v2sll*/}
         constexpr ALWAYS_INLINE v128(v4si rhs)  : si(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v4ui rhs)  : ui(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v2ull rhs) : ull(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v8ss rhs)  : ss(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v8us rhs)  : us(rhs) {/*...*/}
+        constexpr ALWAYS_INLINE v128(v16cc rhs) : cc(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v16sc rhs) : sc(rhs) {/*...*/}
         constexpr ALWAYS_INLINE v128(v16uc rhs) : uc(rhs) {/*...*/}
 
@@ -97,15 +103,15 @@ namespace dd::util::sse4 {
         }
     }
 
-    constexpr ALWAYS_INLINE v4si psubd(const v4i& a, const v4i& b) { return a.si - b.si;
+    constexpr ALWAYS_INLINE v4si psubd(const v4i& a, const v4i& b) {
         if (std::is_constant_evaluated()) {
-            return a.si + b.si;
+            return a.si - b.si;
         } else {
             return __builtin_ia32_psubd128(a.si, b.si);
         }
     }
 
-    constexpr ALWAYS_INLINE v4si pmuld(const v4i& a, const v4i& b) { return a.si - b.si;
+    constexpr ALWAYS_INLINE v4si pmuld(const v4i& a, const v4i& b) {
         if (std::is_constant_evaluated()) {
             return a.si * b.si;
         } else {
@@ -113,6 +119,14 @@ namespace dd::util::sse4 {
         }
     }
 
+    constexpr ALWAYS_INLINE v2ull pmuludq(const v4i& a, const v4i& b) {
+        if (std::is_constant_evaluated()) {
+            return (a.ull & 0xffff'ffffull) * (b.ull & 0xffff'ffffull);
+        } else {
+            return reinterpret_cast<v2ull>(__builtin_ia32_pmuludq128(a.si, b.si));
+        }
+    }
+
     /* Bitwise Instructions */
 
     constexpr ALWAYS_INLINE __m128i psllq(const v4i& a, const v4i& count) {
@@ -139,6 +153,14 @@ namespace dd::util::sse4 {
         }
     }
 
+    constexpr ALWAYS_INLINE v2ull psrlq(const v4i& a, int count) {
+        if (std::is_constant_evaluated()) {
+            return a.ull >> count;
+        } else {
+            return reinterpret_cast<v2ull>(__builtin_ia32_psrlqi128(a.sll, count));
+        }
+    }
+
     constexpr ALWAYS_INLINE __m128i pand(const v4i& a, const v4i& b) {
         if (std::is_constant_evaluated()) {
             return (__m128i)(a.mm & b.mm);
@@ -245,6 +267,20 @@ namespace dd::util::sse4 {
         }
     }
 
+    /* Mask Instructions */
+
+    constexpr ALWAYS_INLINE int pmovmskb(const v4i& a) {
+        if (std::is_constant_evaluated()) {
+            int mask = 0;
+            for (int i = 0; i < 16; ++i) {
+                mask |= ((a.uc[i] >> 7) << i);
+            }
+            return mask;
+        } else {
+            return __builtin_ia32_pmovmskb128(a.cc);
+        }
+    }
+
     /* Shuffle\Swizzle */
 
     constexpr ALWAYS_INLINE int Clamp(int val,  int min, int max) {
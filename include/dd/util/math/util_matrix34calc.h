@@ -23,4 +23,7 @@ namespace dd::util::math {
     void RotateLocalY(Matrix34f *out_rot_matrix, float theta);
 
     void RotateLocalZ(Matrix34f *out_rot_matrix, float theta);
+
+    /* Affine multiply, lhs is applied after rhs. "out_matrix" may alias either input */
+    void MultiplyMatrix34(Matrix34f *out_matrix, const Matrix34f& lhs, const Matrix34f& rhs);
 }
@@ -0,0 +1,299 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with this program;
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    constexpr ALWAYS_INLINE u64 MixHash64(u64 value) {
+        value ^= value >> 33;
+        value *= 0xff51'afd7'ed55'8ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ce'b9fe'1a85'ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    /* Keys are hashed by their bytes, so padding or floating point members need a custom hash */
+    template <typename K> requires std::has_unique_object_representations<K>::value
+    struct FlatHashDefault {
+        constexpr ALWAYS_INLINE u64 operator()(const K& key) const {
+            if constexpr (std::is_integral<K>::value || std::is_enum<K>::value) {
+                return MixHash64(static_cast<u64>(key));
+            } else if constexpr (std::is_pointer<K>::value) {
+                return MixHash64(static_cast<u64>(reinterpret_cast<uintptr_t>(key)));
+            } else {
+                return HashObject(key);
+            }
+        }
+    };
+
+    /* Open addressing map probed 16 control bytes at a time. Slots live in one array, there is no per node allocation */
+    template <typename K, typename V, typename Hash = FlatHashDefault<K>>
+    class FlatHashMap {
+        public:
+            static constexpr u32 GroupSize      = 16;
+            static constexpr u32 MinCapacity    = GroupSize;
+            static constexpr u32 InvalidIndex   = 0xffff'ffff;
+            static constexpr s8  ControlEmpty   = -128;
+            static constexpr s8  ControlDeleted = -2;
+        private:
+            struct Slot {
+                K key;
+                V value;
+            };
+            using SlotStorage = TypeStorage<Slot>;
+        private:
+            s8          *m_control_array;
+            SlotStorage *m_slot_array;
+            u32          m_capacity;
+            u32          m_count;
+            u32          m_deleted_count;
+        private:
+            static constexpr ALWAYS_INLINE s8  GetH2(u64 hash) { return static_cast<s8>(hash & 0x7f); }
+            static constexpr ALWAYS_INLINE u32 GetH1(u64 hash) { return static_cast<u32>(hash >> 7); }
+
+            ALWAYS_INLINE sse4::v128 LoadGroup(u32 group) const {
+                return sse4::v128(sse4::lddqu(reinterpret_cast<const int*>(m_control_array + group * GroupSize)));
+            }
+
+            static ALWAYS_INLINE u32 MatchByte(const sse4::v128& control, s8 value) {
+                const sse4::v16sc broadcast = sse4::v16sc{} + value;
+                return static_cast<u32>(sse4::pmovmskb(sse4::v128(sse4::pcmpeqb(control, sse4::v128(broadcast)))));
+            }
+
+            /* Empty and deleted are the only control bytes with the sign bit set */
+            static ALWAYS_INLINE u32 MatchEmptyOrDeleted(const sse4::v128& control) {
+                return static_cast<u32>(sse4::pmovmskb(control));
+            }
+
+            template <typename Q>
+            u32 FindIndex(const Q& key, u64 hash) const {
+                if (m_capacity == 0) { return InvalidIndex; }
+
+                const u32 group_mask = (m_capacity / GroupSize) - 1;
+                const s8  h2         = GetH2(hash);
+                u32       group      = GetH1(hash) & group_mask;
+                for (u32 probe = 1;; ++probe) {
+                    const sse4::v128 control = this->LoadGroup(group);
+
+                    /* Compare keys of matching control bytes */
+                    u32 match = MatchByte(control, h2);
+                    while (match != 0) {
+                        const u32 index = group * GroupSize + __builtin_ctz(match);
+                        if (GetPointer(m_slot_array[index])->key == key) { return index; }
+                        match &= match - 1;
+                    }
+
+                    /* An empty byte means the key was never pushed past this group */
+                    if (MatchByte(control, ControlEmpty) != 0) { return InvalidIndex; }
+
+                    group = (group + probe) & group_mask;
+                }
+            }
+
+            u32 FindInsertIndex(u64 hash) const {
+                const u32 group_mask = (m_capacity / GroupSize) - 1;
+                u32       group      = GetH1(hash) & group_mask;
+                for (u32 probe = 1;; ++probe) {
+                    const u32 match = MatchEmptyOrDeleted(this->LoadGroup(group));
+                    if (match != 0) { return group * GroupSize + __builtin_ctz(match); }
+
+                    group = (group + probe) & group_mask;
+                }
+            }
+
+            void Rehash(u32 new_capacity) {
+                DD_ASSERT((new_capacity & (new_capacity - 1)) == 0 && MinCapacity <= new_capacity);
+
+                s8          *old_control_array = m_control_array;
+                SlotStorage *old_slot_array    = m_slot_array;
+                const u32    old_capacity      = m_capacity;
+
+                /* Allocate new table */
+                m_control_array = new (std::nothrow) s8[new_capacity];
+                DD_ASSERT(m_control_array != nullptr);
+                m_slot_array = new (std::nothrow) SlotStorage[new_capacity];
+                DD_ASSERT(m_slot_array != nullptr);
+
+                ::memset(m_control_array, ControlEmpty, new_capacity);
+                m_capacity      = new_capacity;
+                m_deleted_count = 0;
+
+                if (old_control_array == nullptr) { return; }
+
+                /* Move live slots */
+                for (u32 i = 0; i < old_capacity; ++i) {
+                    if (old_control_array[i] < 0) { continue; }
+
+                    Slot *old_slot    = GetPointer(old_slot_array[i]);
+                    const u64 hash    = Hash{}(old_slot->key);
+                    const u32 index   = this->FindInsertIndex(hash);
+                    m_control_array[index] = GetH2(hash);
+                    std::construct_at(GetPointer(m_slot_array[index]), std::move(*old_slot));
+                    std::destroy_at(old_slot);
+                }
+
+                delete[] old_control_array;
+                delete[] old_slot_array;
+            }
+
+            u32 FindOrInsertIndex(const K& key, bool *out_inserted) {
+                const u64 hash  = Hash{}(key);
+                const u32 index = this->FindIndex(key, hash);
+                if (index != InvalidIndex) {
+                    *out_inserted = false;
+                    return index;
+                }
+
+                /* Grow at 7/8 load, or rehash in place when tombstones dominate */
+                if (((m_count + m_deleted_count + 1) * 8) > (m_capacity * 7)) {
+                    const u32 new_capacity = (m_capacity == 0) ? MinCapacity : (((m_count + 1) * 16) > (m_capacity * 7)) ? m_capacity * 2 : m_capacity;
+                    this->Rehash(new_capacity);
+                }
+
+                const u32 insert_index = this->FindInsertIndex(hash);
+                if (m_control_array[insert_index] == ControlDeleted) {
+                    --m_deleted_count;
+                }
+                m_control_array[insert_index] = GetH2(hash);
+                ++m_count;
+
+                *out_inserted = true;
+                return insert_index;
+            }
+        public:
+            constexpr FlatHashMap() : m_control_array(nullptr), m_slot_array(nullptr), m_capacity(0), m_count(0), m_deleted_count(0) {/*...*/}
+
+            void Initialize(u32 expected_count) {
+                u32 capacity = MinCapacity;
+                while ((capacity * 7) < (expected_count * 8)) {
+                    capacity = capacity * 2;
+                }
+                this->Rehash(capacity);
+            }
+
+            void Finalize() {
+                this->Clear();
+                if (m_control_array != nullptr) {
+                    delete[] m_control_array;
+                    delete[] m_slot_array;
+                }
+                m_control_array = nullptr;
+                m_slot_array    = nullptr;
+                m_capacity      = 0;
+            }
+
+            void Clear() {
+                for (u32 i = 0; i < m_capacity; ++i) {
+                    if (m_control_array[i] < 0) { continue; }
+                    std::destroy_at(GetPointer(m_slot_array[i]));
+                }
+                if (m_control_array != nullptr) {
+                    ::memset(m_control_array, ControlEmpty, m_capacity);
+                }
+                m_count         = 0;
+                m_deleted_count = 0;
+            }
+
+            /* Inserts or overwrites */
+            V *Insert(const K& key, const V& value) {
+                bool is_inserted = false;
+                const u32 index  = this->FindOrInsertIndex(key, std::addressof(is_inserted));
+
+                Slot *slot = GetPointer(m_slot_array[index]);
+                if (is_inserted == true) {
+                    std::construct_at(slot, Slot{ key, value });
+                } else {
+                    slot->value = value;
+                }
+                return std::addressof(slot->value);
+            }
+
+            /* Default constructs the value if the key is missing */
+            V *FindOrInsert(const K& key) {
+                bool is_inserted = false;
+                const u32 index  = this->FindOrInsertIndex(key, std::addressof(is_inserted));
+
+                Slot *slot = GetPointer(m_slot_array[index]);
+                if (is_inserted == true) {
+                    std::construct_at(slot, Slot{ key, V{} });
+                }
+                return std::addressof(slot->value);
+            }
+
+            V *Find(const K& key) {
+                const u32 index = this->FindIndex(key, Hash{}(key));
+                return (index == InvalidIndex) ? nullptr : std::addressof(GetPointer(m_slot_array[index])->value);
+            }
+
+            const V *Find(const K& key) const {
+                const u32 index = this->FindIndex(key, Hash{}(key));
+                return (index == InvalidIndex) ? nullptr : std::addressof(GetPointer(m_slot_array[index])->value);
+            }
+
+            bool Contains(const K& key) const {
+                return this->FindIndex(key, Hash{}(key)) != InvalidIndex;
+            }
+
+            /* Heterogeneous lookup, enabled when Hash is transparent and K compares against Q */
+            template <typename Q> requires requires { typename Hash::is_transparent; }
+            V *Find(const Q& key) {
+                const u32 index = this->FindIndex(key, Hash{}(key));
+                return (index == InvalidIndex) ? nullptr : std::addressof(GetPointer(m_slot_array[index])->value);
+            }
+
+            template <typename Q> requires requires { typename Hash::is_transparent; }
+            const V *Find(const Q& key) const {
+                const u32 index = this->FindIndex(key, Hash{}(key));
+                return (index == InvalidIndex) ? nullptr : std::addressof(GetPointer(m_slot_array[index])->value);
+            }
+
+            template <typename Q> requires requires { typename Hash::is_transparent; }
+            bool Contains(const Q& key) const {
+                return this->FindIndex(key, Hash{}(key)) != InvalidIndex;
+            }
+
+            bool Remove(const K& key) {
+                const u32 index = this->FindIndex(key, Hash{}(key));
+                if (index == InvalidIndex) { return false; }
+
+                std::destroy_at(GetPointer(m_slot_array[index]));
+                --m_count;
+
+                /* Probes never continue past a group with an empty byte, so the slot can go straight back to empty */
+                if (MatchByte(this->LoadGroup(index / GroupSize), ControlEmpty) != 0) {
+                    m_control_array[index] = ControlEmpty;
+                } else {
+                    m_control_array[index] = ControlDeleted;
+                    ++m_deleted_count;
+                }
+                return true;
+            }
+
+            /* Visitor is void(const K&, V&) */
+            template <typename F>
+            void ForEach(F visitor) {
+                for (u32 i = 0; i < m_capacity; ++i) {
+                    if (m_control_array[i] < 0) { continue; }
+                    Slot *slot = GetPointer(m_slot_array[i]);
+                    visitor(const_cast<const K&>(slot->key), slot->value);
+                }
+            }
+
+            constexpr ALWAYS_INLINE u32 GetCount()    const { return m_count; }
+            constexpr ALWAYS_INLINE u32 GetCapacity() const { return m_capacity; }
+    };
+}
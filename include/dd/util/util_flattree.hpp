@@ -0,0 +1,223 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with this program;
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    struct FlatTreeEntry {
+        u32 parent_index;
+        u32 subtree_size;
+    };
+
+    /* Depth first linearization of an IntrusiveTreeNode hierarchy. Editing stays on the intrusive tree, traversal runs over the arrays */
+    template <typename T, auto LastMemberPtr>
+    class FlatTree {
+        public:
+            using TreeNode = IntrusiveTreeNode<T, LastMemberPtr>;
+        public:
+            static constexpr u32 InvalidIndex     = 0xffff'ffff;
+            static constexpr u32 DefaultCapacity  = 64;
+            static constexpr u32 PrefetchDistance = 8;
+        private:
+            FlatTreeEntry  *m_entry_array;
+            TreeNode      **m_node_array;
+            u32             m_count;
+            u32             m_capacity;
+        private:
+            void Reserve(u32 new_capacity) {
+                if (new_capacity <= m_capacity) { return; }
+
+                u32 capacity = (m_capacity == 0) ? DefaultCapacity : m_capacity;
+                while (capacity < new_capacity) {
+                    capacity = capacity * 2;
+                }
+
+                /* Reallocate arrays */
+                FlatTreeEntry *new_entry_array = new (std::nothrow) FlatTreeEntry[capacity];
+                DD_ASSERT(new_entry_array != nullptr);
+                TreeNode **new_node_array = new (std::nothrow) TreeNode*[capacity];
+                DD_ASSERT(new_node_array != nullptr);
+
+                if (m_entry_array != nullptr) {
+                    ::memcpy(new_entry_array, m_entry_array, m_count * sizeof(FlatTreeEntry));
+                    ::memcpy(new_node_array, m_node_array, m_count * sizeof(TreeNode*));
+                    delete[] m_entry_array;
+                    delete[] m_node_array;
+                }
+
+                m_entry_array = new_entry_array;
+                m_node_array  = new_node_array;
+                m_capacity    = capacity;
+            }
+
+            static u32 CountSubTree(const TreeNode *root) {
+                u32 count = 1;
+                const TreeNode *iter = root->GetChild();
+                while (iter != nullptr) {
+                    ++count;
+
+                    /* Descend, otherwise advance to the next sibling of the nearest ancestor within the subtree */
+                    if (iter->GetChild() != nullptr) {
+                        iter = iter->GetChild();
+                        continue;
+                    }
+                    while (iter != root && iter->GetNextSibling() == nullptr) {
+                        iter = iter->GetParent();
+                    }
+                    iter = (iter == root) ? nullptr : iter->GetNextSibling();
+                }
+                return count;
+            }
+
+            void WriteSubTree(TreeNode *root, u32 base_index, u32 parent_index) {
+
+                /* Write root */
+                m_node_array[base_index]  = root;
+                m_entry_array[base_index] = { parent_index, 1 };
+
+                /* Preorder walk, subtree sizes are resolved as each node is exited */
+                u32       index         = base_index + 1;
+                u32       current_index = base_index;
+                TreeNode *iter          = root->GetChild();
+                while (iter != nullptr) {
+                    m_node_array[index]  = iter;
+                    m_entry_array[index] = { current_index, 1 };
+
+                    if (iter->GetChild() != nullptr) {
+                        current_index = index;
+                        iter          = iter->GetChild();
+                        ++index;
+                        continue;
+                    }
+                    ++index;
+
+                    while (iter->GetNextSibling() == nullptr) {
+                        m_entry_array[current_index].subtree_size = index - current_index;
+                        if (current_index == base_index) { return; }
+                        current_index = m_entry_array[current_index].parent_index;
+                        iter          = iter->GetParent();
+                    }
+                    iter = iter->GetNextSibling();
+                }
+            }
+        public:
+            constexpr FlatTree() : m_entry_array(nullptr), m_node_array(nullptr), m_count(0), m_capacity(0) {/*...*/}
+
+            void Finalize() {
+                if (m_entry_array != nullptr) {
+                    delete[] m_entry_array;
+                }
+                if (m_node_array != nullptr) {
+                    delete[] m_node_array;
+                }
+                m_entry_array = nullptr;
+                m_node_array  = nullptr;
+                m_count       = 0;
+                m_capacity    = 0;
+            }
+
+            void Build(TreeNode *root) {
+                const u32 count = CountSubTree(root);
+                this->Reserve(count);
+
+                this->WriteSubTree(root, 0, InvalidIndex);
+                m_count = count;
+            }
+
+            void RebuildSubTree(u32 index) {
+                DD_ASSERT(index < m_count);
+
+                /* Resize the subtree's range in place */
+                const u32 old_size = m_entry_array[index].subtree_size;
+                const u32 new_size = CountSubTree(m_node_array[index]);
+                const u32 old_end  = index + old_size;
+                const u32 new_end  = index + new_size;
+                const s32 delta    = static_cast<s32>(new_size) - static_cast<s32>(old_size);
+                if (delta != 0) {
+                    this->Reserve(m_count + delta);
+                    ::memmove(m_entry_array + new_end, m_entry_array + old_end, (m_count - old_end) * sizeof(FlatTreeEntry));
+                    ::memmove(m_node_array + new_end, m_node_array + old_end, (m_count - old_end) * sizeof(TreeNode*));
+
+                    /* Fix parent indices of shifted entries that point past the subtree */
+                    for (u32 i = new_end; i < m_count + delta; ++i) {
+                        if (m_entry_array[i].parent_index != InvalidIndex && old_end <= m_entry_array[i].parent_index) {
+                            m_entry_array[i].parent_index += delta;
+                        }
+                    }
+
+                    /* Fix ancestor subtree sizes */
+                    u32 parent_index = m_entry_array[index].parent_index;
+                    while (parent_index != InvalidIndex) {
+                        m_entry_array[parent_index].subtree_size += delta;
+                        parent_index = m_entry_array[parent_index].parent_index;
+                    }
+                    m_count += delta;
+                }
+
+                this->WriteSubTree(m_node_array[index], index, m_entry_array[index].parent_index);
+            }
+
+            u32 FindIndex(const TreeNode *node) const {
+                for (u32 i = 0; i < m_count; ++i) {
+                    if (m_node_array[i] == node) { return i; }
+                }
+                return InvalidIndex;
+            }
+
+            /* Visits parents before children, visitor is void(T&, u32 index, u32 parent_index) */
+            template <typename F>
+            void ForEachTopDown(F visitor) {
+                for (u32 i = 0; i < m_count; ++i) {
+                    if (i + PrefetchDistance < m_count) {
+                        __builtin_prefetch(m_node_array[i + PrefetchDistance]->GetPointer());
+                    }
+                    visitor(m_node_array[i]->GetReference(), i, m_entry_array[i].parent_index);
+                }
+            }
+
+            /* Visits children before parents, visitor is void(T&, u32 index, u32 parent_index) */
+            template <typename F>
+            void ForEachBottomUp(F visitor) {
+                for (u32 i = m_count; 0 < i; --i) {
+                    if (PrefetchDistance < i) {
+                        __builtin_prefetch(m_node_array[i - 1 - PrefetchDistance]->GetPointer());
+                    }
+                    visitor(m_node_array[i - 1]->GetReference(), i - 1, m_entry_array[i - 1].parent_index);
+                }
+            }
+
+            /* Visits parents before children, skipping the subtree of any node the visitor returns false for */
+            template <typename F>
+            void VisitTopDown(F visitor) {
+                u32 i = 0;
+                while (i < m_count) {
+                    if (i + PrefetchDistance < m_count) {
+                        __builtin_prefetch(m_node_array[i + PrefetchDistance]->GetPointer());
+                    }
+                    const bool is_descend = visitor(m_node_array[i]->GetReference(), i, m_entry_array[i].parent_index);
+                    i = (is_descend == true) ? i + 1 : i + m_entry_array[i].subtree_size;
+                }
+            }
+
+            constexpr ALWAYS_INLINE u32 GetCount()                       const { return m_count; }
+            constexpr ALWAYS_INLINE u32 GetParentIndex(u32 index)        const { return m_entry_array[index].parent_index; }
+            constexpr ALWAYS_INLINE u32 GetSubTreeSize(u32 index)        const { return m_entry_array[index].subtree_size; }
+            constexpr ALWAYS_INLINE const FlatTreeEntry *GetEntryArray() const { return m_entry_array; }
+
+            ALWAYS_INLINE T       &GetNode(u32 index)       { return m_node_array[index]->GetReference(); }
+            ALWAYS_INLINE const T &GetNode(u32 index) const { return m_node_array[index]->GetReference(); }
+    };
+}
@@ -0,0 +1,62 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    struct FrameStatsInfo {
+        const char *csv_path;
+        u32         window_size;
+        u32         histogram_bucket_count;
+        double      histogram_bucket_ms;
+        double      hitch_threshold_ms;
+
+        constexpr void SetDefaults() {
+            csv_path               = "frame_stats.csv";
+            window_size            = 1024;
+            histogram_bucket_count = 64;
+            histogram_bucket_ms    = 1.0;
+            hitch_threshold_ms     = 33.3;
+        }
+    };
+
+    struct FrameStats {
+        double min_ms;
+        double avg_ms;
+        double p50_ms;
+        double p95_ms;
+        double p99_ms;
+        double max_ms;
+        u32    sample_count;
+        u32    hitch_count;
+        u64    frame_count;
+    };
+
+    /* Frame times are pushed by BeginFrame once initialized, FinalizeFrameStats writes the csv */
+    void InitializeFrameStats(const FrameStatsInfo *frame_stats_info);
+    void FinalizeFrameStats();
+
+    void PushFrameTime(s64 delta_tick);
+
+    /* Percentiles are over the rolling window, counts are over the whole run */
+    void CalcFrameStats(FrameStats *out_frame_stats);
+
+    /* The last bucket also counts every frame past the histogram range */
+    const u32 *GetFrameTimeHistogram(u32 *out_bucket_count, double *out_bucket_ms);
+
+    /* Whole run percentile resolved to a histogram bucket's upper bound */
+    double CalcHistogramPercentile(double percentile);
+}
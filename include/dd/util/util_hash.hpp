@@ -0,0 +1,273 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with this program;
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    namespace impl {
+
+        constexpr inline u64 HashPrime32_1 = 0x9e37'79b1ull;
+        constexpr inline u64 HashPrime64_1 = 0x9e37'79b1'85eb'ca87ull;
+        constexpr inline u64 HashPrime64_2 = 0xc2b2'ae3d'27d4'eb4full;
+        constexpr inline u64 HashPrime64_3 = 0x1656'67b1'9e37'79f9ull;
+
+        constexpr inline size_t HashSecretSize      = 192;
+        constexpr inline size_t HashStripeSize      = 64;
+        constexpr inline size_t HashSecretAdvance   = 8;
+        constexpr inline size_t HashStripesPerBlock = (HashSecretSize - HashStripeSize) / HashSecretAdvance;
+        constexpr inline size_t HashBlockSize       = HashStripeSize * HashStripesPerBlock;
+
+        /* Secret is derived with splitmix64 rather than stored as a table */
+        consteval std::array<u8, HashSecretSize> MakeHashSecret() {
+            std::array<u8, HashSecretSize> secret = {};
+            u64 state = HashPrime64_3;
+            for (size_t i = 0; i < HashSecretSize; i += sizeof(u64)) {
+                state += 0x9e37'79b9'7f4a'7c15ull;
+                u64 z = state;
+                z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11ebull;
+                z = z ^ (z >> 31);
+                for (size_t byte = 0; byte < sizeof(u64); ++byte) {
+                    secret[i + byte] = static_cast<u8>(z >> (byte * 8));
+                }
+            }
+            return secret;
+        }
+        alignas(16) constexpr inline std::array<u8, HashSecretSize> HashSecret = MakeHashSecret();
+
+        template <typename C>
+        constexpr ALWAYS_INLINE u64 Read64(const C *data) {
+            if (std::is_constant_evaluated()) {
+                u64 value = 0;
+                for (size_t i = 0; i < sizeof(u64); ++i) {
+                    value |= static_cast<u64>(static_cast<u8>(data[i])) << (i * 8);
+                }
+                return value;
+            } else {
+                u64 value = 0;
+                ::memcpy(std::addressof(value), data, sizeof(u64));
+                return value;
+            }
+        }
+
+        template <typename C>
+        constexpr ALWAYS_INLINE u32 Read32(const C *data) {
+            if (std::is_constant_evaluated()) {
+                u32 value = 0;
+                for (size_t i = 0; i < sizeof(u32); ++i) {
+                    value |= static_cast<u32>(static_cast<u8>(data[i])) << (i * 8);
+                }
+                return value;
+            } else {
+                u32 value = 0;
+                ::memcpy(std::addressof(value), data, sizeof(u32));
+                return value;
+            }
+        }
+
+        template <typename C>
+        constexpr ALWAYS_INLINE sse4::v128 Load128(const C *data) {
+            if (std::is_constant_evaluated()) {
+                return sse4::v128(static_cast<unsigned long long>(Read64(data)), static_cast<unsigned long long>(Read64(data + 8)));
+            } else {
+                return sse4::v128(sse4::lddqu(reinterpret_cast<const int*>(data)));
+            }
+        }
+
+        constexpr ALWAYS_INLINE u64 Rotl64(u64 value, u32 shift) {
+            return (value << shift) | (value >> (64 - shift));
+        }
+
+        constexpr ALWAYS_INLINE u64 Multiply128Fold64(u64 lhs, u64 rhs) {
+            const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+            return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+        }
+
+        constexpr ALWAYS_INLINE u64 Avalanche(u64 hash) {
+            hash ^= hash >> 37;
+            hash *= 0x1656'6791'9e37'79f9ull;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        template <typename C>
+        constexpr ALWAYS_INLINE u64 Mix16(const C *data, const u8 *secret, u64 seed) {
+            return Multiply128Fold64(Read64(data) ^ (Read64(secret) + seed), Read64(data + 8) ^ (Read64(secret + 8) - seed));
+        }
+
+        template <typename C>
+        constexpr u64 Hash64Short(const C *data, size_t size, u64 seed) {
+            const u8 *secret = HashSecret.data();
+            if (size == 0) {
+                return Avalanche(seed ^ Read64(secret + 56) ^ Read64(secret + 64));
+            }
+            if (size < 4) {
+                const u32 combined = (static_cast<u32>(static_cast<u8>(data[0])) << 16) | (static_cast<u32>(static_cast<u8>(data[size >> 1])) << 24) | static_cast<u32>(static_cast<u8>(data[size - 1])) | static_cast<u32>(size << 8);
+                const u64 bitflip  = (Read32(secret) ^ Read32(secret + 4)) + seed;
+                return Avalanche(static_cast<u64>(combined) ^ bitflip);
+            }
+            if (size <= 8) {
+                const u64 input   = static_cast<u64>(Read32(data + size - 4)) | (static_cast<u64>(Read32(data)) << 32);
+                const u64 bitflip = (Read64(secret + 8) ^ Read64(secret + 16)) - seed;
+                u64 mixed = input ^ bitflip;
+                mixed ^= Rotl64(mixed, 49) ^ Rotl64(mixed, 24);
+                mixed *= 0x9fb2'1c65'1e98'df25ull;
+                mixed ^= (mixed >> 35) + size;
+                mixed *= 0x9fb2'1c65'1e98'df25ull;
+                return mixed ^ (mixed >> 28);
+            }
+            const u64 low  = Read64(data) ^ ((Read64(secret + 24) ^ Read64(secret + 32)) + seed);
+            const u64 high = Read64(data + size - 8) ^ ((Read64(secret + 40) ^ Read64(secret + 48)) - seed);
+            return Avalanche(size + __builtin_bswap64(low) + high + Multiply128Fold64(low, high));
+        }
+
+        template <typename C>
+        constexpr u64 Hash64Medium(const C *data, size_t size, u64 seed) {
+            const u8 *secret = HashSecret.data();
+
+            /* Walk 16 byte pairs from both ends toward the middle, cycling through the secret */
+            u64 accumulator = size * HashPrime64_1;
+            const size_t pair_count = (size + 31) / 32;
+            for (size_t i = 0; i < pair_count; ++i) {
+                const size_t secret_offset = (i * 32) % (HashSecretSize - 32);
+                accumulator += Mix16(data + i * 16, secret + secret_offset, seed);
+                accumulator += Mix16(data + size - (i + 1) * 16, secret + secret_offset + 16, seed);
+            }
+            return Avalanche(accumulator);
+        }
+
+        /* 64 byte stripe across eight 64 bit lanes, processed as four v128 at runtime */
+        template <typename C>
+        constexpr ALWAYS_INLINE void Accumulate512(u64 *accumulators, const C *data, const u8 *secret) {
+            if (std::is_constant_evaluated()) {
+                for (u32 i = 0; i < 8; ++i) {
+                    const u64 data_value = Read64(data + i * 8);
+                    const u64 data_key   = data_value ^ Read64(secret + i * 8);
+                    accumulators[i ^ 1] += data_value;
+                    accumulators[i]     += (data_key & 0xffff'ffff) * (data_key >> 32);
+                }
+            } else {
+                sse4::v128 *accumulator_vecs = reinterpret_cast<sse4::v128*>(accumulators);
+                for (u32 i = 0; i < 4; ++i) {
+                    const sse4::v128 data_vec    = Load128(data + i * 16);
+                    const sse4::v128 key_vec     = Load128(secret + i * 16);
+                    const sse4::v128 data_key    = sse4::pxor(data_vec, key_vec);
+                    const sse4::v128 data_key_hi = sse4::pshufd(data_key, sse4::ShuffleToOrder(1, 0, 3, 0));
+                    const sse4::v128 product     = sse4::pmuludq(data_key, data_key_hi);
+                    const sse4::v128 data_swap   = sse4::pshufd(data_vec, sse4::ShuffleToOrder(2, 3, 0, 1));
+                    const sse4::v128 sum         = sse4::paddq(accumulator_vecs[i], data_swap);
+                    accumulator_vecs[i]          = sse4::paddq(product, sum);
+                }
+            }
+        }
+
+        constexpr ALWAYS_INLINE void Scramble(u64 *accumulators, const u8 *secret) {
+            if (std::is_constant_evaluated()) {
+                for (u32 i = 0; i < 8; ++i) {
+                    const u64 data_key = accumulators[i] ^ (accumulators[i] >> 47) ^ Read64(secret + i * 8);
+                    accumulators[i] = data_key * HashPrime32_1;
+                }
+            } else {
+                sse4::v128 *accumulator_vecs = reinterpret_cast<sse4::v128*>(accumulators);
+                const sse4::v128 prime(static_cast<unsigned int>(HashPrime32_1), 0u, static_cast<unsigned int>(HashPrime32_1), 0u);
+                const sse4::v128 shift32(32ull, 32ull);
+                for (u32 i = 0; i < 4; ++i) {
+                    const sse4::v128 key_vec     = Load128(secret + i * 16);
+                    const sse4::v128 shifted     = sse4::psrlq(accumulator_vecs[i], 47);
+                    const sse4::v128 data_vec    = sse4::pxor(accumulator_vecs[i], shifted);
+                    const sse4::v128 data_key    = sse4::pxor(data_vec, key_vec);
+                    const sse4::v128 data_key_hi = sse4::pshufd(data_key, sse4::ShuffleToOrder(1, 0, 3, 0));
+                    const sse4::v128 product_lo  = sse4::pmuludq(data_key, prime);
+                    const sse4::v128 product_hi  = sse4::pmuludq(data_key_hi, prime);
+                    accumulator_vecs[i]          = sse4::paddq(product_lo, sse4::psllq(product_hi, shift32));
+                }
+            }
+        }
+
+        constexpr ALWAYS_INLINE u64 MergeAccumulators(const u64 *accumulators, const u8 *secret, u64 start) {
+            u64 result = start;
+            for (u32 i = 0; i < 4; ++i) {
+                result += Multiply128Fold64(accumulators[i * 2] ^ Read64(secret + i * 16), accumulators[i * 2 + 1] ^ Read64(secret + i * 16 + 8));
+            }
+            return Avalanche(result);
+        }
+
+        template <typename C>
+        constexpr u64 Hash64Long(const C *data, size_t size, u64 seed) {
+            const u8 *secret = HashSecret.data();
+
+            alignas(16) u64 accumulators[8] = {
+                HashPrime32_1,        HashPrime64_1,
+                HashPrime64_2,        HashPrime64_3 ^ seed,
+                HashPrime64_1 + seed, HashPrime64_2,
+                HashPrime32_1 ^ seed, HashPrime64_3
+            };
+
+            /* Full blocks, each followed by a scramble */
+            const size_t block_count = (size - 1) / HashBlockSize;
+            for (size_t block = 0; block < block_count; ++block) {
+                for (size_t stripe = 0; stripe < HashStripesPerBlock; ++stripe) {
+                    Accumulate512(accumulators, data + block * HashBlockSize + stripe * HashStripeSize, secret + stripe * HashSecretAdvance);
+                }
+                Scramble(accumulators, secret + HashSecretSize - HashStripeSize);
+            }
+
+            /* Partial block and last stripe */
+            const size_t tail_offset  = block_count * HashBlockSize;
+            const size_t stripe_count = ((size - 1) - tail_offset) / HashStripeSize;
+            for (size_t stripe = 0; stripe < stripe_count; ++stripe) {
+                Accumulate512(accumulators, data + tail_offset + stripe * HashStripeSize, secret + stripe * HashSecretAdvance);
+            }
+            Accumulate512(accumulators, data + size - HashStripeSize, secret + HashSecretSize - HashStripeSize - 7);
+
+            return MergeAccumulators(accumulators, secret + 11, size * HashPrime64_1);
+        }
+
+        template <typename C>
+        constexpr u64 Hash64Impl(const C *data, size_t size, u64 seed) {
+            if (size <= 16)  { return Hash64Short(data, size, seed); }
+            if (size <= 240) { return Hash64Medium(data, size, seed); }
+            return Hash64Long(data, size, seed);
+        }
+    }
+
+    /* xxHash3 style 64 bit hash, usable at compile time for character data */
+    constexpr ALWAYS_INLINE u64 Hash64(const char *data, size_t size, u64 seed = 0) {
+        return impl::Hash64Impl(data, size, seed);
+    }
+
+    inline u64 Hash64(const void *data, size_t size, u64 seed = 0) {
+        return impl::Hash64Impl(reinterpret_cast<const u8*>(data), size, seed);
+    }
+
+    /* Hashes the object's bytes, types with padding or floating point members must be hashed field by field */
+    template <typename T> requires std::has_unique_object_representations<T>::value
+    inline u64 HashObject(const T& object, u64 seed = 0) {
+        return impl::Hash64Impl(reinterpret_cast<const u8*>(std::addressof(object)), sizeof(T), seed);
+    }
+
+    /* For resource names, ex. "constexpr u64 VertexShaderId = HashString("shaders/primitive_vertex.spv");" */
+    constexpr u64 HashString(const char *string, u64 seed = 0) {
+        size_t length = 0;
+        while (string[length] != '\0') {
+            ++length;
+        }
+        return impl::Hash64Impl(string, length, seed);
+    }
+
+    /* CRC32C (Castagnoli), uses the SSE4.2 crc32 instruction when available */
+    u32 Crc32c(const void *data, size_t size, u32 crc = 0);
+}
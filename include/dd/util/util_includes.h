@@ -17,12 +17,20 @@
 
 /* Libc */
 #include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
 
 /* STD */
 #include <memory>
 #include <type_traits>
 #include <mutex>
 #include <array>
+#include <algorithm>
+
+/* Intrinsics */
+#include <immintrin.h>
+#include <cpuid.h>
 
 /* Windows */
 #define WIN32_LEAN_AND_MEAN
@@ -0,0 +1,161 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    class IntrusiveMpscNode {
+        public:
+            template<typename T, class Traits>
+            friend class IntrusiveMpscStack;
+            template<typename T, class Traits>
+            friend class IntrusiveMpscQueue;
+        private:
+            IntrusiveMpscNode *m_next;
+        public:
+            constexpr IntrusiveMpscNode() : m_next(nullptr) {/*...*/}
+
+            constexpr IntrusiveMpscNode *next() const {
+                return m_next;
+            }
+    };
+
+    /* Detached chain handed to the consumer, nodes may be relinked into a container while iterating */
+    template<typename T, class Traits>
+    class IntrusiveMpscBatch {
+        private:
+            IntrusiveMpscNode *m_head;
+        public:
+            constexpr IntrusiveMpscBatch(IntrusiveMpscNode *head) : m_head(head) {/*...*/}
+
+            constexpr bool IsEmpty() const {
+                return m_head == nullptr;
+            }
+
+            T *PopFront() {
+                if (m_head == nullptr) { return nullptr; }
+
+                IntrusiveMpscNode *node = m_head;
+                m_head = node->next();
+                return Traits::GetParent(node);
+            }
+
+            /* Visitor is void(T&) */
+            template <typename F>
+            void ForEach(F visitor) {
+                IntrusiveMpscNode *iter = m_head;
+                m_head = nullptr;
+                while (iter != nullptr) {
+                    IntrusiveMpscNode *next = iter->next();
+                    visitor(Traits::GetParentReference(iter));
+                    iter = next;
+                }
+            }
+    };
+
+    template<typename T, class Traits>
+    class IntrusiveMpscQueue;
+
+    /* Lock free LIFO, any thread may push, a single consumer drains everything at once */
+    template<typename T, class Traits>
+    class IntrusiveMpscStack {
+        public:
+            using Batch = IntrusiveMpscBatch<T, Traits>;
+        private:
+            friend class IntrusiveMpscQueue<T, Traits>;
+        private:
+            IntrusiveMpscNode *volatile m_head;
+        public:
+            constexpr IntrusiveMpscStack() : m_head(nullptr) {/*...*/}
+
+            /* Returns true if the stack was empty, so producers can signal the consumer only on the first push */
+            bool Push(T &obj) {
+                IntrusiveMpscNode *node = Traits::GetNode(std::addressof(obj));
+                IntrusiveMpscNode *head = m_head;
+                for (;;) {
+                    node->m_next = head;
+                    IntrusiveMpscNode *last_head = reinterpret_cast<IntrusiveMpscNode*>(::InterlockedCompareExchangePointer(reinterpret_cast<void *volatile*>(std::addressof(m_head)), node, head));
+                    if (last_head == head) { return head == nullptr; }
+                    head = last_head;
+                }
+            }
+
+            /* Newest first */
+            Batch PopAll() {
+                return Batch(reinterpret_cast<IntrusiveMpscNode*>(::InterlockedExchangePointer(reinterpret_cast<void *volatile*>(std::addressof(m_head)), nullptr)));
+            }
+
+            bool IsEmpty() const {
+                return m_head == nullptr;
+            }
+    };
+
+    /* Lock free FIFO, pushes are identical to the stack and the drained chain is reversed by the consumer */
+    template<typename T, class Traits>
+    class IntrusiveMpscQueue {
+        public:
+            using Batch = IntrusiveMpscBatch<T, Traits>;
+        private:
+            IntrusiveMpscStack<T, Traits> m_stack;
+        public:
+            constexpr IntrusiveMpscQueue() : m_stack() {/*...*/}
+
+            bool Push(T &obj) {
+                return m_stack.Push(obj);
+            }
+
+            /* Oldest first */
+            Batch PopAll() {
+                IntrusiveMpscNode *iter = reinterpret_cast<IntrusiveMpscNode*>(::InterlockedExchangePointer(reinterpret_cast<void *volatile*>(std::addressof(m_stack.m_head)), nullptr));
+
+                /* Reverse chain */
+                IntrusiveMpscNode *head = nullptr;
+                while (iter != nullptr) {
+                    IntrusiveMpscNode *next = iter->m_next;
+                    iter->m_next = head;
+                    head         = iter;
+                    iter         = next;
+                }
+                return Batch(head);
+            }
+
+            bool IsEmpty() const {
+                return m_stack.IsEmpty();
+            }
+    };
+
+    template<class RP, auto M>
+    struct IntrusiveMpscMemberTraits {
+
+        static RP *GetParent(IntrusiveMpscNode *node) {
+            return reinterpret_cast<RP*>(reinterpret_cast<uintptr_t>(node) - OffsetOf<M>());
+        }
+        static RP &GetParentReference(IntrusiveMpscNode *node) {
+            return *reinterpret_cast<RP*>(reinterpret_cast<uintptr_t>(node) - OffsetOf<M>());
+        }
+
+        static IntrusiveMpscNode *GetNode(const RP *parent) {
+            return reinterpret_cast<IntrusiveMpscNode*>(reinterpret_cast<uintptr_t>(parent) + OffsetOf<M>());
+        }
+    };
+
+    template<class RP, auto M>
+    struct IntrusiveMpscTraits {
+        using Traits = IntrusiveMpscMemberTraits<RP, M>;
+        using Stack  = IntrusiveMpscStack<ParentType<M>, Traits>;
+        using Queue  = IntrusiveMpscQueue<ParentType<M>, Traits>;
+    };
+}
@@ -31,12 +31,26 @@ namespace dd::util {
             IntrusiveTreeNode *m_sibling_next;
             IntrusiveTreeNode *m_sibling_prev;
         private:
-            constexpr void ClearChildrenRecursive() {
+            constexpr void ClearChildren() {
+
+                /* Walk the subtree depth first, clearing each node once all of its children are cleared */
                 IntrusiveTreeNode *iter = m_child;
-                while (iter != nullptr) {
-                    iter = iter->m_sibling_next;
-                    m_child->ClearChildrenRecursive();
-                    m_child->Clear();
+                while (iter != nullptr && iter != this) {
+                    if (iter->m_child != nullptr) {
+                        iter = iter->m_child;
+                        continue;
+                    }
+
+                    IntrusiveTreeNode *next   = iter->m_sibling_next;
+                    IntrusiveTreeNode *parent = iter->m_parent;
+                    iter->Clear();
+
+                    if (next != nullptr) {
+                        iter = next;
+                    } else {
+                        parent->m_child = nullptr;
+                        iter = parent;
+                    }
                 }
             }
         public:
@@ -51,7 +65,7 @@ namespace dd::util {
 
             constexpr void DetachAll() {
                 this->DetachSubTree();
-                this->ClearChildrenRecursive();
+                this->ClearChildren();
                 this->Clear();
             }
 
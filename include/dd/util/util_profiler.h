@@ -0,0 +1,114 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    struct ProfilerInfo {
+        const char *trace_path;
+        u32         zones_per_thread;
+        u32         flush_interval_ms;
+        u32         flush_thread_stack_size;
+
+        constexpr void SetDefaults() {
+            trace_path              = "profile.json";
+            zones_per_thread        = 0x4000;
+            flush_interval_ms       = 50;
+            flush_thread_stack_size = 0x4000;
+        }
+    };
+
+    struct ProfileZone {
+        const char *name;
+        s64         begin_tick;
+        s64         end_tick;
+    };
+
+    namespace impl {
+
+        /* Single producer ring owned by one thread, drained by the flush thread */
+        struct ProfileThreadBuffer {
+            static constexpr size_t MaxThreadNameLength = 32;
+
+            IntrusiveMpscNode    register_node;
+            ProfileThreadBuffer *flush_next;
+            ProfileZone         *zone_array;
+            u32                  zone_mask;
+            u32                  thread_id;
+            u32                  dropped_count;
+            u64                  write_index;
+            u64                  read_index;
+            char                 thread_name[MaxThreadNameLength];
+
+            ALWAYS_INLINE void PushZone(const char *name, s64 begin_tick, s64 end_tick) {
+                const u64 index = write_index;
+                if (zone_mask < index - __atomic_load_n(std::addressof(read_index), __ATOMIC_ACQUIRE)) {
+                    ++dropped_count;
+                    return;
+                }
+
+                zone_array[index & zone_mask] = { name, begin_tick, end_tick };
+                __atomic_store_n(std::addressof(write_index), index + 1, __ATOMIC_RELEASE);
+            }
+        };
+
+        /* Returns nullptr while the profiler is inactive */
+        ProfileThreadBuffer *GetProfileThreadBuffer();
+    }
+
+    #if defined(DD_PROFILE)
+
+    /* Zones are written in Chrome trace format, run FinalizeProfiler after every profiled thread has stopped */
+    void InitializeProfiler(const ProfilerInfo *profiler_info);
+    void FinalizeProfiler();
+
+    /* Names the calling thread in the trace, the first call wins */
+    void SetProfilerThreadName(const char *name);
+
+    #else
+
+    /* Without DD_PROFILE no flush thread or trace file is created */
+    constexpr ALWAYS_INLINE void InitializeProfiler([[maybe_unused]] const ProfilerInfo *profiler_info) {/*...*/}
+    constexpr ALWAYS_INLINE void FinalizeProfiler() {/*...*/}
+    constexpr ALWAYS_INLINE void SetProfilerThreadName([[maybe_unused]] const char *name) {/*...*/}
+
+    #endif
+
+    class ProfileScope {
+        private:
+            impl::ProfileThreadBuffer *m_buffer;
+            const char                *m_name;
+            s64                        m_begin_tick;
+        public:
+            ALWAYS_INLINE ProfileScope(const char *name) : m_buffer(impl::GetProfileThreadBuffer()), m_name(name), m_begin_tick(0) {
+                if (m_buffer == nullptr) { return; }
+                m_begin_tick = GetSystemTick();
+            }
+            ALWAYS_INLINE ~ProfileScope() {
+                if (m_buffer == nullptr) { return; }
+                m_buffer->PushZone(m_name, m_begin_tick, GetSystemTickOrdered());
+            }
+    };
+}
+
+#define DD_PROFILE_CONCAT_IMPL(x, y) x##y
+#define DD_PROFILE_CONCAT(x, y) DD_PROFILE_CONCAT_IMPL(x, y)
+
+#if defined(DD_PROFILE)
+    #define DD_PROFILE_SCOPE(name) const ::dd::util::ProfileScope DD_PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+#else
+    #define DD_PROFILE_SCOPE(name)
+#endif
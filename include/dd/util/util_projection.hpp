@@ -121,5 +121,10 @@ namespace dd::util {
                 m_fov_x = ::tanf(new_fov_x * 0.5f) / m_right;
                 m_need_update = true;
             }
+
+            /* Pixels spanned by one unit at a view distance of one, divide by distance for the projected size */
+            constexpr float GetProjectedScale(float viewport_height) const {
+                return viewport_height * 0.5f / m_right;
+            }
     };
 }
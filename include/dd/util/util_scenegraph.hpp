@@ -0,0 +1,128 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with this program;
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::util {
+
+    class SceneGraph;
+
+    class SceneNode {
+        public:
+            using TreeNode = IntrusiveTreeNode<SceneNode, nullptr>;
+        private:
+            friend class SceneGraph;
+        private:
+            TreeNode        m_tree_node;
+            math::Matrix34f m_local_matrix;
+            u32             m_flat_index;
+            bool            m_is_dirty;
+        public:
+            constexpr SceneNode() : m_tree_node(), m_local_matrix(math::IdentityMatrix34<float>), m_flat_index(FlatTree<SceneNode, nullptr>::InvalidIndex), m_is_dirty(false) {/*...*/}
+
+            constexpr ALWAYS_INLINE const math::Matrix34f &GetLocalMatrix() const { return m_local_matrix; }
+
+            constexpr ALWAYS_INLINE u32 GetFlatIndex() const { return m_flat_index; }
+
+            constexpr ALWAYS_INLINE TreeNode       *GetTreeNode()       { return std::addressof(m_tree_node); }
+            constexpr ALWAYS_INLINE const TreeNode *GetTreeNode() const { return std::addressof(m_tree_node); }
+    };
+
+    struct SceneGraphInfo {
+        u32 worker_count;
+        u32 worker_stack_size;
+        u32 parallel_subtree_threshold;
+
+        constexpr void SetDefaults() {
+            worker_count               = 0;
+            worker_stack_size          = 0x4000;
+            parallel_subtree_threshold = 256;
+        }
+    };
+
+    /* World matrices are packed in depth first order, only dirty subtrees are recomputed on Update */
+    class SceneGraph {
+        public:
+            static constexpr u32    MaxWorkers       = 16;
+            static constexpr u32    DefaultCapacity  = 64;
+            static constexpr size_t WorkerExitCode   = 0;
+            static constexpr size_t WorkerRunMessage = 1;
+        private:
+            using Tree           = FlatTree<SceneNode, nullptr>;
+            using WorkerDelegate = Delegate2<SceneGraph, DelegateThread*, size_t>;
+        private:
+            struct DirtyRange {
+                u32 begin;
+                u32 end;
+            };
+        private:
+            SceneNode                  *m_root;
+            Tree                        m_flat_tree;
+            math::Matrix34f            *m_world_matrix_array;
+            u32                         m_world_matrix_capacity;
+            SceneNode                 **m_dirty_node_array;
+            u32                         m_dirty_node_count;
+            u32                         m_dirty_node_capacity;
+            DirtyRange                 *m_range_array;
+            u32                         m_range_count;
+            u32                         m_range_capacity;
+            bool                        m_is_structure_dirty;
+            u32                         m_parallel_subtree_threshold;
+            u32                         m_worker_count;
+            volatile long               m_next_range;
+            u32                         m_pending_workers;
+            CriticalSection             m_worker_cs;
+            ConditionVariable           m_worker_done_cv;
+            TypeStorage<WorkerDelegate> m_worker_delegate;
+            TypeStorage<DelegateThread> m_worker_thread_array[MaxWorkers];
+        private:
+            void ReserveRanges(u32 count);
+            void PushRange(u32 begin, u32 end);
+
+            void RebuildStructure();
+            void GatherDirtyRanges();
+            void SplitRangesForWorkers();
+
+            void UpdateRange(u32 begin, u32 end);
+            void ProcessRanges();
+
+            void WorkerMain(DelegateThread *thread, size_t message);
+        public:
+            constexpr SceneGraph() {/*...*/}
+
+            void Initialize(SceneNode *root, const SceneGraphInfo *scene_graph_info);
+            void Finalize();
+
+            /* Structural edits invalidate the flat order, the next Update rebuilds it */
+            void AddChild(SceneNode *parent, SceneNode *child);
+            void Detach(SceneNode *node);
+
+            void SetLocalMatrix(SceneNode *node, const math::Matrix34f& local_matrix);
+            void MarkDirty(SceneNode *node);
+
+            void Update();
+
+            const math::Matrix34f &GetWorldMatrix(const SceneNode *node) const {
+                DD_ASSERT(node->m_flat_index < m_flat_tree.GetCount());
+                return m_world_matrix_array[node->m_flat_index];
+            }
+
+            constexpr ALWAYS_INLINE const math::Matrix34f *GetWorldMatrixArray() const { return m_world_matrix_array; }
+            constexpr ALWAYS_INLINE u32                    GetWorldMatrixCount() const { return m_flat_tree.GetCount(); }
+            constexpr ALWAYS_INLINE size_t                 GetWorldMatrixSize()  const { return m_flat_tree.GetCount() * sizeof(math::Matrix34f); }
+
+            ALWAYS_INLINE SceneNode &GetNode(u32 flat_index) { return m_flat_tree.GetNode(flat_index); }
+    };
+}
@@ -21,13 +21,114 @@ namespace dd::util {
 
     s64    GetSystemTickFrequency();
 
+    /* Reads the tsc when it is invariant, otherwise QueryPerformanceCounter */
     s64    GetSystemTick();
 
+    /* Waits for prior instructions to retire before reading, for the end of a timed region */
+    s64    GetSystemTickOrdered();
+
+    bool   IsTscClock();
+
     void   BeginFrame();
 
+    /* Restarts frame timing, used after the loop was parked so the next delta excludes the idle time */
+    void   ResetFrameTime();
+
+    /* Fixed point conversions, no divides */
     s64    GetMillisecondsFromTick(s64 tick);
 
+    s64    GetNanosecondsFromTick(s64 tick);
+
+    s64    GetDeltaTick();
+
     double GetDeltaTime();
 
     double CalcFps();
+
+    struct FixedTimestepInfo {
+        u32 step_rate;
+        u32 max_steps_per_frame;
+
+        constexpr void SetDefaults() {
+            step_rate           = 60;
+            max_steps_per_frame = 8;
+        }
+    };
+
+    /* Accumulates frame time in ticks and hands it out in fixed steps, time past max_steps_per_frame is dropped */
+    class FixedTimestep {
+        private:
+            s64 m_step_tick;
+            s64 m_accumulated_tick;
+            s64 m_dropped_tick;
+            u64 m_step_count;
+            u32 m_max_steps_per_frame;
+        public:
+            constexpr FixedTimestep() : m_step_tick(0), m_accumulated_tick(0), m_dropped_tick(0), m_step_count(0), m_max_steps_per_frame(0) {/*...*/}
+
+            void Initialize(const FixedTimestepInfo *fixed_timestep_info);
+
+            void Accumulate(s64 delta_tick);
+
+            /* Use as "while (ConsumeStep() == true) { Step(GetStepTime()); }" */
+            bool ConsumeStep();
+
+            /* Fraction of a step left over, for blending the last two simulated states */
+            float GetAlpha() const;
+
+            double GetStepTime() const;
+
+            constexpr ALWAYS_INLINE s64 GetStepTick()    const { return m_step_tick; }
+            constexpr ALWAYS_INLINE u64 GetStepCount()   const { return m_step_count; }
+            constexpr ALWAYS_INLINE s64 GetDroppedTick() const { return m_dropped_tick; }
+    };
+
+    struct FrameLimiterInfo {
+        u32 target_rate;
+        u32 min_spin_margin_us;
+        u32 max_spin_margin_us;
+
+        constexpr void SetDefaults() {
+            target_rate        = 0;
+            min_spin_margin_us = 200;
+            max_spin_margin_us = 4000;
+        }
+    };
+
+    struct FramePacingStats {
+        s64 last_error_ns;
+        s64 max_error_ns;
+        s64 avg_error_ns;
+        s64 spin_margin_ns;
+        u64 frame_count;
+    };
+
+    /* Sleeps on a high resolution waitable timer until a margin before the deadline, then spins. A target rate of 0 disables it */
+    class FrameLimiter {
+        private:
+            Handle m_timer;
+            s64    m_frame_tick;
+            s64    m_deadline_tick;
+            s64    m_spin_margin_tick;
+            s64    m_min_spin_margin_tick;
+            s64    m_max_spin_margin_tick;
+            s64    m_last_error_tick;
+            s64    m_max_error_tick;
+            s64    m_total_error_tick;
+            u64    m_frame_count;
+        private:
+            void SleepUntil(s64 wake_tick);
+        public:
+            constexpr FrameLimiter() : m_timer(nullptr), m_frame_tick(0), m_deadline_tick(0), m_spin_margin_tick(0), m_min_spin_margin_tick(0), m_max_spin_margin_tick(0), m_last_error_tick(0), m_max_error_tick(0), m_total_error_tick(0), m_frame_count(0) {/*...*/}
+
+            void Initialize(const FrameLimiterInfo *frame_limiter_info);
+            void Finalize();
+
+            /* Blocks until the next frame deadline */
+            void Wait();
+
+            void GetPacingStats(FramePacingStats *out_pacing_stats) const;
+
+            constexpr ALWAYS_INLINE bool IsEnabled() const { return m_frame_tick != 0; }
+    };
 }
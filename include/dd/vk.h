@@ -13,4 +13,5 @@
 #include <dd/vk/vk_pipeline.hpp>
 #include <dd/vk/vk_descriptorpool.hpp>
 #include <dd/vk/vk_commandbuffer.hpp>
+#include <dd/vk/vk_uploadcontext.hpp>
 #include <dd/vk/vk_displaybuffer.hpp>
@@ -216,6 +216,8 @@ namespace dd::vk {
             void UpdateResourceBufferIfNecessary();
 
             void PushResourceBufferIndices();
+
+            void SetTextureMipStateTransition(Texture *texture, const TextureBarrierCmdState *barrier_state, u32 base_mip, u32 mip_count);
         public:
             constexpr CommandBuffer() { /*...*/ }
 
@@ -254,6 +256,9 @@ namespace dd::vk {
             void SetBufferStateTransition(Buffer *buffer, const BufferBarrierCmdState *barrier_state);
             void SetTextureStateTransition(Texture *texture, const TextureBarrierCmdState *barrier_state, VkImageAspectFlagBits aspect_mask);
 
+            /* Blits each level from the one above it, level 0 must be written. The format must support linear filtered blits and the texture transfer usage. Leaves every level in the layout level 0 was written in so registered descriptors stay valid */
+            void GenerateMipmaps(const Context *context, Texture *texture);
+
             void SetDescriptorPool(const DescriptorPool *descriptor_pool);
 
             void SetUniformBuffer(u32 location, ShaderStage shader_stage, const VkDeviceAddress gpu_address);
@@ -20,6 +20,14 @@ namespace dd::vk {
     class CommandBuffer;
     class DisplayBuffer;
 
+    struct ContextInfo {
+        bool is_host_image_copy_allowed;
+
+        constexpr void SetDefaults() {
+            is_host_image_copy_allowed = true;
+        }
+    };
+
     class Context {
         public:
             friend class FrameBuffer;
@@ -106,6 +114,9 @@ namespace dd::vk {
 
             VkPhysicalDeviceMemoryProperties                    m_vk_physical_device_memory_properties;
 
+            bool                                                m_is_host_image_copy_supported;
+            VkImageLayout                                       m_vk_host_image_copy_layout;
+
             #if defined(DD_DEBUG)                               
                 VkDebugUtilsMessengerEXT                        m_debug_messenger;
             #endif                                                                      
@@ -117,6 +128,7 @@ namespace dd::vk {
             util::CriticalSection   m_window_cs;
             bool                    m_has_resized;
             bool                    m_skip_draw;
+            HANDLE                  m_drawable_event;
 
             /* Presentation objects */
             DisplayBuffer                                                              *m_bound_display_buffer;
@@ -128,9 +140,12 @@ namespace dd::vk {
 
             bool PickValidPhysicalDevice();
 
+            /* Host image copy can be turned off to exercise the staging fallback on devices that support it, such as lavapipe */
+            void QueryHostImageCopySupport(const ContextInfo *context_info);
+
             bool FindGraphicsQueueFamily(u32 *queue_family_index);
         public:
-            explicit Context();
+            explicit Context(const ContextInfo *context_info);
 
             ~Context();
             
@@ -170,6 +185,16 @@ namespace dd::vk {
 
             constexpr ALWAYS_INLINE const VkPhysicalDeviceProperties2 *GetPhysicalDeviceProperties() const { return std::addressof(m_vk_physical_device_properties); }
 
+            constexpr ALWAYS_INLINE bool IsHostImageCopySupported() const                              { return m_is_host_image_copy_supported; }
+
+            constexpr ALWAYS_INLINE VkImageLayout GetHostImageCopyLayout() const                       { return m_vk_host_image_copy_layout; }
+
+            /* Host image copy also needs per format support for optimal tiling */
+            bool IsHostImageCopyFormatSupported(VkFormat vk_format) const;
+
+            /* Mipmaps are generated by linear filtered blits between levels of an optimal tiled image */
+            bool IsMipmapGenerationFormatSupported(VkFormat vk_format) const;
+
         public:
 
             void GetWindowDimensions(u32 *out_width, u32 *out_height) {
@@ -200,10 +225,26 @@ namespace dd::vk {
                 m_window_height = height;
                 if (m_window_width == 0 || m_window_height == 0) {
                     m_skip_draw = true;
+                    ::ResetEvent(m_drawable_event);
+                } else {
+                    ::SetEvent(m_drawable_event);
                 }
                 m_has_resized   = true;
             }
 
+            /* Parks the calling thread while the window has no drawable area, returns true if it had to wait */
+            bool WaitForDrawable() {
+                if (::WaitForSingleObject(m_drawable_event, 0) == WAIT_OBJECT_0) { return false; }
+
+                ::WaitForSingleObject(m_drawable_event, INFINITE);
+                return true;
+            }
+
+            /* Releases a parked thread without a resize, used on exit */
+            void SignalDrawable() {
+                ::SetEvent(m_drawable_event);
+            }
+
             void SetResize() {
                 std::scoped_lock l(m_window_cs);
                 m_has_resized   = true;
@@ -287,6 +328,9 @@ namespace dd::vk {
 
             void Present(CommandBuffer *submit_command_buffer);
 
+            /* Submits outside of presentation, serialized with the present thread's use of the graphics queue */
+            void SubmitGraphicsQueue(const VkSubmitInfo2 *submit_info, VkFence vk_fence);
+
             void WaitForGpu();
 
             util::DelegateThread *InitializePresentationThread(DisplayBuffer *display_buffer);
@@ -43,13 +43,46 @@ namespace dd::vk {
             constexpr MemoryPool() {/*...*/}
             
             void Initialize(const Context *context, const MemoryPoolInfo* pool_info) {
-                DD_ASSERT(pool_info->import_memory != nullptr);
 
                 const u32 pool_properties = pool_info->vk_memory_property_flags;
                 
                 m_size = pool_info->size;
                 m_vk_memory_property_flags = pool_properties;
 
+                /* Pools may be heap allocated, so nothing can rely on zeroed storage */
+                m_vk_host_memory   = 0;
+                m_vk_device_memory = 0;
+                m_vk_host_buffer   = 0;
+                m_vk_device_buffer = 0;
+                m_is_import        = false;
+                m_host_pointer     = pool_info->import_memory;
+                m_mapped_memory    = nullptr;
+                m_map_count        = 0;
+
+                /* Without host memory to import the pool is only device memory, optimal tiled textures are filled through an UploadContext */
+                if (pool_info->import_memory == nullptr) {
+                    const s32 device_memory_type = context->FindMemoryHeapIndex(pool_properties);
+                    DD_ASSERT(device_memory_type != -1);
+
+                    const VkMemoryAllocateFlagsInfo device_allocate_flags = {
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+                        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+                    };
+                    const VkMemoryAllocateInfo device_allocate_info =  {
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                        .pNext = std::addressof(device_allocate_flags),
+                        .allocationSize = pool_info->size,
+                        .memoryTypeIndex = static_cast<u32>(device_memory_type)
+                    };
+                    const u32 result0 = ::pfn_vkAllocateMemory(context->GetDevice(), std::addressof(device_allocate_info), nullptr, std::addressof(m_vk_device_memory));
+                    DD_ASSERT(result0 == VK_SUCCESS);
+
+                    m_vk_host_memory      = 0;
+                    m_requires_relocation = false;
+                    m_is_device_memory    = true;
+                    return;
+                }
+
                 /* Check host pointer memory properties */
                 VkMemoryHostPointerPropertiesEXT host_properties = { 
                     .sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT
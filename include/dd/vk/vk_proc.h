@@ -269,4 +269,8 @@ DEFINE_EXTERN_VK_PROC(vkGetMemoryHostPointerPropertiesEXT);
 DEFINE_EXTERN_VK_PROC(vkCmdSetLogicOpEXT);
 DEFINE_EXTERN_VK_PROC(vkCmdSetVertexInputEXT);
 
+/* Optional device extension procs, null when the extension is not enabled */
+DEFINE_EXTERN_VK_PROC(vkCopyMemoryToImageEXT);
+DEFINE_EXTERN_VK_PROC(vkTransitionImageLayoutEXT);
+
 void LoadCProcsDevice(VkDevice device);
@@ -27,18 +27,18 @@ namespace dd::vk {
     };
 
     struct ShaderInfo {
-        size_t  vertex_code_size;
-        u32    *vertex_code;
-        size_t  tessellation_control_code_size;
-        u32    *tessellation_control_code;
-        size_t  tessellation_evaluation_code_size;
-        u32    *tessellation_evaluation_code;
-        size_t  geometry_code_size;
-        u32    *geometry_code;
-        size_t  fragment_code_size;
-        u32    *fragment_code;
-        size_t  compute_code_size;
-        u32    *compute_code;
+        size_t     vertex_code_size;
+        const u32 *vertex_code;
+        size_t     tessellation_control_code_size;
+        const u32 *tessellation_control_code;
+        size_t     tessellation_evaluation_code_size;
+        const u32 *tessellation_evaluation_code;
+        size_t     geometry_code_size;
+        const u32 *geometry_code;
+        size_t     fragment_code_size;
+        const u32 *fragment_code;
+        size_t     compute_code_size;
+        const u32 *compute_code;
     };
 
     class Shader {
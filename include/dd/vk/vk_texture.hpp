@@ -17,9 +17,35 @@
 
 namespace dd::vk {
 
+    /* Block compressed formats are addressed in 4x4 texel blocks */
+    constexpr u32 TextureBlockDimension = 4;
+
+    constexpr ALWAYS_INLINE bool IsBlockCompressedFormat(u32 vk_format) {
+        return VK_FORMAT_BC1_RGB_UNORM_BLOCK <= vk_format && vk_format <= VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    /* BC1 and BC4 blocks are 8 bytes, the rest are 16 */
+    constexpr ALWAYS_INLINE u32 GetBlockCompressedFormatBlockSize(u32 vk_format) {
+        return (vk_format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK || vk_format == VK_FORMAT_BC4_UNORM_BLOCK || vk_format == VK_FORMAT_BC4_SNORM_BLOCK) ? 8 : 16;
+    }
+
+    constexpr ALWAYS_INLINE u64 CalcBlockCompressedMipSize(u32 vk_format, u32 width, u32 height) {
+        const u64 block_count_x = (width + TextureBlockDimension - 1) / TextureBlockDimension;
+        const u64 block_count_y = (height + TextureBlockDimension - 1) / TextureBlockDimension;
+        return block_count_x * block_count_y * GetBlockCompressedFormatBlockSize(vk_format);
+    }
+
+    /* One subresource of texels, tightly packed in upload order */
+    struct TextureUploadRegion {
+        const void *data;
+        size_t      size;
+        u32         mip_level;
+        u32         array_layer;
+    };
+
     struct TextureInfo {
         u32 vk_create_flags;
-        u16 vk_usage_flags;
+        u32 vk_usage_flags;
         u16 mip_levels;
         u32 width;
         u32 height;
@@ -38,6 +64,12 @@ namespace dd::vk {
             VkImage     m_vk_image;
             MemoryPool *m_bound_memory_pool;
             u32         m_vk_image_layout;
+            u32         m_vk_format;
+            u32         m_vk_usage_flags;
+            u32         m_width;
+            u32         m_height;
+            u16         m_mip_levels;
+            u8          m_array_layers;
             bool        m_import;
             bool        m_requires_relocation;
         public:
@@ -45,6 +77,9 @@ namespace dd::vk {
 
             void Initialize(const Context *context, const TextureInfo *texture_info, MemoryPool *memory_pool) {
 
+                /* Linear tiling of block compressed formats is optional and effectively unsupported */
+                DD_ASSERT(IsBlockCompressedFormat(texture_info->vk_format) == false || texture_info->vk_tiling == VK_IMAGE_TILING_OPTIMAL);
+
                 /* Create Image */
                 const u32 queue_family_index = context->GetGraphicsQueueFamilyIndex();
                 const VkImageCreateInfo image_info {
@@ -79,6 +114,12 @@ namespace dd::vk {
                 m_bound_memory_pool = memory_pool;
 
                 m_vk_image_layout = texture_info->vk_image_layout;
+                m_vk_format       = texture_info->vk_format;
+                m_vk_usage_flags  = texture_info->vk_usage_flags;
+                m_width           = texture_info->width;
+                m_height          = texture_info->height;
+                m_mip_levels      = texture_info->mip_levels;
+                m_array_layers    = texture_info->array_layers;
             }
 
             void ImportExisting(VkImage image) {
@@ -99,6 +140,70 @@ namespace dd::vk {
                 m_requires_relocation = true;
             }
 
+            /* Writes texels from host memory with VK_EXT_host_image_copy, no staging or command buffer is involved. The image must be idle on the device */
+            void CopyFromHost(const Context *context, const TextureUploadRegion *region_array, u32 region_count) {
+                DD_ASSERT(context->IsHostImageCopySupported() == true);
+
+                const VkImageLayout copy_layout = context->GetHostImageCopyLayout();
+
+                /* Host transitions complete immediately, existing contents are kept so a texture can be filled over several calls */
+                if (m_vk_image_layout != static_cast<u32>(copy_layout)) {
+                    const VkHostImageLayoutTransitionInfoEXT transition_info = {
+                        .sType            = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+                        .image            = m_vk_image,
+                        .oldLayout        = static_cast<VkImageLayout>(m_vk_image_layout),
+                        .newLayout        = copy_layout,
+                        .subresourceRange = {
+                            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                            .baseMipLevel   = 0,
+                            .levelCount     = m_mip_levels,
+                            .baseArrayLayer = 0,
+                            .layerCount     = m_array_layers
+                        }
+                    };
+                    const u32 result0 = ::pfn_vkTransitionImageLayoutEXT(context->GetDevice(), 1, std::addressof(transition_info));
+                    DD_ASSERT(result0 == VK_SUCCESS);
+
+                    m_vk_image_layout = static_cast<u32>(copy_layout);
+                }
+
+                /* Rows are tightly packed, block compressed mips use their texel extent */
+                constexpr u32 MaxRegionsPerCopy = 16;
+                VkMemoryToImageCopyEXT copy_region_array[MaxRegionsPerCopy] = {};
+                for (u32 i = 0; i < region_count; i += MaxRegionsPerCopy) {
+                    const u32 copy_count = (region_count - i < MaxRegionsPerCopy) ? region_count - i : MaxRegionsPerCopy;
+                    for (u32 j = 0; j < copy_count; ++j) {
+                        const TextureUploadRegion *region = std::addressof(region_array[i + j]);
+                        DD_ASSERT(region->mip_level < m_mip_levels && region->array_layer < m_array_layers);
+
+                        copy_region_array[j] = {
+                            .sType             = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+                            .pHostPointer      = region->data,
+                            .memoryRowLength   = 0,
+                            .memoryImageHeight = 0,
+                            .imageSubresource  = {
+                                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                                .mipLevel       = region->mip_level,
+                                .baseArrayLayer = region->array_layer,
+                                .layerCount     = 1
+                            },
+                            .imageOffset = { 0, 0, 0 },
+                            .imageExtent = { this->GetMipWidth(region->mip_level), this->GetMipHeight(region->mip_level), 1 }
+                        };
+                    }
+
+                    const VkCopyMemoryToImageInfoEXT copy_info = {
+                        .sType          = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+                        .dstImage       = m_vk_image,
+                        .dstImageLayout = copy_layout,
+                        .regionCount    = copy_count,
+                        .pRegions       = copy_region_array
+                    };
+                    const u32 result1 = ::pfn_vkCopyMemoryToImageEXT(context->GetDevice(), std::addressof(copy_info));
+                    DD_ASSERT(result1 == VK_SUCCESS);
+                }
+            }
+
             constexpr ALWAYS_INLINE bool RequiresRelocation() const { return m_requires_relocation; }
 
             constexpr ALWAYS_INLINE VkImage GetImage() const { return m_vk_image; }
@@ -107,6 +212,16 @@ namespace dd::vk {
 
             void SetImageLayout(VkImageLayout new_layout) { m_vk_image_layout = static_cast<u32>(new_layout); }
 
+            constexpr ALWAYS_INLINE u32 GetFormat()      const { return m_vk_format; }
+            constexpr ALWAYS_INLINE u32 GetUsageFlags()  const { return m_vk_usage_flags; }
+            constexpr ALWAYS_INLINE u32 GetWidth()       const { return m_width; }
+            constexpr ALWAYS_INLINE u32 GetHeight()      const { return m_height; }
+            constexpr ALWAYS_INLINE u32 GetMipLevels()   const { return m_mip_levels; }
+            constexpr ALWAYS_INLINE u32 GetArrayLayers() const { return m_array_layers; }
+
+            constexpr ALWAYS_INLINE u32 GetMipWidth(u32 mip_level)  const { return ((m_width >> mip_level) != 0)  ? (m_width >> mip_level)  : 1; }
+            constexpr ALWAYS_INLINE u32 GetMipHeight(u32 mip_level) const { return ((m_height >> mip_level) != 0) ? (m_height >> mip_level) : 1; }
+
             static u64 GetAlignment(const Context *context, const TextureInfo *texture_info) { 
 
                 /* Create staging Image */
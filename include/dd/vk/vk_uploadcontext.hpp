@@ -0,0 +1,101 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#pragma once
+
+namespace dd::vk {
+
+    struct UploadContextInfo {
+        VkDeviceSize staging_size;
+
+        constexpr void SetDefaults() {
+            staging_size = 0x400'0000;
+        }
+    };
+
+    /* A subresource already written to staging memory returned by AllocateStaging */
+    struct TextureCopyRegion {
+        VkDeviceSize staging_offset;
+        u32          mip_level;
+        u32          array_layer;
+    };
+
+    /*
+     * Streams data into optimal tiled device local textures through a persistently mapped staging ring.
+     * Copies are recorded into the current batch until Flush, each submitted batch holds its span of the ring until its fence signals.
+     * Not thread safe, uploads are expected from a single loading thread.
+     */
+    class UploadContext {
+        public:
+            static constexpr u32    MaxBatchesInFlight  = 4;
+            static constexpr size_t MinStagingAlignment = 0x10;
+        private:
+            struct Batch {
+                VkCommandBuffer vk_command_buffer;
+                VkFence         vk_fence;
+                u64             ring_end;
+            };
+        private:
+            Context        *m_context;
+            VkBuffer        m_vk_staging_buffer;
+            VkDeviceMemory  m_vk_staging_memory;
+            u8             *m_staging_address;
+            VkDeviceSize    m_staging_size;
+            size_t          m_staging_alignment;
+            u64             m_ring_head;
+            u64             m_ring_tail;
+            VkCommandPool   m_vk_command_pool;
+            Batch           m_batch_array[MaxBatchesInFlight];
+            u32             m_current_batch;
+            u32             m_oldest_batch;
+            u32             m_pending_batch_count;
+            bool            m_is_recording;
+            bool            m_is_staging_outstanding;
+        private:
+            void BeginBatchIfNotRecording();
+
+            void RetireOldestBatch();
+
+            void SetTextureCopyState(Texture *texture);
+            void SetTextureSampleState(Texture *texture);
+
+            void RecordCopy(Texture *texture, VkDeviceSize staging_offset, u32 mip_level, u32 array_layer);
+        public:
+            constexpr UploadContext() : m_context(nullptr), m_vk_staging_buffer(0), m_vk_staging_memory(0), m_staging_address(nullptr), m_staging_size(0), m_staging_alignment(0), m_ring_head(0), m_ring_tail(0), m_vk_command_pool(0), m_batch_array{}, m_current_batch(0), m_oldest_batch(0), m_pending_batch_count(0), m_is_recording(false), m_is_staging_outstanding(false) {/*...*/}
+
+            void Initialize(Context *context, const UploadContextInfo *upload_context_info);
+            void Finalize(const Context *context);
+
+            /* Reserves staging memory for the current batch, waits on the oldest batch when the ring is full. It must be recorded with CopyStagingToTexture before the next allocation */
+            void *AllocateStaging(size_t size, VkDeviceSize *out_staging_offset);
+
+            /* Records copies out of staging memory, the texture is left in shader read only layout */
+            void CopyStagingToTexture(Texture *texture, const TextureCopyRegion *region_array, u32 region_count);
+
+            /* Copies each region into the ring then records it */
+            void UploadTexture(Texture *texture, const TextureUploadRegion *region_array, u32 region_count);
+
+            /* Submits the current batch, later graphics submissions see its writes */
+            void Flush();
+
+            /* Returns ring space of batches whose fence has signaled without waiting */
+            void RecycleCompletedBatches();
+
+            void WaitIdle();
+
+            constexpr ALWAYS_INLINE VkDeviceSize GetStagingSize()     const { return m_staging_size; }
+            constexpr ALWAYS_INLINE VkDeviceSize GetStagingUsedSize() const { return m_ring_head - m_ring_tail; }
+    };
+}
@@ -41,8 +41,11 @@ namespace dd::hid {
                     ::PostQuitMessage(0);
                     return 0;
                 case WM_INPUT:
+                {
+                    DD_PROFILE_SCOPE("RawInput");
                     SetLastRawInput(reinterpret_cast<HRAWINPUT>(l_param));
                     break;
+                }
                 case WM_INPUT_DEVICE_CHANGE:
                     /* Check for current device migration */
                     
@@ -54,6 +57,7 @@ namespace dd::hid {
 
         long unsigned int HidThreadMain(void *arg) {
             DD_ASSERT(arg == nullptr);
+            util::SetProfilerThreadName("Hid");
 
             /* Create input window */
             const HINSTANCE process_handle = ::GetModuleHandle(nullptr);
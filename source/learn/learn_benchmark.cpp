@@ -0,0 +1,299 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+#include <unordered_map>
+
+namespace dd::learn {
+
+    namespace {
+
+        constexpr u32 BenchmarkKeyCount = 100'000;
+
+        /* The files SetupTriangle loads when no archive or cooked textures are present */
+        constexpr const char *BenchmarkFilePathArray[] = {
+            "shaders/primitive_vertex.spv",
+            "shaders/primitive_fragment.spv",
+            "resources/third_party/woodcrate.jpg",
+            "resources/third_party/awesomeface.png",
+        };
+
+        /* The sample's two images are repeated so the batch has enough work for every core */
+        constexpr const char *BenchmarkImagePathArray[] = {
+            "resources/third_party/woodcrate.jpg",
+            "resources/third_party/awesomeface.png",
+        };
+        constexpr u32 BenchmarkImageLoadCount = 64;
+
+        struct PipelineKey {
+            u64 shader_id;
+            u32 vk_primitive_topology;
+            u32 vk_polygon_mode;
+            u32 color_blend_count;
+            u32 color_write_mask;
+            u64 vertex_state_hash;
+
+            constexpr bool operator==(const PipelineKey& rhs) const {
+                return shader_id == rhs.shader_id && vk_primitive_topology == rhs.vk_primitive_topology && vk_polygon_mode == rhs.vk_polygon_mode && color_blend_count == rhs.color_blend_count && color_write_mask == rhs.color_write_mask && vertex_state_hash == rhs.vertex_state_hash;
+            }
+        };
+        static_assert(sizeof(PipelineKey) == 32);
+
+        struct PipelineKeyStdHash {
+            size_t operator()(const PipelineKey& key) const { return util::FlatHashDefault<PipelineKey>{}(key); }
+        };
+
+        template <typename K>
+        struct StdHash {
+            using Type = std::hash<K>;
+        };
+
+        template <>
+        struct StdHash<PipelineKey> {
+            using Type = PipelineKeyStdHash;
+        };
+
+        constexpr ALWAYS_INLINE u64 NextRandom(u64 *state) {
+            u64 x = *state;
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            *state = x;
+            return x;
+        }
+
+        template <typename K>
+        constexpr K MakeKey(u64 random) {
+            if constexpr (std::is_same<K, PipelineKey>::value) {
+                return PipelineKey{ random, static_cast<u32>(random >> 7) & 0xf, static_cast<u32>(random >> 11) & 0x3, 1, 0xf, random * 31 };
+            } else {
+                return static_cast<K>(random);
+            }
+        }
+
+        double TickToMicroseconds(s64 tick) {
+            return static_cast<double>(tick) * 1'000'000.0 / static_cast<double>(util::GetSystemTickFrequency());
+        }
+
+        template <typename K>
+        void BenchmarkKey(const char *key_name) {
+
+            /* Generate keys, the second half is never inserted */
+            K *key_array = new (std::nothrow) K[BenchmarkKeyCount * 2];
+            DD_ASSERT(key_array != nullptr);
+
+            u64 random_state = 0x9e37'79b9'7f4a'7c15ull;
+            for (u32 i = 0; i < BenchmarkKeyCount * 2; ++i) {
+                key_array[i] = MakeKey<K>(NextRandom(std::addressof(random_state)));
+            }
+
+            util::FlatHashMap<K, u32>                          flat_map;
+            std::unordered_map<K, u32, typename StdHash<K>::Type> std_map;
+            u64 checksum = 0;
+
+            /* Insert */
+            const s64 flat_insert_begin = util::GetSystemTick();
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                flat_map.Insert(key_array[i], i);
+            }
+            const s64 flat_insert_end = util::GetSystemTickOrdered();
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                std_map[key_array[i]] = i;
+            }
+            const s64 std_insert_end = util::GetSystemTickOrdered();
+
+            /* Successful lookups */
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                checksum += *flat_map.Find(key_array[i]);
+            }
+            const s64 flat_hit_end = util::GetSystemTickOrdered();
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                checksum += std_map.find(key_array[i])->second;
+            }
+            const s64 std_hit_end = util::GetSystemTickOrdered();
+
+            /* Failed lookups */
+            for (u32 i = BenchmarkKeyCount; i < BenchmarkKeyCount * 2; ++i) {
+                checksum += (flat_map.Find(key_array[i]) == nullptr);
+            }
+            const s64 flat_miss_end = util::GetSystemTickOrdered();
+            for (u32 i = BenchmarkKeyCount; i < BenchmarkKeyCount * 2; ++i) {
+                checksum += (std_map.find(key_array[i]) == std_map.end());
+            }
+            const s64 std_miss_end = util::GetSystemTickOrdered();
+
+            /* Removal */
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                checksum += flat_map.Remove(key_array[i]);
+            }
+            const s64 flat_remove_end = util::GetSystemTickOrdered();
+            for (u32 i = 0; i < BenchmarkKeyCount; ++i) {
+                checksum += std_map.erase(key_array[i]);
+            }
+            const s64 std_remove_end = util::GetSystemTickOrdered();
+
+            std::printf("FlatHashMap<%s> %u keys (flat us / std us) insert: %.0f / %.0f, hit: %.0f / %.0f, miss: %.0f / %.0f, remove: %.0f / %.0f [%llx]\n",
+                key_name, BenchmarkKeyCount,
+                TickToMicroseconds(flat_insert_end - flat_insert_begin), TickToMicroseconds(std_insert_end - flat_insert_end),
+                TickToMicroseconds(flat_hit_end - std_insert_end),       TickToMicroseconds(std_hit_end - flat_hit_end),
+                TickToMicroseconds(flat_miss_end - std_hit_end),         TickToMicroseconds(std_miss_end - flat_miss_end),
+                TickToMicroseconds(flat_remove_end - std_miss_end),      TickToMicroseconds(std_remove_end - flat_remove_end),
+                static_cast<unsigned long long>(checksum));
+
+            flat_map.Finalize();
+            delete[] key_array;
+        }
+
+        /* Bilinear footprint of one screen pixel, returns a checksum so the loads are kept */
+        u64 SampleLevel(const u8 *level, u32 level_size, u32 screen_size, u32 step) {
+            u64 checksum = 0;
+            for (u32 y = 0; y < screen_size; ++y) {
+                const u32 v0 = y * step;
+                const u32 v1 = (v0 + 1 < level_size) ? v0 + 1 : v0;
+                const u8 *row0 = level + static_cast<size_t>(v0) * level_size * 4;
+                const u8 *row1 = level + static_cast<size_t>(v1) * level_size * 4;
+                for (u32 x = 0; x < screen_size; ++x) {
+                    const u32 u0 = x * step * 4;
+                    const u32 u1 = ((x * step + 1 < level_size) ? x * step + 1 : x * step) * 4;
+                    checksum += row0[u0] + row0[u1] + row1[u0] + row1[u1];
+                }
+            }
+            return checksum;
+        }
+    }
+
+    void BenchmarkFlatHashMap() {
+        BenchmarkKey<u32>("u32");
+        BenchmarkKey<u64>("u64");
+        BenchmarkKey<PipelineKey>("PipelineKey");
+    }
+
+    void BenchmarkMipSampling() {
+
+        /* Noise texture with a full chain, level 0 is well past the last level cache */
+        constexpr u32 TextureSize = 4096;
+        const u32    mip_levels   = res::CalcMipLevels(TextureSize, TextureSize);
+        const size_t chain_size   = res::CalcMipChainSizeRgba8(TextureSize, TextureSize, mip_levels);
+
+        u8 *chain = new (std::nothrow) u8[chain_size];
+        DD_ASSERT(chain != nullptr);
+
+        u64 random_state = 0x9e37'79b9'7f4a'7c15ull;
+        for (size_t i = 0; i < static_cast<size_t>(TextureSize) * TextureSize * 4; i += sizeof(u64)) {
+            const u64 random = NextRandom(std::addressof(random_state));
+            ::memcpy(chain + i, std::addressof(random), sizeof(u64));
+        }
+
+        /* Chain generation throughput */
+        const double level0_mb = static_cast<double>(TextureSize) * TextureSize * 4 / (1024.0 * 1024.0);
+        const s64 kaiser_begin = util::GetSystemTick();
+        res::GenerateMipChainRgba8(chain, TextureSize, TextureSize, mip_levels, true, res::MipFilter_Kaiser);
+        const s64 box_begin = util::GetSystemTick();
+        res::GenerateMipChainRgba8(chain, TextureSize, TextureSize, mip_levels, true, res::MipFilter_Box);
+        const s64 box_end = util::GetSystemTickOrdered();
+        std::printf("GenerateMipChainRgba8 %ux%u srgb: kaiser %.0f MB/s, box %.0f MB/s\n", TextureSize, TextureSize, level0_mb / (TickToMicroseconds(box_begin - kaiser_begin) / 1'000'000.0), level0_mb / (TickToMicroseconds(box_end - box_begin) / 1'000'000.0));
+
+        /* Draw the texture at increasing distance, sampling level 0 with a stride against the matching mip */
+        u64 checksum = 0;
+        for (u32 distance = 1; distance <= 64; distance = distance * 2) {
+            const u32 screen_size = TextureSize / distance;
+            const u32 level       = res::CalcMipLevels(distance, distance) - 1;
+
+            const u8 *mip = chain;
+            for (u32 i = 0; i < level; ++i) {
+                mip += static_cast<size_t>(res::CalcMipDimension(TextureSize, i)) * res::CalcMipDimension(TextureSize, i) * 4;
+            }
+
+            const s64 level0_begin = util::GetSystemTick();
+            checksum += SampleLevel(chain, TextureSize, screen_size, distance);
+            const s64 level0_end = util::GetSystemTickOrdered();
+            checksum += SampleLevel(mip, res::CalcMipDimension(TextureSize, level), screen_size, 1);
+            const s64 mip_end = util::GetSystemTickOrdered();
+
+            const double sample_count = static_cast<double>(screen_size) * screen_size;
+            const double level0_ns    = TickToMicroseconds(level0_end - level0_begin) * 1000.0 / sample_count;
+            const double mip_ns       = TickToMicroseconds(mip_end - level0_end) * 1000.0 / sample_count;
+            std::printf("MipSampling %2ux distance %4ux%-4u level 0: %.2f ns/sample, level %u: %.2f ns/sample (%.1fx)\n", distance, screen_size, screen_size, level0_ns, level, mip_ns, (mip_ns == 0.0) ? 0.0 : level0_ns / mip_ns);
+        }
+        std::printf("MipSampling [%llx]\n", static_cast<unsigned long long>(checksum));
+
+        delete[] chain;
+    }
+
+    void BenchmarkFileAccess() {
+
+        /* First use reads every byte, files are loaded once beforehand so both paths start from the page cache */
+        for (const char *path : BenchmarkFilePathArray) {
+            void *warm_file = nullptr;
+            res::LoadFile(path, std::addressof(warm_file), nullptr);
+            delete[] reinterpret_cast<char*>(warm_file);
+
+            res::FileStats stats_before = {};
+            res::GetFileStats(std::addressof(stats_before));
+
+            const s64 copy_begin = util::GetSystemTick();
+            void *file      = nullptr;
+            u32   file_size = 0;
+            res::LoadFile(path, std::addressof(file), std::addressof(file_size));
+            const u32 copy_crc = util::Crc32c(file, file_size);
+            const s64 copy_end = util::GetSystemTickOrdered();
+            delete[] reinterpret_cast<char*>(file);
+
+            res::FileStats stats_copy = {};
+            res::GetFileStats(std::addressof(stats_copy));
+
+            const s64 map_begin = util::GetSystemTick();
+            res::MappedFile mapped_file;
+            mapped_file.Initialize(path, res::MappedFileAccess_Sequential);
+            const u32 map_crc = util::Crc32c(mapped_file.GetView(), mapped_file.GetSize());
+            const s64 map_end = util::GetSystemTickOrdered();
+            mapped_file.Finalize();
+
+            res::FileStats stats_map = {};
+            res::GetFileStats(std::addressof(stats_map));
+
+            DD_ASSERT(copy_crc == map_crc);
+            std::printf("FileAccess %s %u bytes, time to first use: copy %.1f us (%llu bytes copied), map %.1f us (%llu bytes copied)\n", path, file_size,
+                TickToMicroseconds(copy_end - copy_begin), static_cast<unsigned long long>(stats_copy.bytes_copied - stats_before.bytes_copied),
+                TickToMicroseconds(map_end - map_begin), static_cast<unsigned long long>(stats_map.bytes_copied - stats_copy.bytes_copied));
+        }
+    }
+
+    void BenchmarkImageDecode() {
+
+        res::StbImageLoad *load_array = new (std::nothrow) res::StbImageLoad[BenchmarkImageLoadCount];
+        DD_ASSERT(load_array != nullptr);
+
+        /* One thread against every core */
+        const u32 thread_count_array[] = { 1, 0 };
+        for (const u32 thread_count : thread_count_array) {
+            for (u32 i = 0; i < BenchmarkImageLoadCount; ++i) {
+                load_array[i] = { .path = BenchmarkImagePathArray[i % (sizeof(BenchmarkImagePathArray) / sizeof(const char*))], .desired_channels = 4 };
+            }
+
+            res::StbImageBatchStats batch_stats = {};
+            res::LoadStbImages(load_array, BenchmarkImageLoadCount, thread_count, std::addressof(batch_stats));
+
+            for (u32 i = 0; i < BenchmarkImageLoadCount; ++i) {
+                DD_ASSERT(load_array[i].is_success == true);
+                res::FreeStbImage(load_array[i].image_data);
+            }
+
+            std::printf("StbImageDecode %u images on %u threads: %.1f MB/s (%llu file bytes, %llu decoded bytes)\n", BenchmarkImageLoadCount, batch_stats.thread_count, batch_stats.decode_mb_per_second, static_cast<unsigned long long>(batch_stats.file_bytes), static_cast<unsigned long long>(batch_stats.decoded_bytes));
+        }
+
+        delete[] load_array;
+    }
+}
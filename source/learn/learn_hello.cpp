@@ -20,7 +20,7 @@ namespace dd::learn {
     namespace {
 
         /* Vulkan objects */
-        util::TypeStorage<vk::Shader>         vk_shader;
+        res::ResourceHandle<vk::Shader>       shader_handle;
         util::TypeStorage<vk::DescriptorPool> vk_texture_descriptor_pool;
         util::TypeStorage<vk::DescriptorPool> vk_sampler_descriptor_pool;
 
@@ -28,21 +28,36 @@ namespace dd::learn {
         util::TypeStorage<vk::Buffer>         vk_vertex_buffer;
         util::TypeStorage<vk::Buffer>         vk_index_buffer;
         util::TypeStorage<vk::Buffer>         vk_uniform_buffer;
-        unsigned char *texture0 = nullptr;
-        unsigned char *texture1 = nullptr;
         util::TypeStorage<vk::MemoryPool>     vk_image_memory;
-        util::TypeStorage<vk::Texture>        vk_texture0;
-        util::TypeStorage<vk::Texture>        vk_texture1;
-        util::TypeStorage<vk::Sampler>        vk_sampler;
+        res::ResourceHandle<vk::Texture>      texture0_handle;
+        res::ResourceHandle<vk::Texture>      texture1_handle;
+        res::ResourceHandle<vk::Sampler>      sampler_handle;
         util::TypeStorage<vk::TextureView>    vk_texture_view0;
         util::TypeStorage<vk::TextureView>    vk_texture_view1;
+        util::TypeStorage<vk::UploadContext>  vk_upload_context;
         vk::DescriptorSlot                    texture_view0_slot;
         vk::DescriptorSlot                    texture_view1_slot;
         vk::DescriptorSlot                    sampler_slot;
 
+        /* Io */
+        util::TypeStorage<res::IoQueue>       io_queue;
+        util::TypeStorage<res::ResourceCache> resource_cache;
+
         /* Resources */
         const char *vertex_shader_path = "shaders/primitive_vertex.spv";
         const char *fragment_shader_path = "shaders/primitive_fragment.spv";
+        const char *texture0_path = "resources/third_party/woodcrate.jpg";
+        const char *texture1_path = "resources/third_party/awesomeface.png";
+
+        /* Cooked with "learn.exe --cook <cooked> <image> -linear", stb decode is skipped when both exist */
+        const char *cooked_texture0_path = "resources/cooked/woodcrate.ddtx";
+        const char *cooked_texture1_path = "resources/cooked/awesomeface.ddtx";
+
+        /* Cooked with "learn.exe --cookmesh <mesh> resources/cube.obj", the vertex array below is used when it is missing */
+        const char *cooked_mesh_path = "resources/cooked/cube.ddms";
+
+        /* Packed with "learn.exe --pack learn.ddar <files>", loose files are used when it is missing */
+        const char *archive_path = "learn.ddar";
 
         const float vertices[] = {
             /* Position */       /* Tex Coords */
@@ -111,6 +126,11 @@ namespace dd::learn {
         constexpr inline u32 CubeCount = sizeof(CubePositions) / sizeof(util::math::Vector3f);
 
         dd::util::math::Matrix34f model_matrix = util::math::IdentityMatrix34<float>;
+
+        /* Scene */
+        util::SceneNode  scene_root;
+        util::SceneNode  cube_nodes[CubeCount];
+        util::SceneGraph scene_graph;
         dd::util::LookAtCamera camera = {{ 0.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }};
         dd::util::PerspectiveProjection perspective_projection(0.1f, 100.0f, util::math::TRadians<float, 45.0f>, 1280.0f / 720.0f);
 
@@ -125,8 +145,28 @@ namespace dd::learn {
         float yaw = -90.0f;
         float pitch = 0.0f;
 
+        /* Simulated camera positions of the last two steps, blended for render */
+        util::math::Vector3f previous_camera_pos = { 0.0f, 0.0f, 3.0f };
+        util::math::Vector3f current_camera_pos  = { 0.0f, 0.0f, 3.0f };
+
+        util::math::Vector3f CalcCameraFront() {
+            const float yaw_rad   = util::math::AngleHalfRound(util::math::ToRadians(yaw));
+            const float pitch_rad = util::math::AngleHalfRound(util::math::ToRadians(pitch));
+            const float cos_pitch = util::math::SampleCos(pitch_rad);
+
+            const util::math::Vector3f dir = {
+                util::math::SampleCos(yaw_rad) * cos_pitch,
+                util::math::SampleSin(pitch_rad),
+                util::math::SampleSin(yaw_rad) * cos_pitch
+            };
+
+            return dir.Normalize();
+        }
+
         char *memory_buffer = nullptr;
-        char *memory_image = nullptr;
+
+        /* Decoded textures only upload their base level, the rest is blitted on the first frame */
+        bool is_mipmap_generation_pending = false;
 
         /* Vulkan pipeline state */
         util::TypeStorage<vk::Pipeline>       vk_pipeline;
@@ -158,37 +198,159 @@ namespace dd::learn {
             },
         };
         constexpr size_t input_attribute_count = sizeof(vk_attribute_descriptions) / sizeof(VkVertexInputAttributeDescription2EXT);
+
+        /* Cooked mesh, each stream is its own binding and quantized positions are restored by the model matrix */
+        res::Mesh                             mesh                                  = {};
+        bool                                  is_mesh                               = false;
+        util::math::Matrix34f                 mesh_dequantize_matrix                = util::math::IdentityMatrix34<float>;
+        VkVertexInputBindingDescription2EXT   vk_mesh_input_binding_descriptions[2] = {};
+        VkVertexInputAttributeDescription2EXT vk_mesh_attribute_descriptions[2]     = {};
+
+        /* Each cube draws the coarsest lod whose error projects to under a pixel */
+        constexpr float MeshLodPixelError = 1.0f;
+        u32             cube_lods[CubeCount] = {};
+
+        /* Uncompressed entries are used in place, compressed entries are expanded into a new[] buffer returned in out_buffer */
+        const void *GetArchiveFile(res::Archive *archive, const char *name, u32 *out_file_size, void **out_buffer) {
+            const res::ArchiveEntry *entry = archive->FindEntry(name);
+            DD_ASSERT(entry != nullptr && entry->size <= 0xffff'ffff);
+
+            *out_file_size = static_cast<u32>(entry->size);
+            *out_buffer    = nullptr;
+
+            if (entry->compression == res::ArchiveCompression_None) {
+                return archive->GetEntryView(entry);
+            }
+
+            *out_buffer = new (std::nothrow) char[entry->size];
+            DD_ASSERT(*out_buffer != nullptr);
+
+            archive->ReadEntry(entry, *out_buffer);
+            return *out_buffer;
+        }
     }
 
     void SetupTriangle() {
 
         vk::Context *context = vk::GetGlobalContext();
 
-        /* Load Shader */
-        char *vertex_shader = nullptr;
-        char *fragment_shader = nullptr;
-        u32 vertex_size = 0, fragment_size = 0;
-        res::LoadFile(vertex_shader_path, reinterpret_cast<void**>(std::addressof(vertex_shader)), std::addressof(vertex_size));
-        res::LoadFile(fragment_shader_path, reinterpret_cast<void**>(std::addressof(fragment_shader)), std::addressof(fragment_size));
-
-        /* Create Shader */
-        dd::util::ConstructAt(vk_shader);
-        const vk::ShaderInfo shader_info = {
-            .vertex_code_size = vertex_size,
-            .vertex_code = reinterpret_cast<u32*>(vertex_shader),
-            .fragment_code_size = fragment_size,
-            .fragment_code = reinterpret_cast<u32*>(fragment_shader)
+        /* Map archive */
+        res::Archive archive;
+        const bool is_archive = ::GetFileAttributes(archive_path) != INVALID_FILE_ATTRIBUTES;
+        if (is_archive == true) {
+            archive.Initialize(archive_path);
+        }
+
+        const bool is_cooked = ::GetFileAttributes(cooked_texture0_path) != INVALID_FILE_ATTRIBUTES && ::GetFileAttributes(cooked_texture1_path) != INVALID_FILE_ATTRIBUTES;
+
+        /* Start texture reads, shader creation overlaps them */
+        dd::util::ConstructAt(io_queue);
+        res::IoQueueInfo io_queue_info = {};
+        io_queue_info.SetDefaults();
+        util::GetReference(io_queue).Initialize(std::addressof(io_queue_info));
+
+        res::IoRequest texture_request_array[] = {
+            { .path = texture0_path },
+            { .path = texture1_path },
         };
-        util::GetReference(vk_shader).Initialize(context, std::addressof(shader_info));
+        if (is_archive == false && is_cooked == false) {
+            util::GetReference(io_queue).Submit(texture_request_array, sizeof(texture_request_array) / sizeof(res::IoRequest));
+        }
+
+        /* Create resource cache, shaders, textures and samplers are shared by path and parameters */
+        util::ConstructAt(resource_cache);
+        res::ResourceCacheInfo resource_cache_info = {};
+        resource_cache_info.SetDefaults();
+
+        res::ResourceCache *cache = util::GetPointer(resource_cache);
+        cache->Initialize(std::addressof(resource_cache_info));
+
+        /* Map and create Shader on a cache miss, SPIR-V is consumed straight from the views unless its archive entry is compressed */
+        const u64 shader_key = res::MakeResourceKey(fragment_shader_path, res::MakeResourceKey(vertex_shader_path));
+        shader_handle = cache->Acquire<vk::Shader>(shader_key, [&](size_t *out_memory_size) -> vk::Shader* {
+            res::MappedFile vertex_shader;
+            res::MappedFile fragment_shader;
+            void           *vertex_buffer   = nullptr;
+            void           *fragment_buffer = nullptr;
+            vk::ShaderInfo  shader_info = {};
+            if (is_archive == true) {
+                u32 vertex_code_size   = 0;
+                u32 fragment_code_size = 0;
+                shader_info.vertex_code        = reinterpret_cast<const u32*>(GetArchiveFile(std::addressof(archive), vertex_shader_path, std::addressof(vertex_code_size), std::addressof(vertex_buffer)));
+                shader_info.vertex_code_size   = vertex_code_size;
+                shader_info.fragment_code      = reinterpret_cast<const u32*>(GetArchiveFile(std::addressof(archive), fragment_shader_path, std::addressof(fragment_code_size), std::addressof(fragment_buffer)));
+                shader_info.fragment_code_size = fragment_code_size;
+            } else {
+                vertex_shader.Initialize(vertex_shader_path, res::MappedFileAccess_WillNeed);
+                fragment_shader.Initialize(fragment_shader_path, res::MappedFileAccess_WillNeed);
+
+                shader_info.vertex_code_size   = vertex_shader.GetSize();
+                shader_info.vertex_code        = vertex_shader.GetViewAs<u32>(0);
+                shader_info.fragment_code_size = fragment_shader.GetSize();
+                shader_info.fragment_code      = fragment_shader.GetViewAs<u32>(0);
+            }
 
-        /* Load textures */
+            vk::Shader *shader = new (std::nothrow) vk::Shader();
+            DD_ASSERT(shader != nullptr);
+            shader->Initialize(context, std::addressof(shader_info));
+            *out_memory_size = shader_info.vertex_code_size + shader_info.fragment_code_size;
+
+            vertex_shader.Finalize();
+            fragment_shader.Finalize();
+            delete[] reinterpret_cast<char*>(vertex_buffer);
+            delete[] reinterpret_cast<char*>(fragment_buffer);
+            return shader;
+        }, res::FinalizeAndDeleteResource<vk::Shader, vk::Context>, context);
+
+        /* Gather encoded textures */
+        res::StbImageLoad image_load_array[] = {
+            { .path = texture0_path, .desired_channels = 4 },
+            { .path = texture1_path, .desired_channels = 4 },
+        };
+        constexpr u32 image_load_count = sizeof(image_load_array) / sizeof(res::StbImageLoad);
+
+        void *archive_buffer_array[image_load_count] = {};
+        if (is_cooked == false && is_archive == true) {
+            for (u32 i = 0; i < image_load_count; ++i) {
+                image_load_array[i].file = GetArchiveFile(std::addressof(archive), image_load_array[i].path, std::addressof(image_load_array[i].file_size), std::addressof(archive_buffer_array[i]));
+            }
+        } else if (is_cooked == false) {
+            util::GetReference(io_queue).WaitIdle();
+            for (u32 i = 0; i < image_load_count; ++i) {
+                DD_ASSERT(texture_request_array[i].result == res::IoResult_Success);
+                image_load_array[i].file      = texture_request_array[i].buffer;
+                image_load_array[i].file_size = texture_request_array[i].bytes_read;
+            }
+        }
+
+        /* Size textures from their headers so they can decode straight into staging memory */
         s32 width0 = 0, height0 = 0, channels0 = 0;
         s32 width1 = 0, height1 = 0, channels1 = 0;
-        res::LoadStbImage("resources/third_party/woodcrate.jpg", 4, std::addressof(texture0), std::addressof(width0), std::addressof(height0), std::addressof(channels0));
-        res::LoadStbImage("resources/third_party/awesomeface.png", 0, std::addressof(texture1), std::addressof(width1), std::addressof(height1), std::addressof(channels1));
-
-        const s64 texture0_size = width0 * height0 * 4;
-        const s64 texture1_size = width1 * height1 * channels1;
+        u32 mip_levels0 = 1, mip_levels1 = 1;
+        VkFormat texture0_format = VK_FORMAT_R8G8B8A8_UNORM;
+        VkFormat texture1_format = VK_FORMAT_R8G8B8A8_UNORM;
+        res::CookedTexture cooked_texture0 = {};
+        res::CookedTexture cooked_texture1 = {};
+        if (is_cooked == true) {
+            res::LoadCookedTexture(cooked_texture0_path, std::addressof(cooked_texture0));
+            res::LoadCookedTexture(cooked_texture1_path, std::addressof(cooked_texture1));
+
+            width0          = cooked_texture0.header->width;
+            height0         = cooked_texture0.header->height;
+            mip_levels0     = cooked_texture0.header->mip_levels;
+            texture0_format = static_cast<VkFormat>(cooked_texture0.header->vk_format);
+            width1          = cooked_texture1.header->width;
+            height1         = cooked_texture1.header->height;
+            mip_levels1     = cooked_texture1.header->mip_levels;
+            texture1_format = static_cast<VkFormat>(cooked_texture1.header->vk_format);
+        } else {
+            const bool result0 = res::GetStbImageInfo(image_load_array[0].file, image_load_array[0].file_size, std::addressof(width0), std::addressof(height0), std::addressof(channels0));
+            const bool result1 = res::GetStbImageInfo(image_load_array[1].file, image_load_array[1].file_size, std::addressof(width1), std::addressof(height1), std::addressof(channels1));
+            DD_ASSERT(result0 == true && result1 == true);
+
+            mip_levels0 = res::CalcMipLevels(width0, height0);
+            mip_levels1 = res::CalcMipLevels(width1, height1);
+        }
 
         /* Create resource infos */
         vk::BufferInfo vertex_buffer_info = {
@@ -207,73 +369,86 @@ namespace dd::learn {
         };
         
         vk::TextureInfo texture0_info = {
-            .vk_usage_flags       = VK_IMAGE_USAGE_SAMPLED_BIT,
-            .mip_levels           = 1,
+            .vk_usage_flags       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .mip_levels           = static_cast<u16>(mip_levels0),
             .width                = static_cast<u32>(width0),
             .height               = static_cast<u32>(height0),
             .depth                = 1,
-            .vk_format            = VK_FORMAT_R8G8B8A8_UNORM,
-            .vk_image_layout      = VK_IMAGE_LAYOUT_PREINITIALIZED,
+            .vk_format            = texture0_format,
+            .vk_image_layout      = VK_IMAGE_LAYOUT_UNDEFINED,
             .vk_image_type        = VK_IMAGE_TYPE_2D,
             .vk_sample_count_flag = VK_SAMPLE_COUNT_1_BIT,
-            .vk_tiling            = VK_IMAGE_TILING_LINEAR,
+            .vk_tiling            = VK_IMAGE_TILING_OPTIMAL,
             .array_layers         = 1,
             .memory_offset        = 0
         };
         
         vk::TextureInfo texture1_info = {
-            .vk_usage_flags       = VK_IMAGE_USAGE_SAMPLED_BIT,
-            .mip_levels           = 1,
+            .vk_usage_flags       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .mip_levels           = static_cast<u16>(mip_levels1),
             .width                = static_cast<u32>(width1),
             .height               = static_cast<u32>(height1),
             .depth                = 1,
-            .vk_format            = VK_FORMAT_R8G8B8A8_UNORM,
-            .vk_image_layout      = VK_IMAGE_LAYOUT_PREINITIALIZED,
+            .vk_format            = texture1_format,
+            .vk_image_layout      = VK_IMAGE_LAYOUT_UNDEFINED,
             .vk_image_type        = VK_IMAGE_TYPE_2D,
             .vk_sample_count_flag = VK_SAMPLE_COUNT_1_BIT,
-            .vk_tiling            = VK_IMAGE_TILING_LINEAR,
+            .vk_tiling            = VK_IMAGE_TILING_OPTIMAL,
             .array_layers         = 1
         };
+
+        /* Host image copy writes texels straight from the decoded or mapped source, otherwise they go through the staging ring */
+        const bool is_host_image_copy = context->IsHostImageCopyFormatSupported(texture0_format) == true && context->IsHostImageCopyFormatSupported(texture1_format) == true;
+        if (is_host_image_copy == true) {
+            texture0_info.vk_usage_flags |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+            texture1_info.vk_usage_flags |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+        }
         
         /* Calculate offsets */
         index_buffer_info.offset    = util::AlignUp(sizeof(vertices), vk::Buffer::GetAlignment(context, std::addressof(index_buffer_info)));
         uniform_buffer_info.offset  = util::AlignUp(index_buffer_info.offset + sizeof(indices), vk::Buffer::GetAlignment(context, std::addressof(uniform_buffer_info)));
 
-        texture1_info.memory_offset = util::AlignUp(texture0_size, vk::Texture::GetAlignment(context, std::addressof(texture1_info)));
+        /* Optimal tiled images are sized by the driver */
+        texture1_info.memory_offset = util::AlignUp(vk::Texture::GetRequiredMemory(context, std::addressof(texture0_info)), vk::Texture::GetAlignment(context, std::addressof(texture1_info)));
 
         /* Determine memory size */
         const u64 buffer_memory_size = util::AlignUp(uniform_buffer_info.offset + UniformBufferSize, vk::Context::TargetMemoryPoolAlignment);
-        const u64 image_memory_size = util::AlignUp(texture1_info.memory_offset + texture1_size, vk::Context::TargetMemoryPoolAlignment);
+        const u64 image_memory_size = util::AlignUp(texture1_info.memory_offset + vk::Texture::GetRequiredMemory(context, std::addressof(texture1_info)), vk::Context::TargetMemoryPoolAlignment);
 
         /* Copy host memory */
         memory_buffer = new(std::align_val_t(vk::Context::TargetMemoryPoolAlignment)) char[buffer_memory_size];
-        memory_image  = new(std::align_val_t(vk::Context::TargetMemoryPoolAlignment)) char[image_memory_size];
         DD_ASSERT(memory_buffer != nullptr);
-        DD_ASSERT(memory_image != nullptr);
         
         ::memcpy(memory_buffer, vertices, sizeof(vertices));
         ::memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memory_buffer) + index_buffer_info.offset), indices, sizeof(indices));
 
+        /* Build scene */
+        util::SceneGraphInfo scene_graph_info = {};
+        scene_graph_info.SetDefaults();
+        scene_graph.Initialize(std::addressof(scene_root), std::addressof(scene_graph_info));
+
+        for (u32 i = 0; i < CubeCount; ++i) {
+            util::math::Matrix34f cube_matrix = model_matrix;
+            cube_matrix.SetColumn(3, CubePositions[i]);
+
+            float rot_angle = 20.0f * i;
+            dd::util::math::RotateLocalX(std::addressof(cube_matrix), rot_angle);
+            dd::util::math::RotateLocalY(std::addressof(cube_matrix), 0.3f * rot_angle);
+            dd::util::math::RotateLocalZ(std::addressof(cube_matrix), 0.5f * rot_angle);
+
+            scene_graph.AddChild(std::addressof(scene_root), std::addressof(cube_nodes[i]));
+            scene_graph.SetLocalMatrix(std::addressof(cube_nodes[i]), cube_matrix);
+        }
+        scene_graph.Update();
+
         ViewArg view_arg[CubeCount] = {};
         for (u32 i = 0; i < CubeCount; ++i) {
-            view_arg[i].model_matrix = model_matrix;
+            view_arg[i].model_matrix = scene_graph.GetWorldMatrix(std::addressof(cube_nodes[i]));
             view_arg[i].view_matrix = *camera.GetCameraMatrix();
             view_arg[i].projection_matrix = *perspective_projection.GetProjectionMatrix();
-            
-            float rot_angle = 20.0f * i;
-            dd::util::math::RotateLocalX(std::addressof(view_arg[i].model_matrix), rot_angle);
-            dd::util::math::RotateLocalY(std::addressof(view_arg[i].model_matrix), 0.3f * rot_angle);
-            dd::util::math::RotateLocalZ(std::addressof(view_arg[i].model_matrix), 0.5f * rot_angle);
         }
         ::memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memory_buffer) + uniform_buffer_info.offset), view_arg, sizeof(view_arg));
         
-        ::memcpy(memory_image, texture0, texture0_size);
-        ::memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memory_image) + texture1_info.memory_offset), texture1, texture1_size);
-
-        /* Free unneeded image buffers */
-        res::FreeStbImage(texture0);
-        res::FreeStbImage(texture1);
-
         /* Create buffer memory pool */
         util::ConstructAt(vk_buffer_memory);
         const vk::MemoryPoolInfo buffer_pool_info = {
@@ -284,12 +459,12 @@ namespace dd::learn {
         vk::MemoryPool *buffer_pool = util::GetPointer(vk_buffer_memory);
         buffer_pool->Initialize(context, std::addressof(buffer_pool_info));
         
-        /* Create image memory pool */
+        /* Create image memory pool, it has no host side */
         util::ConstructAt(vk_image_memory);
         const vk::MemoryPoolInfo image_pool_info = {
             .size                     = image_memory_size,
             .vk_memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            .import_memory            = memory_image
+            .import_memory            = nullptr
         };
         vk::MemoryPool *image_pool = util::GetPointer(vk_image_memory);
         image_pool->Initialize(context, std::addressof(image_pool_info));
@@ -304,25 +479,114 @@ namespace dd::learn {
         util::ConstructAt(vk_uniform_buffer);
         util::GetReference(vk_uniform_buffer).Initialize(context, std::addressof(uniform_buffer_info), buffer_pool);
 
-        /* Create textures */
-        util::ConstructAt(vk_texture0);
-        util::GetReference(vk_texture0).Initialize(context, std::addressof(texture0_info), image_pool);
+        /* Create textures on a cache miss, keyed by their source, format and mip count. A texture named twice is uploaded into the same image */
+        const auto acquire_texture = [&](const char *path, const vk::TextureInfo *texture_info) -> res::ResourceHandle<vk::Texture> {
+            const u64 texture_key = res::MakeResourceKey(path, (static_cast<u64>(texture_info->vk_format) << 32) | texture_info->mip_levels);
+            return cache->Acquire<vk::Texture>(texture_key, [&](size_t *out_memory_size) -> vk::Texture* {
+                vk::Texture *texture = new (std::nothrow) vk::Texture();
+                DD_ASSERT(texture != nullptr);
+                texture->Initialize(context, texture_info, image_pool);
+                *out_memory_size = vk::Texture::GetRequiredMemory(context, texture_info);
+                return texture;
+            }, res::FinalizeAndDeleteResource<vk::Texture, vk::Context>, context);
+        };
+        texture0_handle = acquire_texture((is_cooked == true) ? cooked_texture0_path : texture0_path, std::addressof(texture0_info));
+        texture1_handle = acquire_texture((is_cooked == true) ? cooked_texture1_path : texture1_path, std::addressof(texture1_info));
 
-        util::ConstructAt(vk_texture1);
-        util::GetReference(vk_texture1).Initialize(context, std::addressof(texture1_info), image_pool);
+        /* Create upload context, optimal tiled textures are only reachable through copies */
+        util::ConstructAt(vk_upload_context);
+        vk::UploadContextInfo upload_context_info = {};
+        upload_context_info.SetDefaults();
+
+        vk::UploadContext *upload_context = util::GetPointer(vk_upload_context);
+        upload_context->Initialize(context, std::addressof(upload_context_info));
+
+        if (is_cooked == true) {
+
+            /* Cooked mips are already in upload layout, each is copied from the mapping into the image or the ring */
+            vk::TextureUploadRegion region_array[res::MaxCookedTextureMips] = {};
+            for (u32 i = 0; i < mip_levels0; ++i) {
+                region_array[i] = { .data = cooked_texture0.GetMipData(i), .size = cooked_texture0.GetMip(i)->size, .mip_level = i };
+            }
+            if (is_host_image_copy == true) {
+                texture0_handle.Get()->CopyFromHost(context, region_array, mip_levels0);
+            } else {
+                upload_context->UploadTexture(texture0_handle.Get(), region_array, mip_levels0);
+            }
+
+            for (u32 i = 0; i < mip_levels1; ++i) {
+                region_array[i] = { .data = cooked_texture1.GetMipData(i), .size = cooked_texture1.GetMip(i)->size, .mip_level = i };
+            }
+            if (is_host_image_copy == true) {
+                texture1_handle.Get()->CopyFromHost(context, region_array, mip_levels1);
+            } else {
+                upload_context->UploadTexture(texture1_handle.Get(), region_array, mip_levels1);
+            }
+
+            res::FreeCookedTexture(std::addressof(cooked_texture0));
+            res::FreeCookedTexture(std::addressof(cooked_texture1));
+        } else {
+
+            /* Decode textures in parallel straight into the staging ring or a host copy source, stb's jpeg decoder writes one byte past the image */
+            const s64 texture0_staging_size = util::AlignUp(width0 * height0 * 4 + 1, vk::UploadContext::MinStagingAlignment);
+            const s64 texture1_staging_size = width1 * height1 * 4 + 1;
+
+            VkDeviceSize staging_offset = 0;
+            u8 *staging = nullptr;
+            if (is_host_image_copy == true) {
+                staging = new (std::nothrow) u8[texture0_staging_size + texture1_staging_size];
+                DD_ASSERT(staging != nullptr);
+            } else {
+                staging = reinterpret_cast<u8*>(upload_context->AllocateStaging(texture0_staging_size + texture1_staging_size, std::addressof(staging_offset)));
+            }
+
+            image_load_array[0].destination      = staging;
+            image_load_array[0].destination_size = texture0_staging_size;
+            image_load_array[1].destination      = staging + texture0_staging_size;
+            image_load_array[1].destination_size = texture1_staging_size;
+
+            res::LoadStbImages(image_load_array, image_load_count, 0, nullptr);
+            DD_ASSERT(image_load_array[0].image_data == image_load_array[0].destination && image_load_array[1].image_data == image_load_array[1].destination);
+
+            if (is_host_image_copy == true) {
+                const vk::TextureUploadRegion upload_region0 = { .data = staging, .size = static_cast<size_t>(width0 * height0 * 4) };
+                const vk::TextureUploadRegion upload_region1 = { .data = staging + texture0_staging_size, .size = static_cast<size_t>(width1 * height1 * 4) };
+                texture0_handle.Get()->CopyFromHost(context, std::addressof(upload_region0), 1);
+                texture1_handle.Get()->CopyFromHost(context, std::addressof(upload_region1), 1);
+                delete[] staging;
+            } else {
+                const vk::TextureCopyRegion copy_region0 = { .staging_offset = staging_offset };
+                const vk::TextureCopyRegion copy_region1 = { .staging_offset = staging_offset + texture0_staging_size };
+                upload_context->CopyStagingToTexture(texture0_handle.Get(), std::addressof(copy_region0), 1);
+                upload_context->CopyStagingToTexture(texture1_handle.Get(), std::addressof(copy_region1), 1);
+            }
+
+            is_mipmap_generation_pending = true;
+        }
+        upload_context->Flush();
+
+        for (u32 i = 0; i < image_load_count; ++i) {
+            delete [] reinterpret_cast<char*>(archive_buffer_array[i]);
+            delete [] reinterpret_cast<char*>(texture_request_array[i].buffer);
+        }
+        if (is_archive == true) {
+            archive.Finalize();
+        }
 
         /* Create texture views */
         vk::TextureViewInfo view_info = {};
         view_info.SetDefaults();
 
-        view_info.vk_format  = VK_FORMAT_R8G8B8A8_UNORM;
-        view_info.texture = util::GetPointer(vk_texture0);
+        view_info.vk_format  = texture0_format;
+        view_info.mip_levels = mip_levels0;
+        view_info.texture = texture0_handle.Get();
 
         util::ConstructAt(vk_texture_view0);
         util::GetReference(vk_texture_view0).Initialize(context, std::addressof(view_info));
 
-        view_info.vk_format  = VK_FORMAT_R8G8B8A8_UNORM;
-        view_info.texture = util::GetPointer(vk_texture1);
+        view_info.vk_format  = texture1_format;
+        view_info.mip_levels = mip_levels1;
+        view_info.texture = texture1_handle.Get();
 
         util::ConstructAt(vk_texture_view1);
         util::GetReference(vk_texture_view1).Initialize(context, std::addressof(view_info));
@@ -330,14 +594,53 @@ namespace dd::learn {
         /* Create sampler */
         vk::SamplerInfo sampler_info = {};
         sampler_info.SetDefaults();
+        sampler_info.vk_mip_map_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        sampler_info.max_lod_clamp   = VK_LOD_CLAMP_NONE;
+
+        /* Sampler info has no padding, its floats are keyed by bit pattern so only -0.0 and NaN can miss an equal sampler */
+        static_assert(sizeof(vk::SamplerInfo) == sizeof(u32) * 8 + sizeof(u8) * 4);
+        const u64 sampler_key = res::MakeResourceKey("sampler", util::Hash64(std::addressof(sampler_info), sizeof(vk::SamplerInfo)));
+        sampler_handle = cache->Acquire<vk::Sampler>(sampler_key, [&](size_t *out_memory_size) -> vk::Sampler* {
+            vk::Sampler *sampler = new (std::nothrow) vk::Sampler();
+            DD_ASSERT(sampler != nullptr);
+            sampler->Initialize(context, std::addressof(sampler_info));
+            *out_memory_size = sizeof(vk::Sampler);
+            return sampler;
+        }, res::FinalizeAndDeleteResource<vk::Sampler, vk::Context>, context);
+
+        /* Load cooked mesh */
+        is_mesh = ::GetFileAttributes(cooked_mesh_path) != INVALID_FILE_ATTRIBUTES;
+        if (is_mesh == true) {
+            res::LoadMesh(context, cooked_mesh_path, std::addressof(mesh));
+            DD_ASSERT(mesh.HasAttribute(res::MeshAttribute_TexCoord) == true);
+
+            const res::MeshAttribute attribute_array[] = { res::MeshAttribute_Position, res::MeshAttribute_TexCoord };
+            for (u32 i = 0; i < 2; ++i) {
+                vk_mesh_input_binding_descriptions[i] = {
+                    .sType     = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT,
+                    .binding   = i,
+                    .stride    = mesh.GetStream(attribute_array[i])->stride,
+                    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+                    .divisor   = 1
+                };
+                vk_mesh_attribute_descriptions[i] = {
+                    .sType    = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT,
+                    .location = i,
+                    .binding  = i,
+                    .format   = static_cast<VkFormat>(mesh.GetStream(attribute_array[i])->vk_format),
+                    .offset   = 0
+                };
+            }
 
-        util::ConstructAt(vk_sampler);
-        util::GetReference(vk_sampler).Initialize(context, std::addressof(sampler_info));
+            const float *scale  = mesh.header.position_scale;
+            const float *offset = mesh.header.position_offset;
+            mesh_dequantize_matrix = util::math::Matrix34f(scale[0], 0.0f, 0.0f, offset[0], 0.0f, scale[1], 0.0f, offset[1], 0.0f, 0.0f, scale[2], offset[2]);
+        }
 
         /* Create pipeline */
         vk::PipelineInfo pipeline_info = {};
         pipeline_info.SetDefaults();
-        pipeline_info.shader = util::GetPointer(vk_shader);
+        pipeline_info.shader = shader_handle.Get();
 
         util::ConstructAt(vk_pipeline);
         util::GetReference(vk_pipeline).Initialize(context, std::addressof(pipeline_info));
@@ -348,6 +651,12 @@ namespace dd::learn {
         vk_pipeline_cmd_state.vertex_state.vertex_attribute_count = input_attribute_count;
         vk_pipeline_cmd_state.vertex_state.vertex_binding_array = std::addressof(vk_input_binding_description);
         vk_pipeline_cmd_state.vertex_state.vertex_attribute_array = vk_attribute_descriptions;
+        if (is_mesh == true) {
+            vk_pipeline_cmd_state.vertex_state.vertex_binding_count   = 2;
+            vk_pipeline_cmd_state.vertex_state.vertex_attribute_count = 2;
+            vk_pipeline_cmd_state.vertex_state.vertex_binding_array   = vk_mesh_input_binding_descriptions;
+            vk_pipeline_cmd_state.vertex_state.vertex_attribute_array = vk_mesh_attribute_descriptions;
+        }
 
         /* Create texture descriptor pool */
         vk::DescriptorPool *texture_descriptor_pool = util::GetPointer(vk_texture_descriptor_pool);
@@ -361,11 +670,13 @@ namespace dd::learn {
         util::ConstructAt(vk_sampler_descriptor_pool);
         sampler_descriptor_pool->Initialize(context, VK_DESCRIPTOR_TYPE_SAMPLER, 16);
 
-        /* Register our textures */
-        sampler_slot = sampler_descriptor_pool->RegisterSampler(util::GetPointer(vk_sampler));
+        /* Register our textures, uploads have already moved them to their sampled or host copy layout */
+        texture_view0_slot = texture_descriptor_pool->RegisterTexture(util::GetPointer(vk_texture_view0));
+        texture_view1_slot = texture_descriptor_pool->RegisterTexture(util::GetPointer(vk_texture_view1));
+        sampler_slot = sampler_descriptor_pool->RegisterSampler(sampler_handle.Get());
     }
 
-    void CalcTriangle() {
+    void CalcTriangle(float step_time) {
 
         /* Process input */
         u32 width = 0, height = 0;
@@ -375,31 +686,14 @@ namespace dd::learn {
         ::puts(buffer);
         perspective_projection.SetAspect(static_cast<float>(width) / static_cast<float>(height));
 
-        util::math::Vector3f new_pos = {};
+        util::math::Vector3f new_pos = current_camera_pos;
         util::math::Vector3f up = {};
 
-        camera.GetPos(std::addressof(new_pos));
+        previous_camera_pos = current_camera_pos;
         camera.GetUp(std::addressof(up));
-        float speed = 2.5f * util::GetDeltaTime();
+        float speed = 2.5f * step_time;
 
-        hid::MouseState mouse_state = hid::GetMouseState();
-
-        float sensitivity = 0.1f;
-
-        yaw   += sensitivity * mouse_state.delta_x;
-        pitch += sensitivity * mouse_state.delta_y;
-
-        const float yaw_rad   = util::math::AngleHalfRound(util::math::ToRadians(yaw));
-        const float pitch_rad = util::math::AngleHalfRound(util::math::ToRadians(pitch));
-        const float cos_pitch = util::math::SampleCos(pitch_rad);
-
-        const util::math::Vector3f dir = {
-            util::math::SampleCos(yaw_rad) * cos_pitch,
-            util::math::SampleSin(pitch_rad),
-            util::math::SampleSin(yaw_rad) * cos_pitch
-        };
-
-        const util::math::Vector3f front = dir.Normalize();
+        const util::math::Vector3f front = CalcCameraFront();
 
         hid::KeyboardState key_state = hid::GetKeyboardState();
 
@@ -416,29 +710,52 @@ namespace dd::learn {
             new_pos += front.Cross(up).Normalize() * speed;
         }
 
-        camera.SetPos(new_pos);
-        camera.SetAt(new_pos + front);
+        current_camera_pos = new_pos;
     }
     
-    void DrawTriangle(vk::CommandBuffer *command_buffer) {
+    void DrawTriangle(vk::CommandBuffer *command_buffer, float alpha) {
 
         /* Copy matrices to buffer */
         u32 width = 0, height = 0;
         vk::GetGlobalContext()->GetWindowDimensionsUnsafe(std::addressof(width), std::addressof(height));
 
+        /* Mouse look is applied once per rendered frame, so its delta isn't repeated per step */
+        hid::MouseState mouse_state = hid::GetMouseState();
+
+        float sensitivity = 0.1f;
+
+        yaw   += sensitivity * mouse_state.delta_x;
+        pitch += sensitivity * mouse_state.delta_y;
+
+        /* Blend the last two simulated positions */
+        const util::math::Vector3f front      = CalcCameraFront();
+        const util::math::Vector3f camera_pos = previous_camera_pos + (current_camera_pos - previous_camera_pos) * alpha;
+
+        camera.SetPos(camera_pos);
+        camera.SetAt(camera_pos + front);
         camera.UpdateCameraMatrixSelf();
 
+        /* Only dirty subtrees are recomputed */
+        scene_graph.Update();
+
         ViewArg view_arg[CubeCount] = {};
         for (u32 i = 0; i < CubeCount; ++i) {
-            view_arg[i].model_matrix = model_matrix;
+            const util::math::Matrix34f &world_matrix = scene_graph.GetWorldMatrix(std::addressof(cube_nodes[i]));
+            util::math::MultiplyMatrix34(std::addressof(view_arg[i].model_matrix), world_matrix, mesh_dequantize_matrix);
             view_arg[i].view_matrix = *camera.GetCameraMatrix();
             view_arg[i].projection_matrix = *perspective_projection.GetProjectionMatrix();
 
-            view_arg[i].model_matrix.SetColumn(3, CubePositions[i]);
-            float rot_angle = 20.0f * i;
-            dd::util::math::RotateLocalX(std::addressof(view_arg[i].model_matrix), rot_angle);
-            dd::util::math::RotateLocalY(std::addressof(view_arg[i].model_matrix), 0.3f * rot_angle);
-            dd::util::math::RotateLocalZ(std::addressof(view_arg[i].model_matrix), 0.5f * rot_angle);
+            /* Lod by distance from the camera to the bounding sphere */
+            if (is_mesh == false || mesh.header.lod_count == 1) { continue; }
+
+            const float *center = mesh.header.bounds.sphere_center;
+            const util::math::Vector3f world_center(
+                world_matrix.m_arr2d[0][0] * center[0] + world_matrix.m_arr2d[0][1] * center[1] + world_matrix.m_arr2d[0][2] * center[2] + world_matrix.m_arr2d[0][3],
+                world_matrix.m_arr2d[1][0] * center[0] + world_matrix.m_arr2d[1][1] * center[1] + world_matrix.m_arr2d[1][2] * center[2] + world_matrix.m_arr2d[1][3],
+                world_matrix.m_arr2d[2][0] * center[0] + world_matrix.m_arr2d[2][1] * center[1] + world_matrix.m_arr2d[2][2] * center[2] + world_matrix.m_arr2d[2][3]
+            );
+            const float distance = (world_center - camera_pos).Magnitude() - mesh.header.bounds.sphere_radius;
+            cube_lods[i] = res::SelectMeshLod(std::addressof(mesh.header), distance, std::addressof(perspective_projection), static_cast<float>(height), MeshLodPixelError);
         }
 
         void *ubo_address = util::GetReference(vk_uniform_buffer).Map();
@@ -446,34 +763,11 @@ namespace dd::learn {
         ::memcpy(ubo_address, view_arg, sizeof(view_arg));
         util::GetReference(vk_uniform_buffer).Unmap();
 
-        /* Ensure textures are transistioned */
-        if (util::GetPointer(vk_texture_view0)->GetTexture()->GetImageLayout() == VK_IMAGE_LAYOUT_PREINITIALIZED) {
-
-            util::GetReference(vk_image_memory).Relocate(command_buffer->GetCommandBuffer());
-
-            const dd::vk::TextureBarrierCmdState texture_barrier_state = {
-                .vk_dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                .vk_dst_access_mask = VK_ACCESS_SHADER_READ_BIT,
-                .vk_src_layout      = VK_IMAGE_LAYOUT_PREINITIALIZED,
-                .vk_dst_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            };
-
-            command_buffer->SetTextureStateTransition(util::GetPointer(vk_texture_view0)->GetTexture(), std::addressof(texture_barrier_state), VK_IMAGE_ASPECT_COLOR_BIT);
-
-            texture_view0_slot = util::GetPointer(vk_texture_descriptor_pool)->RegisterTexture(util::GetPointer(vk_texture_view0));
-        }
-        if (util::GetPointer(vk_texture_view1)->GetTexture()->GetImageLayout() == VK_IMAGE_LAYOUT_PREINITIALIZED) {
-
-            const dd::vk::TextureBarrierCmdState texture_barrier_state = {
-                .vk_dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                .vk_dst_access_mask = VK_ACCESS_SHADER_READ_BIT,
-                .vk_src_layout      = VK_IMAGE_LAYOUT_PREINITIALIZED,
-                .vk_dst_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            };
-
-            command_buffer->SetTextureStateTransition(util::GetPointer(vk_texture_view1)->GetTexture(), std::addressof(texture_barrier_state), VK_IMAGE_ASPECT_COLOR_BIT);
-
-            texture_view1_slot = util::GetPointer(vk_texture_descriptor_pool)->RegisterTexture(util::GetPointer(vk_texture_view1));
+        /* Blit decoded textures down their mip chain once */
+        if (is_mipmap_generation_pending == true) {
+            command_buffer->GenerateMipmaps(vk::GetGlobalContext(), texture0_handle.Get());
+            command_buffer->GenerateMipmaps(vk::GetGlobalContext(), texture1_handle.Get());
+            is_mipmap_generation_pending = false;
         }
 
         /* Bind */
@@ -482,7 +776,12 @@ namespace dd::learn {
         command_buffer->SetPipeline(util::GetPointer(vk_pipeline));
         command_buffer->SetPipelineState(std::addressof(vk_pipeline_cmd_state));
 
-        command_buffer->SetVertexBuffer(0, util::GetPointer(vk_vertex_buffer), VerticeStride, sizeof(vertices));
+        if (is_mesh == true) {
+            command_buffer->SetVertexBuffer(0, mesh.stream_buffer_array[res::MeshAttribute_Position], mesh.GetStream(res::MeshAttribute_Position)->stride, mesh.GetStream(res::MeshAttribute_Position)->size);
+            command_buffer->SetVertexBuffer(1, mesh.stream_buffer_array[res::MeshAttribute_TexCoord], mesh.GetStream(res::MeshAttribute_TexCoord)->stride, mesh.GetStream(res::MeshAttribute_TexCoord)->size);
+        } else {
+            command_buffer->SetVertexBuffer(0, util::GetPointer(vk_vertex_buffer), VerticeStride, sizeof(vertices));
+        }
 
         command_buffer->SetUniformBuffer(0, vk::ShaderStage_Vertex, util::GetReference(vk_uniform_buffer).GetGpuAddress());
 
@@ -506,14 +805,29 @@ namespace dd::learn {
         command_buffer->SetScissors(1, std::addressof(scissor));
 
         /* Draw */
-        command_buffer->DrawInstanced(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VerticeCount, 0, CubeCount, 0);
+        if (is_mesh == true && mesh.header.lod_count == 1) {
+            command_buffer->DrawInstancedIndexed(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, static_cast<VkIndexType>(mesh.header.vk_index_type), mesh.index_buffer, mesh.GetLod(0)->index_count, 0, CubeCount, 0);
+        } else if (is_mesh == true) {
+            /* One draw per cube, the base instance still selects its matrices */
+            for (u32 i = 0; i < CubeCount; ++i) {
+                const res::MeshLod *lod = mesh.GetLod(cube_lods[i]);
+                command_buffer->DrawInstancedIndexed(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, static_cast<VkIndexType>(mesh.header.vk_index_type), mesh.index_buffer, lod->index_count, lod->index_offset, 1, i);
+            }
+        } else {
+            command_buffer->DrawInstanced(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VerticeCount, 0, CubeCount, 0);
+        }
     }
 
     void CleanTriangle() {
         vk::Context *context = vk::GetGlobalContext();
 
-        util::GetReference(vk_shader).Finalize(context);
-        dd::util::DestructAt(vk_shader);
+        shader_handle.Release();
+
+        util::GetReference(io_queue).Finalize();
+        dd::util::DestructAt(io_queue);
+
+        util::GetReference(vk_upload_context).Finalize(context);
+        dd::util::DestructAt(vk_upload_context);
 
         util::GetReference(vk_pipeline).Finalize(context);
         dd::util::DestructAt(vk_pipeline);
@@ -533,14 +847,13 @@ namespace dd::learn {
         util::GetReference(vk_texture_view1).Finalize(context);
         dd::util::DestructAt(vk_texture_view1);
 
-        util::GetReference(vk_texture0).Finalize(context);
-        dd::util::DestructAt(vk_texture0);
-
-        util::GetReference(vk_texture1).Finalize(context);
-        dd::util::DestructAt(vk_texture1);
+        texture0_handle.Release();
+        texture1_handle.Release();
+        sampler_handle.Release();
 
-        util::GetReference(vk_sampler).Finalize(context);
-        dd::util::DestructAt(vk_sampler);
+        if (is_mesh == true) {
+            res::FreeMesh(context, std::addressof(mesh));
+        }
 
         util::GetReference(vk_uniform_buffer).Finalize(context);
         dd::util::DestructAt(vk_uniform_buffer);
@@ -551,10 +864,19 @@ namespace dd::learn {
         util::GetReference(vk_vertex_buffer).Finalize(context);
         dd::util::DestructAt(vk_vertex_buffer);
 
+        /* Textures are bound to the image pool, destroy them while it is alive */
+        util::GetReference(resource_cache).Trim();
+
         util::GetReference(vk_image_memory).Finalize(context);
         dd::util::DestructAt(vk_image_memory);
 
         util::GetReference(vk_buffer_memory).Finalize(context);
         dd::util::DestructAt(vk_buffer_memory);
+
+        /* Destroys anything left in the cache */
+        util::GetReference(resource_cache).Finalize();
+        dd::util::DestructAt(resource_cache);
+
+        scene_graph.Finalize();
     }
 }
@@ -22,20 +22,22 @@ namespace {
     dd::util::TypeStorage<dd::vk::CommandBuffer> command_buffers[dd::vk::DisplayBuffer::FramesInFlight];
 
     struct ContextInitState {
-        bool    is_ready_for_exit;
-        HANDLE  context_event;
-        SRWLOCK context_lock;
+        bool                is_ready_for_exit;
+        HANDLE              context_event;
+        SRWLOCK             context_lock;
+        dd::vk::ContextInfo context_info;
     };
 }
 
 long unsigned int ContextMain(void *arg) {
+    dd::util::SetProfilerThreadName("Window");
     
     /* Create Vulkan Context */
     dd::hid::InitializeRawInputThread();
 
     ContextInitState *context_state = reinterpret_cast<ContextInitState*>(arg);
 
-    dd::util::ConstructAt(context);
+    dd::util::ConstructAt(context, std::addressof(context_state->context_info));
     dd::util::GetReference(context).EndResizeManuel();
 
     dd::util::ConstructAt(framebuffer);
@@ -53,6 +55,7 @@ long unsigned int ContextMain(void *arg) {
     /* Process Vulkan Window */
     MSG msg = {};
     while (::GetMessage(std::addressof(msg), nullptr, 0, 0) != 0) {
+        DD_PROFILE_SCOPE("WindowMessage");
         ::DispatchMessage(std::addressof(msg));
         dd::vk::GetGlobalContext()->EndResizeIfNecessary();
     }
@@ -62,6 +65,9 @@ long unsigned int ContextMain(void *arg) {
     context_state->is_ready_for_exit = true;
     ::ReleaseSRWLockExclusive(std::addressof(context_state->context_lock));
 
+    /* Wake the main thread if it is parked on a minimized window */
+    dd::util::GetPointer(context)->SignalDrawable();
+
     /* Wait for main thread to finish */
     ::WaitForSingleObject(context_state->context_event, INFINITE);
     ::ResetEvent(context_state->context_event);
@@ -85,7 +91,8 @@ long unsigned int ContextMain(void *arg) {
     return 0;
 }
 
-void Draw(dd::vk::Context *global_context, dd::vk::CommandBuffer *global_command_buffer, dd::util::DelegateThread *present_thread) {
+void Draw(dd::vk::Context *global_context, dd::vk::CommandBuffer *global_command_buffer, dd::util::DelegateThread *present_thread, float alpha) {
+    DD_PROFILE_SCOPE("Draw");
 
     global_context->LockWindowResize();
 
@@ -124,7 +131,7 @@ void Draw(dd::vk::Context *global_context, dd::vk::CommandBuffer *global_command
     global_command_buffer->SetRenderTargets(1 , std::addressof(current_color_target), depth_stencil_target);
 
     /* Draw Frame */
-    dd::learn::DrawTriangle(global_command_buffer);
+    dd::learn::DrawTriangle(global_command_buffer, alpha);
 
     /* Transition render target to present */
     const dd::vk::TextureBarrierCmdState present_barrier_state = {
@@ -145,15 +152,162 @@ void Draw(dd::vk::Context *global_context, dd::vk::CommandBuffer *global_command
     global_context->UnlockWindowResize();
 }
 
-int main() {
+/* "learn.exe --pack <archive> [-z] <file>...", files are stored under their paths and -z enables compression for the files after it */
+int PackMain(s32 argc, char **argv) {
+    const char *archive_path = argv[0];
+
+    dd::res::ArchivePackEntry *pack_entry_array = new (std::nothrow) dd::res::ArchivePackEntry[argc];
+    DD_ASSERT(pack_entry_array != nullptr);
+
+    u32  pack_entry_count = 0;
+    bool is_compressible  = false;
+    for (s32 i = 1; i < argc; ++i) {
+        if (::strcmp(argv[i], "-z") == 0) {
+            is_compressible = true;
+            continue;
+        }
+        pack_entry_array[pack_entry_count] = { argv[i], argv[i], is_compressible };
+        ++pack_entry_count;
+    }
+
+    dd::res::PackArchive(archive_path, pack_entry_array, pack_entry_count);
+    ::printf("packed %u files into %s\n", pack_entry_count, archive_path);
+
+    delete[] pack_entry_array;
+    return 0;
+}
+
+/* "learn.exe --cook <cooked> <image> [-linear] [-nomips] [-kaiser] [-bc1|-bc3|-bc7] [-fast|-slow]", images are cooked as uncompressed sRGB with a full mip chain by default */
+int CookMain(s32 argc, char **argv) {
+    const char *cooked_path = argv[0];
+    const char *source_path = argv[1];
+
+    dd::res::CookTextureInfo cook_texture_info = {};
+    cook_texture_info.SetDefaults();
+    for (s32 i = 2; i < argc; ++i) {
+        if (::strcmp(argv[i], "-linear") == 0) { cook_texture_info.is_srgb      = false; }
+        if (::strcmp(argv[i], "-nomips") == 0) { cook_texture_info.is_mipmapped = false; }
+        if (::strcmp(argv[i], "-kaiser") == 0) { cook_texture_info.mip_filter   = dd::res::MipFilter_Kaiser; }
+        if (::strcmp(argv[i], "-bc1") == 0)    { cook_texture_info.is_block_compressed = true; cook_texture_info.bc_format = dd::res::BcFormat_Bc1; }
+        if (::strcmp(argv[i], "-bc3") == 0)    { cook_texture_info.is_block_compressed = true; cook_texture_info.bc_format = dd::res::BcFormat_Bc3; }
+        if (::strcmp(argv[i], "-bc7") == 0)    { cook_texture_info.is_block_compressed = true; cook_texture_info.bc_format = dd::res::BcFormat_Bc7; }
+        if (::strcmp(argv[i], "-fast") == 0)   { cook_texture_info.bc_quality = dd::res::BcQuality_Fast; }
+        if (::strcmp(argv[i], "-slow") == 0)   { cook_texture_info.bc_quality = dd::res::BcQuality_Slow; }
+    }
+
+    dd::res::CookTexture(cooked_path, source_path, std::addressof(cook_texture_info));
+    ::printf("cooked %s into %s\n", source_path, cooked_path);
+
+    return 0;
+}
+
+/* "learn.exe --cookmesh <mesh> <obj> [-quantize] [-quantizenormals] [-halfuv] [-noopt] [-nooverdraw] [-lods <count>]", attributes are stored as float and triangles are reordered by default */
+int CookMeshMain(s32 argc, char **argv) {
+    const char *mesh_path   = argv[0];
+    const char *source_path = argv[1];
+
+    dd::res::CookMeshInfo cook_mesh_info = {};
+    cook_mesh_info.SetDefaults();
+    for (s32 i = 2; i < argc; ++i) {
+        if (::strcmp(argv[i], "-quantize") == 0)        { cook_mesh_info.is_position_quantized = true; }
+        if (::strcmp(argv[i], "-quantizenormals") == 0) { cook_mesh_info.is_normal_quantized   = true; }
+        if (::strcmp(argv[i], "-halfuv") == 0)          { cook_mesh_info.is_texcoord_half      = true; }
+        if (::strcmp(argv[i], "-noopt") == 0)           { cook_mesh_info.is_optimized          = false; }
+        if (::strcmp(argv[i], "-nooverdraw") == 0)      { cook_mesh_info.optimize_mesh_info.is_overdraw_optimized = false; }
+        if (::strcmp(argv[i], "-lods") == 0 && i + 1 < argc) {
+            cook_mesh_info.mesh_lod_info.lod_count = static_cast<u32>(std::clamp(::atoi(argv[i + 1]), 1, static_cast<s32>(dd::res::MaxMeshLods)));
+            ++i;
+        }
+    }
+
+    dd::res::MeshOptimizeStats optimize_stats = {};
+    dd::res::CookMesh(mesh_path, source_path, std::addressof(cook_mesh_info), std::addressof(optimize_stats));
+    ::printf("cooked %s into %s\n", source_path, mesh_path);
+    if (cook_mesh_info.is_optimized == true) {
+        ::printf("acmr %.3f -> %.3f, atvr %.3f -> %.3f, vertices %u -> %u\n", optimize_stats.before.acmr, optimize_stats.after.acmr, optimize_stats.before.atvr, optimize_stats.after.atvr, optimize_stats.source_vertex_count, optimize_stats.vertex_count);
+    }
+
+    return 0;
+}
+
+/* "learn.exe --bench [hash] [mip] [file] [decode]", every benchmark runs when none is named */
+int BenchMain(s32 argc, char **argv) {
+    dd::util::InitializeTime();
+
+    bool is_hash_bench   = (argc == 0);
+    bool is_mip_bench    = (argc == 0);
+    bool is_file_bench   = (argc == 0);
+    bool is_decode_bench = (argc == 0);
+    for (s32 i = 0; i < argc; ++i) {
+        if (::strcmp(argv[i], "hash") == 0)   { is_hash_bench   = true; }
+        if (::strcmp(argv[i], "mip") == 0)    { is_mip_bench    = true; }
+        if (::strcmp(argv[i], "file") == 0)   { is_file_bench   = true; }
+        if (::strcmp(argv[i], "decode") == 0) { is_decode_bench = true; }
+    }
+
+    if (is_hash_bench == true) {
+        dd::learn::BenchmarkFlatHashMap();
+    }
+    if (is_mip_bench == true) {
+        dd::learn::BenchmarkMipSampling();
+    }
+    if (is_file_bench == true) {
+        dd::learn::BenchmarkFileAccess();
+    }
+    if (is_decode_bench == true) {
+        dd::learn::BenchmarkImageDecode();
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+
+    /* Pack archive and exit */
+    if (3 <= argc && ::strcmp(argv[1], "--pack") == 0) {
+        return PackMain(argc - 2, argv + 2);
+    }
+
+    /* Cook texture and exit */
+    if (4 <= argc && ::strcmp(argv[1], "--cook") == 0) {
+        return CookMain(argc - 2, argv + 2);
+    }
+
+    /* Cook mesh and exit */
+    if (4 <= argc && ::strcmp(argv[1], "--cookmesh") == 0) {
+        return CookMeshMain(argc - 2, argv + 2);
+    }
+
+    /* Run benchmarks and exit */
+    if (2 <= argc && ::strcmp(argv[1], "--bench") == 0) {
+        return BenchMain(argc - 2, argv + 2);
+    }
+
     /* Initialize System Time */
     dd::util::InitializeTime();
 
+    /* Start profiler */
+    dd::util::ProfilerInfo profiler_info = {};
+    profiler_info.SetDefaults();
+    dd::util::InitializeProfiler(std::addressof(profiler_info));
+    dd::util::SetProfilerThreadName("Main");
+
+    /* Start frame statistics */
+    dd::util::FrameStatsInfo frame_stats_info = {};
+    frame_stats_info.SetDefaults();
+    dd::util::InitializeFrameStats(std::addressof(frame_stats_info));
+
     /* Set flush denormals to 0 */
     _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
 
-    /* Create Vulkan Context Thread and wait for initialization */
+    /* "learn.exe --nohostcopy" forces textures through the staging upload path */
     ContextInitState context_init_state = {};
+    context_init_state.context_info.SetDefaults();
+    for (s32 i = 1; i < argc; ++i) {
+        if (::strcmp(argv[i], "--nohostcopy") == 0) { context_init_state.context_info.is_host_image_copy_allowed = false; }
+    }
+
+    /* Create Vulkan Context Thread and wait for initialization */
     context_init_state.context_event = ::CreateEvent(nullptr, true, false, nullptr);
     DD_ASSERT(context_init_state.context_event != nullptr);
 
@@ -169,6 +323,22 @@ int main() {
     dd::vk::CommandBuffer   *global_command_buffer = dd::util::GetPointer(command_buffers[dd::util::GetPointer(framebuffer)->GetCurrentFrame()]);
     dd::util::DelegateThread *present_thread = global_context->InitializePresentationThread(dd::util::GetPointer(framebuffer));
 
+    dd::util::FixedTimestepInfo fixed_timestep_info = {};
+    fixed_timestep_info.SetDefaults();
+    dd::util::FixedTimestep fixed_timestep;
+    fixed_timestep.Initialize(std::addressof(fixed_timestep_info));
+
+    /* Uncapped unless a target rate is set with "learn.exe --fps <rate>" */
+    dd::util::FrameLimiterInfo frame_limiter_info = {};
+    frame_limiter_info.SetDefaults();
+    for (s32 i = 1; i + 1 < argc; ++i) {
+        if (::strcmp(argv[i], "--fps") == 0) {
+            frame_limiter_info.target_rate = static_cast<u32>(std::max(::atoi(argv[i + 1]), 0));
+        }
+    }
+    dd::util::FrameLimiter frame_limiter;
+    frame_limiter.Initialize(std::addressof(frame_limiter_info));
+
     /* Calc And Draw */
     while (true) {
 
@@ -179,23 +349,53 @@ int main() {
         }
         ::ReleaseSRWLockExclusive(std::addressof(context_init_state.context_lock));
 
+        /* Park while minimized, the present thread and workers block on their queues meanwhile */
+        if (global_context->WaitForDrawable() == true) {
+            dd::util::ResetFrameTime();
+            continue;
+        }
+
+        DD_PROFILE_SCOPE("Frame");
+
         /* Begin frame */
         dd::util::BeginFrame();
         dd::hid::BeginFrame();
 
-        Draw(global_context, global_command_buffer, present_thread);
+        /* Calc Frame in fixed steps */
+        {
+            DD_PROFILE_SCOPE("CalcTriangle");
+            fixed_timestep.Accumulate(dd::util::GetDeltaTick());
+            while (fixed_timestep.ConsumeStep() == true) {
+                dd::learn::CalcTriangle(static_cast<float>(fixed_timestep.GetStepTime()));
+            }
+        }
 
-        /* Calc Frame */
-        dd::learn::CalcTriangle();
+        Draw(global_context, global_command_buffer, present_thread, fixed_timestep.GetAlpha());
 
         /* Wait for presentation */
-        global_context->WaitForGpu();
+        {
+            DD_PROFILE_SCOPE("WaitForGpu");
+            global_context->WaitForGpu();
+        }
+
+        /* Cap frame rate */
+        {
+            DD_PROFILE_SCOPE("FrameLimiter");
+            frame_limiter.Wait();
+        }
 
         global_command_buffer = dd::util::GetPointer(command_buffers[dd::util::GetPointer(framebuffer)->GetCurrentFrame()]);
     }
 
     present_thread->FinalizeThread();
 
+    if (frame_limiter.IsEnabled() == true) {
+        dd::util::FramePacingStats pacing_stats = {};
+        frame_limiter.GetPacingStats(std::addressof(pacing_stats));
+        ::printf("frame pacing at %u fps over %llu frames: avg error %lld us, max error %lld us, spin margin %lld us\n", frame_limiter_info.target_rate, static_cast<unsigned long long>(pacing_stats.frame_count), static_cast<long long>(pacing_stats.avg_error_ns / 1000), static_cast<long long>(pacing_stats.max_error_ns / 1000), static_cast<long long>(pacing_stats.spin_margin_ns / 1000));
+    }
+    frame_limiter.Finalize();
+
     ::pfn_vkQueueWaitIdle(dd::util::GetPointer(context)->GetGraphicsQueue());
     ::pfn_vkDeviceWaitIdle(dd::util::GetPointer(context)->GetDevice());
 
@@ -211,5 +411,8 @@ int main() {
 
     /* Cleanup*/
     ::CloseHandle(context_init_state.context_event);
+
+    dd::util::FinalizeFrameStats();
+    dd::util::FinalizeProfiler();
     return 0;
 }
@@ -0,0 +1,70 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    void Archive::Initialize(const char *path) {
+
+        /* Map archive, the table of contents is read in place */
+        m_file.Initialize(path, MappedFileAccess_Random);
+        DD_ASSERT(sizeof(ArchiveHeader) <= m_file.GetSize());
+
+        m_header = m_file.GetViewAs<ArchiveHeader>(0);
+        DD_ASSERT(m_header->magic == ArchiveMagic && m_header->version == ArchiveVersion);
+        DD_ASSERT(m_header->file_size == m_file.GetSize());
+        DD_ASSERT(m_header->slot_count != 0 && (m_header->slot_count & (m_header->slot_count - 1)) == 0);
+
+        m_entry_array = m_file.GetViewAs<ArchiveEntry>(m_header->entry_offset);
+        m_slot_array  = m_file.GetViewAs<u32>(m_header->slot_offset);
+        m_name_data   = m_file.GetViewAs<char>(m_header->name_offset);
+
+        /* Bring the table of contents in with one request */
+        m_file.Prefetch(0, m_header->name_offset + m_header->name_size);
+    }
+
+    void Archive::Finalize() {
+        m_file.Finalize();
+        m_header      = nullptr;
+        m_entry_array = nullptr;
+        m_slot_array  = nullptr;
+        m_name_data   = nullptr;
+    }
+
+    const ArchiveEntry *Archive::FindEntry(u64 name_hash) const {
+
+        /* Linear probe, the packer guarantees hashes are unique */
+        const u32 slot_mask = m_header->slot_count - 1;
+        for (u32 slot = static_cast<u32>(name_hash) & slot_mask;; slot = (slot + 1) & slot_mask) {
+            const u32 entry_index = m_slot_array[slot];
+            if (entry_index == ArchiveEmptySlot) { return nullptr; }
+
+            if (m_entry_array[entry_index].name_hash == name_hash) { return std::addressof(m_entry_array[entry_index]); }
+        }
+    }
+
+    void Archive::ReadEntry(const ArchiveEntry *entry, void *out_buffer) const {
+        if (entry->size == 0) { return; }
+
+        const void *stored = m_file.GetViewAs<u8>(entry->offset);
+        if (entry->compression == ArchiveCompression_None) {
+            ::memcpy(out_buffer, stored, entry->size);
+        } else {
+            const bool result = DecompressLz(stored, entry->stored_size, out_buffer, entry->size);
+            DD_ASSERT(result == true);
+        }
+    }
+}
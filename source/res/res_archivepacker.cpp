@@ -0,0 +1,161 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        constexpr ALWAYS_INLINE u64 AlignArchiveOffset(u64 offset) {
+            return (offset + ArchiveAlignment - 1) & ~static_cast<u64>(ArchiveAlignment - 1);
+        }
+
+        void WriteArchive(Handle file, const void *data, u64 size) {
+            DD_ASSERT(size <= 0xffff'ffff);
+
+            long unsigned int size_written = 0;
+            const bool result = ::WriteFile(file, data, static_cast<u32>(size), std::addressof(size_written), nullptr);
+            DD_ASSERT(result == true && size_written == size);
+        }
+
+        void WriteArchivePadding(Handle file, u64 offset) {
+            constexpr u8 zero_array[ArchiveAlignment] = {};
+            const u64 padding = AlignArchiveOffset(offset) - offset;
+            if (padding != 0) {
+                WriteArchive(file, zero_array, padding);
+            }
+        }
+    }
+
+    void PackArchive(const char *archive_path, const ArchivePackEntry *pack_entry_array, u32 pack_entry_count) {
+
+        /* Slots are kept at most half full */
+        u32 slot_count = 16;
+        while (slot_count < pack_entry_count * 2) {
+            slot_count = slot_count * 2;
+        }
+
+        u64 name_size = 0;
+        for (u32 i = 0; i < pack_entry_count; ++i) {
+            name_size += ::strlen(pack_entry_array[i].name) + 1;
+        }
+
+        /* Allocate table of contents */
+        ArchiveEntry *entry_array = new (std::nothrow) ArchiveEntry[pack_entry_count]{};
+        DD_ASSERT(entry_array != nullptr);
+        u32 *slot_array = new (std::nothrow) u32[slot_count];
+        DD_ASSERT(slot_array != nullptr);
+        char *name_data = new (std::nothrow) char[name_size + 1];
+        DD_ASSERT(name_data != nullptr);
+        void **blob_array = new (std::nothrow) void*[pack_entry_count]{};
+        DD_ASSERT(blob_array != nullptr);
+
+        ::memset(slot_array, 0xff, slot_count * sizeof(u32));
+
+        ArchiveHeader header = {
+            .magic        = ArchiveMagic,
+            .version      = ArchiveVersion,
+            .entry_count  = pack_entry_count,
+            .slot_count   = slot_count,
+            .entry_offset = sizeof(ArchiveHeader),
+            .slot_offset  = sizeof(ArchiveHeader) + pack_entry_count * sizeof(ArchiveEntry),
+        };
+        header.name_offset = header.slot_offset + slot_count * sizeof(u32);
+        header.name_size   = name_size;
+
+        /* Load, compress and place blobs */
+        u64 offset      = AlignArchiveOffset(header.name_offset + name_size);
+        u64 name_offset = 0;
+        for (u32 i = 0; i < pack_entry_count; ++i) {
+            const ArchivePackEntry *pack_entry = std::addressof(pack_entry_array[i]);
+            ArchiveEntry           *entry      = std::addressof(entry_array[i]);
+
+            void *file = nullptr;
+            u32 file_size = 0;
+            LoadFile(pack_entry->path, std::addressof(file), std::addressof(file_size));
+
+            entry->name_hash   = util::HashString(pack_entry->name);
+            entry->size        = file_size;
+            entry->stored_size = file_size;
+            entry->name_offset = static_cast<u32>(name_offset);
+            entry->compression = ArchiveCompression_None;
+            blob_array[i]      = file;
+
+            ::strcpy(name_data + name_offset, pack_entry->name);
+            name_offset += ::strlen(pack_entry->name) + 1;
+
+            if (pack_entry->is_compressible == true && file_size != 0) {
+                const size_t capacity   = file_size - (file_size / 8);
+                void        *compressed = new (std::nothrow) char[capacity];
+                DD_ASSERT(compressed != nullptr);
+
+                const size_t compressed_size = CompressLz(file, file_size, compressed, capacity);
+                if (compressed_size != 0) {
+                    delete[] reinterpret_cast<char*>(file);
+                    entry->stored_size = compressed_size;
+                    entry->compression = ArchiveCompression_Lz;
+                    blob_array[i]      = compressed;
+                } else {
+                    delete[] reinterpret_cast<char*>(compressed);
+                }
+            }
+
+            /* Insert into slots */
+            const u32 slot_mask = slot_count - 1;
+            u32 slot = static_cast<u32>(entry->name_hash) & slot_mask;
+            while (slot_array[slot] != ArchiveEmptySlot) {
+                DD_ASSERT(entry_array[slot_array[slot]].name_hash != entry->name_hash);
+                slot = (slot + 1) & slot_mask;
+            }
+            slot_array[slot] = i;
+
+            /* Empty entries point at the header so they never reference past the end of the file */
+            if (entry->stored_size == 0) { continue; }
+
+            entry->offset = offset;
+            offset        = AlignArchiveOffset(offset + entry->stored_size);
+        }
+        header.file_size = offset;
+
+        /* Write archive */
+        Handle archive_file = ::CreateFile(archive_path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        DD_ASSERT(archive_file != INVALID_HANDLE_VALUE);
+
+        WriteArchive(archive_file, std::addressof(header), sizeof(ArchiveHeader));
+        WriteArchive(archive_file, entry_array, pack_entry_count * sizeof(ArchiveEntry));
+        WriteArchive(archive_file, slot_array, slot_count * sizeof(u32));
+        WriteArchive(archive_file, name_data, name_size);
+        WriteArchivePadding(archive_file, header.name_offset + name_size);
+
+        for (u32 i = 0; i < pack_entry_count; ++i) {
+            if (entry_array[i].stored_size == 0) { continue; }
+
+            WriteArchive(archive_file, blob_array[i], entry_array[i].stored_size);
+            WriteArchivePadding(archive_file, entry_array[i].offset + entry_array[i].stored_size);
+        }
+
+        ::CloseHandle(archive_file);
+
+        /* Cleanup */
+        for (u32 i = 0; i < pack_entry_count; ++i) {
+            delete[] reinterpret_cast<char*>(blob_array[i]);
+        }
+        delete[] blob_array;
+        delete[] name_data;
+        delete[] slot_array;
+        delete[] entry_array;
+    }
+}
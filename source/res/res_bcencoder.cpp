@@ -0,0 +1,643 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        using v4s  = util::sse4::v4s;
+        using v4si = util::sse4::v4si;
+
+        constexpr v4s MaskRgb   = { 1.0f, 1.0f, 1.0f, 0.0f };
+        constexpr v4s MaskRgba  = { 1.0f, 1.0f, 1.0f, 1.0f };
+        constexpr v4s MaskAlpha = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        constexpr float Bc1WeightArray[4]  = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        constexpr float Bc3AlphaWeightArray[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+        constexpr u32   Bc7Weight2Array[4]  = { 0, 21, 43, 64 };
+        constexpr u32   Bc7Weight4Array[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        /* Texels as vectors for fitting and as channel planes for index selection, four texels per lane group */
+        struct BcBlock {
+            v4s texel_array[16];
+            v4s plane_array[4][4];
+        };
+
+        struct BcBitWriter {
+            u64 bits[2];
+            u32 position;
+
+            constexpr void Write(u64 value, u32 bit_count) {
+                for (u32 i = 0; i < bit_count; ++i) {
+                    bits[position >> 6] |= ((value >> i) & 1) << (position & 63);
+                    ++position;
+                }
+            }
+        };
+
+        constexpr ALWAYS_INLINE float ClampUnorm8(float value) {
+            return (value < 0.0f) ? 0.0f : (255.0f < value) ? 255.0f : value;
+        }
+
+        constexpr ALWAYS_INLINE s32 QuantizeUnorm(float value, s32 max) {
+            const s32 quantized = static_cast<s32>(ClampUnorm8(value) * max / 255.0f + 0.5f);
+            return (max < quantized) ? max : quantized;
+        }
+
+        inline float SumLanes(v4s value) {
+            return value[0] + value[1] + value[2] + value[3];
+        }
+
+        inline v4s ClampEndpoint(v4s value) {
+            const v4s zero = {};
+            const v4s full = zero + 255.0f;
+            value = (value < zero) ? zero : value;
+            return (full < value) ? full : value;
+        }
+
+        void LoadBcBlock(BcBlock *out_block, const u8 *block_rgba, u32 rotation) {
+            for (u32 i = 0; i < 16; ++i) {
+                v4s texel = { static_cast<float>(block_rgba[i * 4 + 0]), static_cast<float>(block_rgba[i * 4 + 1]), static_cast<float>(block_rgba[i * 4 + 2]), static_cast<float>(block_rgba[i * 4 + 3]) };
+
+                /* BC7 rotation swaps alpha with one color channel */
+                if (rotation != 0) {
+                    const float swap = texel[rotation - 1];
+                    texel[rotation - 1] = texel[3];
+                    texel[3]            = swap;
+                }
+                out_block->texel_array[i] = texel;
+            }
+
+            for (u32 c = 0; c < 4; ++c) {
+                for (u32 g = 0; g < 4; ++g) {
+                    out_block->plane_array[c][g] = v4s{ out_block->texel_array[g * 4 + 0][c], out_block->texel_array[g * 4 + 1][c], out_block->texel_array[g * 4 + 2][c], out_block->texel_array[g * 4 + 3][c] };
+                }
+            }
+        }
+
+        /* Nearest palette entry for every texel, four texels per compare. Returns the masked squared error */
+        float SelectBcIndices(u8 *out_index_array, const BcBlock *block, const v4s *palette_array, u32 palette_count, v4s mask) {
+            float error = 0.0f;
+            for (u32 g = 0; g < 4; ++g) {
+                v4s  best_distance = v4s{} + __builtin_huge_valf();
+                v4si best_index    = {};
+                for (u32 p = 0; p < palette_count; ++p) {
+                    v4s distance = {};
+                    for (u32 c = 0; c < 4; ++c) {
+                        const v4s delta = block->plane_array[c][g] - palette_array[p][c];
+                        distance += delta * delta * mask[c];
+                    }
+                    const v4si is_closer = distance < best_distance;
+                    best_distance = is_closer ? distance : best_distance;
+                    best_index    = is_closer ? (v4si{} + static_cast<s32>(p)) : best_index;
+                }
+                for (u32 i = 0; i < 4; ++i) {
+                    out_index_array[g * 4 + i] = static_cast<u8>(best_index[i]);
+                }
+                error += SumLanes(best_distance);
+            }
+            return error;
+        }
+
+        /* Endpoints at the extent of the block along its principal axis */
+        void FitBcEndpoints(v4s *out_endpoint0, v4s *out_endpoint1, const BcBlock *block, v4s mask) {
+            v4s mean = {};
+            for (u32 i = 0; i < 16; ++i) {
+                mean += block->texel_array[i];
+            }
+            mean = mean * (1.0f / 16.0f) * mask;
+
+            v4s covariance_array[4] = {};
+            for (u32 i = 0; i < 16; ++i) {
+                const v4s delta = (block->texel_array[i] - mean) * mask;
+                for (u32 c = 0; c < 4; ++c) {
+                    covariance_array[c] += delta * delta[c];
+                }
+            }
+
+            /* Power iteration from the widest channel */
+            v4s axis = { covariance_array[0][0], covariance_array[1][1], covariance_array[2][2], covariance_array[3][3] };
+            for (u32 i = 0; i < 6; ++i) {
+                const v4s next = covariance_array[0] * axis[0] + covariance_array[1] * axis[1] + covariance_array[2] * axis[2] + covariance_array[3] * axis[3];
+                const float length_sq = SumLanes(next * next);
+                if (length_sq < 1e-12f) { break; }
+                axis = next * (1.0f / __builtin_sqrtf(length_sq));
+            }
+
+            const float axis_length_sq = SumLanes(axis * axis);
+            if (axis_length_sq < 1e-12f) {
+                *out_endpoint0 = mean;
+                *out_endpoint1 = mean;
+                return;
+            }
+            axis = axis * (1.0f / __builtin_sqrtf(axis_length_sq));
+
+            float min_projection = __builtin_huge_valf();
+            float max_projection = -__builtin_huge_valf();
+            for (u32 i = 0; i < 16; ++i) {
+                const float projection = SumLanes((block->texel_array[i] - mean) * mask * axis);
+                min_projection = (projection < min_projection) ? projection : min_projection;
+                max_projection = (max_projection < projection) ? projection : max_projection;
+            }
+
+            *out_endpoint0 = ClampEndpoint(mean + axis * min_projection);
+            *out_endpoint1 = ClampEndpoint(mean + axis * max_projection);
+        }
+
+        /* Least squares endpoints for fixed indices, weight_array maps an index to its position between the endpoints */
+        void RefineBcEndpoints(v4s *endpoint0, v4s *endpoint1, const BcBlock *block, const u8 *index_array, const float *weight_array) {
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            v4s sum0 = {}, sum1 = {};
+            for (u32 i = 0; i < 16; ++i) {
+                const float t = weight_array[index_array[i]];
+                const float s = 1.0f - t;
+                a    += s * s;
+                b    += s * t;
+                c    += t * t;
+                sum0 += block->texel_array[i] * s;
+                sum1 += block->texel_array[i] * t;
+            }
+
+            const float determinant = a * c - b * b;
+            if (determinant < 1e-6f) { return; }
+
+            const float inverse = 1.0f / determinant;
+            *endpoint0 = ClampEndpoint((sum0 * c - sum1 * b) * inverse);
+            *endpoint1 = ClampEndpoint((sum1 * a - sum0 * b) * inverse);
+        }
+
+        /* BC1 color */
+
+        constexpr ALWAYS_INLINE u16 PackRgb565(v4s endpoint) {
+            return static_cast<u16>((QuantizeUnorm(endpoint[0], 31) << 11) | (QuantizeUnorm(endpoint[1], 63) << 5) | QuantizeUnorm(endpoint[2], 31));
+        }
+
+        constexpr ALWAYS_INLINE v4s UnpackRgb565(u16 color) {
+            const u32 r = (color >> 11) & 0x1f;
+            const u32 g = (color >> 5) & 0x3f;
+            const u32 b = color & 0x1f;
+            return v4s{ static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)), 0.0f };
+        }
+
+        float EncodeBc1Color(u8 *out_block, const BcBlock *block, v4s endpoint0, v4s endpoint1) {
+            u16 color0 = PackRgb565(endpoint1);
+            u16 color1 = PackRgb565(endpoint0);
+
+            /* Four color mode needs color0 > color1, equal endpoints use index 0 throughout */
+            u8 index_array[16] = {};
+            float error = 0.0f;
+            if (color0 != color1) {
+                if (color0 < color1) {
+                    const u16 swap = color0;
+                    color0 = color1;
+                    color1 = swap;
+                }
+                const v4s c0 = UnpackRgb565(color0);
+                const v4s c1 = UnpackRgb565(color1);
+                const v4s palette_array[4] = { c0, c1, (c0 * 2.0f + c1) * (1.0f / 3.0f), (c0 + c1 * 2.0f) * (1.0f / 3.0f) };
+                error = SelectBcIndices(index_array, block, palette_array, 4, MaskRgb);
+            } else {
+                const v4s palette = UnpackRgb565(color0);
+                error = SelectBcIndices(index_array, block, std::addressof(palette), 1, MaskRgb);
+            }
+
+            u32 indices = 0;
+            for (u32 i = 0; i < 16; ++i) {
+                indices |= static_cast<u32>(index_array[i]) << (i * 2);
+            }
+            ::memcpy(out_block + 0, std::addressof(color0), sizeof(u16));
+            ::memcpy(out_block + 2, std::addressof(color1), sizeof(u16));
+            ::memcpy(out_block + 4, std::addressof(indices), sizeof(u32));
+            return error;
+        }
+
+        void EncodeBc1ColorBlock(u8 *out_block, const BcBlock *block) {
+            v4s endpoint0 = {}, endpoint1 = {};
+            FitBcEndpoints(std::addressof(endpoint0), std::addressof(endpoint1), block, MaskRgb);
+
+            u8 first_block[8] = {};
+            const float first_error = EncodeBc1Color(first_block, block, endpoint0, endpoint1);
+
+            /* Refine once against the first pass indices, keep whichever is better */
+            u8 index_array[16] = {};
+            u32 indices = 0;
+            ::memcpy(std::addressof(indices), first_block + 4, sizeof(u32));
+            for (u32 i = 0; i < 16; ++i) {
+                index_array[i] = (indices >> (i * 2)) & 3;
+            }
+
+            u16 color0 = 0, color1 = 0;
+            ::memcpy(std::addressof(color0), first_block + 0, sizeof(u16));
+            ::memcpy(std::addressof(color1), first_block + 2, sizeof(u16));
+            v4s refined0 = UnpackRgb565(color0);
+            v4s refined1 = UnpackRgb565(color1);
+            RefineBcEndpoints(std::addressof(refined0), std::addressof(refined1), block, index_array, Bc1WeightArray);
+
+            const float refined_error = EncodeBc1Color(out_block, block, refined1, refined0);
+            if (first_error <= refined_error) {
+                ::memcpy(out_block, first_block, sizeof(first_block));
+            }
+        }
+
+        /* BC3 alpha */
+
+        void EncodeBc3AlphaBlock(u8 *out_block, const BcBlock *block) {
+            float min_alpha = 255.0f, max_alpha = 0.0f;
+            for (u32 i = 0; i < 16; ++i) {
+                const float alpha = block->texel_array[i][3];
+                min_alpha = (alpha < min_alpha) ? alpha : min_alpha;
+                max_alpha = (max_alpha < alpha) ? alpha : max_alpha;
+            }
+
+            /* Eight step mode needs alpha0 > alpha1 */
+            const u32 alpha0 = static_cast<u32>(max_alpha);
+            const u32 alpha1 = static_cast<u32>(min_alpha);
+
+            u8 index_array[16] = {};
+            if (alpha0 != alpha1) {
+                v4s palette_array[8] = {};
+                palette_array[0][3] = static_cast<float>(alpha0);
+                palette_array[1][3] = static_cast<float>(alpha1);
+                for (u32 i = 2; i < 8; ++i) {
+                    palette_array[i][3] = static_cast<float>(((8 - i) * alpha0 + (i - 1) * alpha1) / 7);
+                }
+                SelectBcIndices(index_array, block, palette_array, 8, MaskAlpha);
+            }
+
+            u64 indices = 0;
+            for (u32 i = 0; i < 16; ++i) {
+                indices |= static_cast<u64>(index_array[i]) << (i * 3);
+            }
+            out_block[0] = static_cast<u8>(alpha0);
+            out_block[1] = static_cast<u8>(alpha1);
+            for (u32 i = 0; i < 6; ++i) {
+                out_block[2 + i] = static_cast<u8>(indices >> (i * 8));
+            }
+        }
+
+        /* BC7 */
+
+        constexpr ALWAYS_INLINE u32 InterpolateBc7(u32 endpoint0, u32 endpoint1, u32 weight) {
+            return ((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6;
+        }
+
+        struct Bc7Mode6Endpoint {
+            s32 quantized[4];
+            u32 p_bit;
+            v4s decoded;
+        };
+
+        void QuantizeBc7Mode6Endpoint(Bc7Mode6Endpoint *out_endpoint, v4s endpoint, u32 p_bit) {
+            out_endpoint->p_bit = p_bit;
+            for (u32 c = 0; c < 4; ++c) {
+                s32 quantized = static_cast<s32>((ClampUnorm8(endpoint[c]) - static_cast<float>(p_bit)) * 0.5f + 0.5f);
+                quantized = (quantized < 0) ? 0 : (127 < quantized) ? 127 : quantized;
+                out_endpoint->quantized[c] = quantized;
+                out_endpoint->decoded[c]   = static_cast<float>((quantized << 1) | p_bit);
+            }
+        }
+
+        /* Picks the p-bit closest to the unquantized endpoint */
+        void QuantizeBc7Mode6EndpointNearest(Bc7Mode6Endpoint *out_endpoint, v4s endpoint) {
+            Bc7Mode6Endpoint endpoint_array[2] = {};
+            QuantizeBc7Mode6Endpoint(std::addressof(endpoint_array[0]), endpoint, 0);
+            QuantizeBc7Mode6Endpoint(std::addressof(endpoint_array[1]), endpoint, 1);
+
+            const v4s delta0 = endpoint_array[0].decoded - endpoint;
+            const v4s delta1 = endpoint_array[1].decoded - endpoint;
+            *out_endpoint = (SumLanes(delta0 * delta0) <= SumLanes(delta1 * delta1)) ? endpoint_array[0] : endpoint_array[1];
+        }
+
+        float SelectBc7Mode6Indices(u8 *out_index_array, const BcBlock *block, const Bc7Mode6Endpoint *endpoint0, const Bc7Mode6Endpoint *endpoint1) {
+            v4s palette_array[16] = {};
+            for (u32 i = 0; i < 16; ++i) {
+                for (u32 c = 0; c < 4; ++c) {
+                    palette_array[i][c] = static_cast<float>(InterpolateBc7(static_cast<u32>(endpoint0->decoded[c]), static_cast<u32>(endpoint1->decoded[c]), Bc7Weight4Array[i]));
+                }
+            }
+            return SelectBcIndices(out_index_array, block, palette_array, 16, MaskRgba);
+        }
+
+        float EncodeBc7Mode6(u8 *out_block, const BcBlock *block, BcQuality quality) {
+            float weight_array[16] = {};
+            for (u32 i = 0; i < 16; ++i) {
+                weight_array[i] = static_cast<float>(Bc7Weight4Array[i]) / 64.0f;
+            }
+
+            v4s endpoint0 = {}, endpoint1 = {};
+            FitBcEndpoints(std::addressof(endpoint0), std::addressof(endpoint1), block, MaskRgba);
+
+            const u32 refine_count = (quality == BcQuality_Fast) ? 0 : (quality == BcQuality_Normal) ? 2 : 4;
+
+            Bc7Mode6Endpoint best_endpoint0 = {}, best_endpoint1 = {};
+            u8    best_index_array[16] = {};
+            float best_error           = __builtin_huge_valf();
+            for (u32 pass = 0; pass <= refine_count; ++pass) {
+
+                /* Slow tries every p-bit pair, otherwise each endpoint takes its nearest */
+                const u32 p_bit_combination_count = (quality == BcQuality_Slow) ? 4 : 1;
+                for (u32 p = 0; p < p_bit_combination_count; ++p) {
+                    Bc7Mode6Endpoint quantized0 = {}, quantized1 = {};
+                    if (quality == BcQuality_Slow) {
+                        QuantizeBc7Mode6Endpoint(std::addressof(quantized0), endpoint0, p & 1);
+                        QuantizeBc7Mode6Endpoint(std::addressof(quantized1), endpoint1, p >> 1);
+                    } else {
+                        QuantizeBc7Mode6EndpointNearest(std::addressof(quantized0), endpoint0);
+                        QuantizeBc7Mode6EndpointNearest(std::addressof(quantized1), endpoint1);
+                    }
+
+                    u8 index_array[16] = {};
+                    const float error = SelectBc7Mode6Indices(index_array, block, std::addressof(quantized0), std::addressof(quantized1));
+                    if (best_error <= error) { continue; }
+
+                    best_error     = error;
+                    best_endpoint0 = quantized0;
+                    best_endpoint1 = quantized1;
+                    ::memcpy(best_index_array, index_array, sizeof(index_array));
+                }
+
+                if (pass == refine_count || best_error == 0.0f) { break; }
+                RefineBcEndpoints(std::addressof(endpoint0), std::addressof(endpoint1), block, best_index_array, weight_array);
+            }
+
+            /* The anchor index drops its high bit, swap endpoints so it is clear */
+            if (8 <= best_index_array[0]) {
+                const Bc7Mode6Endpoint swap = best_endpoint0;
+                best_endpoint0 = best_endpoint1;
+                best_endpoint1 = swap;
+                for (u32 i = 0; i < 16; ++i) {
+                    best_index_array[i] = 15 - best_index_array[i];
+                }
+            }
+
+            BcBitWriter writer = {};
+            writer.Write(1 << 6, 7);
+            for (u32 c = 0; c < 4; ++c) {
+                writer.Write(best_endpoint0.quantized[c], 7);
+                writer.Write(best_endpoint1.quantized[c], 7);
+            }
+            writer.Write(best_endpoint0.p_bit, 1);
+            writer.Write(best_endpoint1.p_bit, 1);
+            writer.Write(best_index_array[0], 3);
+            for (u32 i = 1; i < 16; ++i) {
+                writer.Write(best_index_array[i], 4);
+            }
+            DD_ASSERT(writer.position == 128);
+
+            ::memcpy(out_block, writer.bits, sizeof(writer.bits));
+            return best_error;
+        }
+
+        /* Mode 5 codes color and the rotated channel separately, each with 2 bit indices */
+        float EncodeBc7Mode5(u8 *out_block, const u8 *block_rgba, u32 rotation) {
+            BcBlock block = {};
+            LoadBcBlock(std::addressof(block), block_rgba, rotation);
+
+            constexpr float WeightArray[4] = { 0.0f, 21.0f / 64.0f, 43.0f / 64.0f, 1.0f };
+
+            /* Color, 7 bit endpoints */
+            v4s color0 = {}, color1 = {};
+            FitBcEndpoints(std::addressof(color0), std::addressof(color1), std::addressof(block), MaskRgb);
+
+            s32   color_quantized[2][3]  = {};
+            u8    color_index_array[16]  = {};
+            float color_error            = __builtin_huge_valf();
+            for (u32 pass = 0; pass < 2; ++pass) {
+                s32 quantized[2][3] = {};
+                v4s palette_array[4] = {};
+                for (u32 c = 0; c < 3; ++c) {
+                    quantized[0][c] = QuantizeUnorm(color0[c], 127);
+                    quantized[1][c] = QuantizeUnorm(color1[c], 127);
+
+                    const u32 decoded0 = (quantized[0][c] << 1) | (quantized[0][c] >> 6);
+                    const u32 decoded1 = (quantized[1][c] << 1) | (quantized[1][c] >> 6);
+                    for (u32 i = 0; i < 4; ++i) {
+                        palette_array[i][c] = static_cast<float>(InterpolateBc7(decoded0, decoded1, Bc7Weight2Array[i]));
+                    }
+                }
+
+                u8 index_array[16] = {};
+                const float error = SelectBcIndices(index_array, std::addressof(block), palette_array, 4, MaskRgb);
+                if (error < color_error) {
+                    color_error = error;
+                    ::memcpy(color_quantized, quantized, sizeof(quantized));
+                    ::memcpy(color_index_array, index_array, sizeof(index_array));
+                }
+                RefineBcEndpoints(std::addressof(color0), std::addressof(color1), std::addressof(block), color_index_array, WeightArray);
+            }
+
+            /* Alpha, 8 bit endpoints */
+            v4s alpha0 = {}, alpha1 = {};
+            FitBcEndpoints(std::addressof(alpha0), std::addressof(alpha1), std::addressof(block), MaskAlpha);
+
+            s32   alpha_quantized[2]     = {};
+            u8    alpha_index_array[16]  = {};
+            float alpha_error            = __builtin_huge_valf();
+            for (u32 pass = 0; pass < 2; ++pass) {
+                const s32 quantized[2] = { QuantizeUnorm(alpha0[3], 255), QuantizeUnorm(alpha1[3], 255) };
+
+                v4s palette_array[4] = {};
+                for (u32 i = 0; i < 4; ++i) {
+                    palette_array[i][3] = static_cast<float>(InterpolateBc7(quantized[0], quantized[1], Bc7Weight2Array[i]));
+                }
+
+                u8 index_array[16] = {};
+                const float error = SelectBcIndices(index_array, std::addressof(block), palette_array, 4, MaskAlpha);
+                if (error < alpha_error) {
+                    alpha_error = error;
+                    ::memcpy(alpha_quantized, quantized, sizeof(quantized));
+                    ::memcpy(alpha_index_array, index_array, sizeof(index_array));
+                }
+                RefineBcEndpoints(std::addressof(alpha0), std::addressof(alpha1), std::addressof(block), alpha_index_array, WeightArray);
+            }
+
+            /* Both anchors drop their high bit */
+            if (2 <= color_index_array[0]) {
+                for (u32 c = 0; c < 3; ++c) {
+                    const s32 swap = color_quantized[0][c];
+                    color_quantized[0][c] = color_quantized[1][c];
+                    color_quantized[1][c] = swap;
+                }
+                for (u32 i = 0; i < 16; ++i) {
+                    color_index_array[i] = 3 - color_index_array[i];
+                }
+            }
+            if (2 <= alpha_index_array[0]) {
+                const s32 swap = alpha_quantized[0];
+                alpha_quantized[0] = alpha_quantized[1];
+                alpha_quantized[1] = swap;
+                for (u32 i = 0; i < 16; ++i) {
+                    alpha_index_array[i] = 3 - alpha_index_array[i];
+                }
+            }
+
+            BcBitWriter writer = {};
+            writer.Write(1 << 5, 6);
+            writer.Write(rotation, 2);
+            for (u32 c = 0; c < 3; ++c) {
+                writer.Write(color_quantized[0][c], 7);
+                writer.Write(color_quantized[1][c], 7);
+            }
+            writer.Write(alpha_quantized[0], 8);
+            writer.Write(alpha_quantized[1], 8);
+            writer.Write(color_index_array[0], 1);
+            for (u32 i = 1; i < 16; ++i) {
+                writer.Write(color_index_array[i], 2);
+            }
+            writer.Write(alpha_index_array[0], 1);
+            for (u32 i = 1; i < 16; ++i) {
+                writer.Write(alpha_index_array[i], 2);
+            }
+            DD_ASSERT(writer.position == 128);
+
+            ::memcpy(out_block, writer.bits, sizeof(writer.bits));
+            return color_error + alpha_error;
+        }
+
+        /* Image */
+
+        struct BcEncodeBatch {
+            u8            *out_blocks;
+            const u8      *image_rgba;
+            u32            width;
+            u32            height;
+            u32            block_count_x;
+            u32            block_row_count;
+            BcFormat       format;
+            BcQuality      quality;
+            volatile LONG  next_block_row;
+        };
+
+        void EncodeBcBlockRow(BcEncodeBatch *batch, u32 block_row) {
+            const u32 block_size = GetBcBlockSize(batch->format);
+            u8       *out_block  = batch->out_blocks + static_cast<size_t>(block_row) * batch->block_count_x * block_size;
+
+            for (u32 block_x = 0; block_x < batch->block_count_x; ++block_x) {
+
+                /* Gather block, edges replicate the last texel */
+                u8 block_rgba[16 * 4] = {};
+                for (u32 y = 0; y < BcBlockDimension; ++y) {
+                    u32 image_y = block_row * BcBlockDimension + y;
+                    image_y = (batch->height <= image_y) ? batch->height - 1 : image_y;
+                    for (u32 x = 0; x < BcBlockDimension; ++x) {
+                        u32 image_x = block_x * BcBlockDimension + x;
+                        image_x = (batch->width <= image_x) ? batch->width - 1 : image_x;
+                        ::memcpy(block_rgba + (y * BcBlockDimension + x) * 4, batch->image_rgba + (static_cast<size_t>(image_y) * batch->width + image_x) * 4, 4);
+                    }
+                }
+
+                switch (batch->format) {
+                    case BcFormat_Bc1:
+                        EncodeBc1Block(out_block, block_rgba);
+                        break;
+                    case BcFormat_Bc3:
+                        EncodeBc3Block(out_block, block_rgba);
+                        break;
+                    case BcFormat_Bc7:
+                        EncodeBc7Block(out_block, block_rgba, batch->quality);
+                        break;
+                }
+                out_block += block_size;
+            }
+        }
+
+        void ProcessBcEncodeBatch(BcEncodeBatch *batch) {
+            u32 block_row = static_cast<u32>(::InterlockedIncrement(std::addressof(batch->next_block_row)) - 1);
+            while (block_row < batch->block_row_count) {
+                EncodeBcBlockRow(batch, block_row);
+                block_row = static_cast<u32>(::InterlockedIncrement(std::addressof(batch->next_block_row)) - 1);
+            }
+        }
+
+        unsigned long BcEncodeWorkerMain(void *arg) {
+            util::SetProfilerThreadName("BcEncode");
+            ProcessBcEncodeBatch(reinterpret_cast<BcEncodeBatch*>(arg));
+            return 0;
+        }
+    }
+
+    void EncodeBc1Block(void *out_block, const u8 *block_rgba) {
+        BcBlock block = {};
+        LoadBcBlock(std::addressof(block), block_rgba, 0);
+        EncodeBc1ColorBlock(reinterpret_cast<u8*>(out_block), std::addressof(block));
+    }
+
+    void EncodeBc3Block(void *out_block, const u8 *block_rgba) {
+        BcBlock block = {};
+        LoadBcBlock(std::addressof(block), block_rgba, 0);
+        EncodeBc3AlphaBlock(reinterpret_cast<u8*>(out_block), std::addressof(block));
+        EncodeBc1ColorBlock(reinterpret_cast<u8*>(out_block) + 8, std::addressof(block));
+    }
+
+    void EncodeBc7Block(void *out_block, const u8 *block_rgba, BcQuality quality) {
+        BcBlock block = {};
+        LoadBcBlock(std::addressof(block), block_rgba, 0);
+
+        const float mode6_error = EncodeBc7Mode6(reinterpret_cast<u8*>(out_block), std::addressof(block), quality);
+        if (quality != BcQuality_Slow || mode6_error == 0.0f) { return; }
+
+        /* Mode 5 often wins when alpha is unrelated to color, or a channel varies independently */
+        float best_error = mode6_error;
+        for (u32 rotation = 0; rotation < 4; ++rotation) {
+            u8 mode5_block[16] = {};
+            const float error = EncodeBc7Mode5(mode5_block, block_rgba, rotation);
+            if (best_error <= error) { continue; }
+
+            best_error = error;
+            ::memcpy(out_block, mode5_block, sizeof(mode5_block));
+        }
+    }
+
+    void EncodeBcImage(void *out_blocks, const u8 *image_rgba, u32 width, u32 height, const BcEncodeInfo *bc_encode_info) {
+        DD_PROFILE_SCOPE("EncodeBcImage");
+        DD_ASSERT(0 < width && 0 < height);
+
+        BcEncodeBatch batch = {
+            .out_blocks      = reinterpret_cast<u8*>(out_blocks),
+            .image_rgba      = image_rgba,
+            .width           = width,
+            .height          = height,
+            .block_count_x   = (width + BcBlockDimension - 1) / BcBlockDimension,
+            .block_row_count = (height + BcBlockDimension - 1) / BcBlockDimension,
+            .format          = bc_encode_info->format,
+            .quality         = bc_encode_info->quality,
+        };
+
+        /* Never more threads than block rows */
+        u32 thread_count = bc_encode_info->thread_count;
+        if (thread_count == 0) {
+            thread_count = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+        }
+        thread_count = (batch.block_row_count < thread_count) ? batch.block_row_count : thread_count;
+        thread_count = (MaxBcEncodeThreads < thread_count) ? MaxBcEncodeThreads : thread_count;
+        thread_count = (thread_count == 0) ? 1 : thread_count;
+
+        /* Start workers, the caller is one of the threads */
+        Handle worker_thread_array[MaxBcEncodeThreads] = {};
+        for (u32 i = 1; i < thread_count; ++i) {
+            worker_thread_array[i] = ::CreateThread(nullptr, BcEncodeWorkerStackSize, BcEncodeWorkerMain, std::addressof(batch), 0, nullptr);
+            DD_ASSERT(worker_thread_array[i] != nullptr);
+        }
+
+        ProcessBcEncodeBatch(std::addressof(batch));
+
+        for (u32 i = 1; i < thread_count; ++i) {
+            ::WaitForSingleObject(worker_thread_array[i], INFINITE);
+            ::CloseHandle(worker_thread_array[i]);
+        }
+    }
+}
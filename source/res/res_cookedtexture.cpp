@@ -0,0 +1,40 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    void LoadCookedTexture(const char *path, CookedTexture *out_cooked_texture) {
+
+        /* Map cooked texture, mips are consumed in place */
+        out_cooked_texture->file.Initialize(path, MappedFileAccess_Sequential);
+        DD_ASSERT(sizeof(CookedTextureHeader) <= out_cooked_texture->file.GetSize());
+
+        const CookedTextureHeader *header = out_cooked_texture->file.GetViewAs<CookedTextureHeader>(0);
+        DD_ASSERT(header->magic == CookedTextureMagic && header->version == CookedTextureVersion);
+        DD_ASSERT(0 < header->mip_levels && header->mip_levels <= MaxCookedTextureMips);
+
+        const CookedTextureMip *last_mip = std::addressof(header->mip_array[header->mip_levels - 1]);
+        DD_ASSERT(last_mip->offset + last_mip->size <= out_cooked_texture->file.GetSize());
+
+        out_cooked_texture->header = header;
+    }
+
+    void FreeCookedTexture(CookedTexture *cooked_texture) {
+        cooked_texture->file.Finalize();
+        cooked_texture->header = nullptr;
+    }
+}
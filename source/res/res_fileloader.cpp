@@ -17,6 +17,33 @@
 
 namespace dd::res {
 
+    namespace {
+        volatile LONG64 bytes_copied = 0;
+        volatile LONG64 bytes_mapped = 0;
+        volatile LONG   copy_count   = 0;
+        volatile LONG   map_count    = 0;
+    }
+
+    namespace impl {
+
+        void RecordCopiedBytes(u64 size) {
+            ::InterlockedAdd64(std::addressof(bytes_copied), size);
+            ::InterlockedIncrement(std::addressof(copy_count));
+        }
+
+        void RecordMappedBytes(u64 size) {
+            ::InterlockedAdd64(std::addressof(bytes_mapped), size);
+            ::InterlockedIncrement(std::addressof(map_count));
+        }
+    }
+
+    void GetFileStats(FileStats *out_file_stats) {
+        out_file_stats->bytes_copied = bytes_copied;
+        out_file_stats->bytes_mapped = bytes_mapped;
+        out_file_stats->copy_count   = copy_count;
+        out_file_stats->map_count    = map_count;
+    }
+
     void LoadFile(const char *path, void **out_file, u32 *out_file_size) {
         /* Find file */
         Handle file = ::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -38,6 +65,8 @@ namespace dd::res {
             DD_ASSERT(result != false);
             DD_ASSERT(file_size.LowPart == size_read);
 
+            impl::RecordCopiedBytes(size_read);
+
             *out_file = buffer;
         }
 
@@ -69,6 +98,8 @@ namespace dd::res {
             result = ::ReadFile(file, buffer, file_size.LowPart - 1, std::addressof(size_read), nullptr);
             DD_ASSERT(result != false && file_size.LowPart - 1 == size_read);
 
+            impl::RecordCopiedBytes(size_read);
+
             buffer[file_size.LowPart - 1] = '\0';
             *out_file = buffer;
         }
@@ -83,21 +114,210 @@ namespace dd::res {
 #pragma GCC push_options
 #pragma GCC optimize("-O2")
 
+namespace dd::res::impl {
+
+    /* Armed per thread with the final image size, the matching stb allocation is placed in the destination */
+    struct StbDestination {
+        void   *destination;
+        size_t  image_size;
+        size_t  destination_size;
+        bool    is_claimed;
+    };
+
+    thread_local StbDestination stb_destination = {};
+
+    void *StbMalloc(size_t size) {
+        StbDestination *dst = std::addressof(stb_destination);
+
+        /* The jpeg decoder asks for one extra byte */
+        if (dst->destination != nullptr && dst->is_claimed == false && dst->image_size <= size && size <= dst->image_size + 1 && size <= dst->destination_size) {
+            dst->is_claimed = true;
+            return dst->destination;
+        }
+        return ::malloc(size);
+    }
+
+    void StbFree(void *pointer) {
+        if (pointer != nullptr && pointer == stb_destination.destination) {
+            stb_destination.is_claimed = false;
+            return;
+        }
+        ::free(pointer);
+    }
+
+    void *StbRealloc(void *pointer, size_t old_size, size_t new_size) {
+        if (pointer == nullptr || pointer != stb_destination.destination) { return ::realloc(pointer, new_size); }
+
+        /* An intermediate buffer claimed the destination, move it out */
+        void *new_pointer = ::malloc(new_size);
+        if (new_pointer != nullptr) {
+            ::memcpy(new_pointer, pointer, (old_size < new_size) ? old_size : new_size);
+            stb_destination.is_claimed = false;
+        }
+        return new_pointer;
+    }
+}
+
 /* STB doesn't play nice with optimizations */
+#define STBI_MALLOC(size)                        ::dd::res::impl::StbMalloc(size)
+#define STBI_FREE(pointer)                       ::dd::res::impl::StbFree(pointer)
+#define STBI_REALLOC_SIZED(pointer, old, size)   ::dd::res::impl::StbRealloc(pointer, old, size)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
 namespace dd::res {
 
+    namespace {
+
+        constexpr u32 MaxStbImageThreads      = 32;
+        constexpr u32 StbImageWorkerStackSize = 0x10000;
+
+        struct StbImageBatch {
+            StbImageLoad   *load_array;
+            u32             load_count;
+            volatile LONG   next_index;
+            volatile LONG64 file_bytes;
+            volatile LONG64 decoded_bytes;
+            volatile LONG   in_place_count;
+        };
+
+        void DecodeStbImageLoad(StbImageLoad *load, StbImageBatch *batch) {
+            DD_PROFILE_SCOPE("DecodeStbImage");
+
+            /* Map file if the caller has not read it */
+            MappedFile file;
+            const void *file_data = load->file;
+            u32         file_size = load->file_size;
+            if (file_data == nullptr) {
+                file.Initialize(load->path, MappedFileAccess_Sequential);
+                DD_ASSERT(file.GetSize() <= 0x7fff'ffff);
+
+                file_data = file.GetView();
+                file_size = static_cast<u32>(file.GetSize());
+            }
+
+            /* Arm the destination so stb allocates the final image inside it */
+            impl::StbDestination *dst = std::addressof(impl::stb_destination);
+            if (load->destination != nullptr) {
+                s32 width = 0, height = 0, channels = 0;
+                if (GetStbImageInfo(file_data, file_size, std::addressof(width), std::addressof(height), std::addressof(channels)) == true) {
+                    const s32 out_channels = (load->desired_channels != 0) ? load->desired_channels : channels;
+
+                    dst->destination      = load->destination;
+                    dst->image_size       = static_cast<size_t>(width) * height * out_channels;
+                    dst->destination_size = load->destination_size;
+                    dst->is_claimed       = false;
+                }
+            }
+
+            load->image_data = ::stbi_load_from_memory(reinterpret_cast<const unsigned char*>(file_data), static_cast<s32>(file_size), std::addressof(load->width), std::addressof(load->height), std::addressof(load->channels), load->desired_channels);
+            load->is_success = load->image_data != nullptr;
+
+            *dst = {};
+            file.Finalize();
+
+            if (load->is_success == false) { return; }
+
+            /* Fall back to a copy when an intermediate held the destination, or it was too small to arm */
+            const s32    out_channels = (load->desired_channels != 0) ? load->desired_channels : load->channels;
+            const size_t image_size   = static_cast<size_t>(load->width) * load->height * out_channels;
+            if (load->image_data == load->destination) {
+                ::InterlockedIncrement(std::addressof(batch->in_place_count));
+            } else if (load->destination != nullptr && image_size <= load->destination_size) {
+                ::memcpy(load->destination, load->image_data, image_size);
+                ::stbi_image_free(load->image_data);
+                load->image_data = load->destination;
+            }
+
+            ::InterlockedAdd64(std::addressof(batch->file_bytes), file_size);
+            ::InterlockedAdd64(std::addressof(batch->decoded_bytes), image_size);
+        }
+
+        void ProcessStbImageBatch(StbImageBatch *batch) {
+
+            /* stb keeps the flip flag per thread when STBI_THREAD_LOCAL is available */
+            ::stbi_set_flip_vertically_on_load_thread(true);
+
+            u32 index = static_cast<u32>(::InterlockedIncrement(std::addressof(batch->next_index)) - 1);
+            while (index < batch->load_count) {
+                DecodeStbImageLoad(std::addressof(batch->load_array[index]), batch);
+                index = static_cast<u32>(::InterlockedIncrement(std::addressof(batch->next_index)) - 1);
+            }
+        }
+
+        unsigned long StbImageWorkerMain(void *arg) {
+            util::SetProfilerThreadName("StbImage");
+            ProcessStbImageBatch(reinterpret_cast<StbImageBatch*>(arg));
+            return 0;
+        }
+    }
+
+    void LoadStbImages(StbImageLoad *load_array, u32 load_count, u32 thread_count, StbImageBatchStats *out_stats) {
+
+        /* Never more threads than images */
+        if (thread_count == 0) {
+            thread_count = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+        }
+        thread_count = (load_count < thread_count) ? load_count : thread_count;
+        thread_count = (MaxStbImageThreads < thread_count) ? MaxStbImageThreads : thread_count;
+        thread_count = (thread_count == 0) ? 1 : thread_count;
+
+        StbImageBatch batch = {
+            .load_array = load_array,
+            .load_count = load_count,
+        };
+
+        const s64 begin_tick = util::GetSystemTick();
+
+        /* Start workers, the caller is one of the threads */
+        Handle worker_thread_array[MaxStbImageThreads] = {};
+        for (u32 i = 1; i < thread_count; ++i) {
+            worker_thread_array[i] = ::CreateThread(nullptr, StbImageWorkerStackSize, StbImageWorkerMain, std::addressof(batch), 0, nullptr);
+            DD_ASSERT(worker_thread_array[i] != nullptr);
+        }
+
+        ProcessStbImageBatch(std::addressof(batch));
+
+        for (u32 i = 1; i < thread_count; ++i) {
+            ::WaitForSingleObject(worker_thread_array[i], INFINITE);
+            ::CloseHandle(worker_thread_array[i]);
+        }
+
+        if (out_stats == nullptr) { return; }
+
+        const s64 decode_tick = util::GetSystemTick() - begin_tick;
+        const s64 decode_ns   = util::GetNanosecondsFromTick(decode_tick);
+
+        out_stats->file_bytes           = batch.file_bytes;
+        out_stats->decoded_bytes        = batch.decoded_bytes;
+        out_stats->decode_tick          = decode_tick;
+        out_stats->thread_count         = thread_count;
+        out_stats->in_place_count       = batch.in_place_count;
+        out_stats->decode_mb_per_second = (decode_ns == 0) ? 0.0 : (static_cast<double>(batch.decoded_bytes) / (1024.0 * 1024.0)) / (static_cast<double>(decode_ns) / 1'000'000'000.0);
+    }
+
     void LoadStbImage(const char *path, s32 desired_channels, unsigned char **out_image_data, s32 *out_width, s32 *out_height, s32 *out_channels) {
-        void *file_buffer = nullptr;
-        u32 size = 0;
-        LoadFile(path, std::addressof(file_buffer), std::addressof(size));
+
+        /* Decode straight from the mapped file */
+        MappedFile file;
+        file.Initialize(path, MappedFileAccess_Sequential);
+        DD_ASSERT(file.GetSize() <= 0x7fff'ffff);
+
+        DecodeStbImage(file.GetView(), static_cast<u32>(file.GetSize()), desired_channels, out_image_data, out_width, out_height, out_channels);
+
+        file.Finalize();
+    }
+
+    void DecodeStbImage(const void *file, u32 file_size, s32 desired_channels, unsigned char **out_image_data, s32 *out_width, s32 *out_height, s32 *out_channels) {
+        DD_ASSERT(file_size <= 0x7fff'ffff);
 
         ::stbi_set_flip_vertically_on_load(true);
-        *out_image_data = ::stbi_load_from_memory(reinterpret_cast<unsigned char*>(file_buffer), size, out_width, out_height, out_channels, desired_channels);
+        *out_image_data = ::stbi_load_from_memory(reinterpret_cast<const unsigned char*>(file), static_cast<s32>(file_size), out_width, out_height, out_channels, desired_channels);
+    }
 
-        delete [] reinterpret_cast<char*>(file_buffer);
+    bool GetStbImageInfo(const void *file, u32 file_size, s32 *out_width, s32 *out_height, s32 *out_channels) {
+        DD_ASSERT(file_size <= 0x7fff'ffff);
+        return ::stbi_info_from_memory(reinterpret_cast<const unsigned char*>(file), static_cast<s32>(file_size), out_width, out_height, out_channels) != 0;
     }
 
     void FreeStbImage(unsigned char *image_data) {
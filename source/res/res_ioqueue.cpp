@@ -0,0 +1,331 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    unsigned long IoQueue::WorkerThreadMain(void *arg) {
+        IoQueue *io_queue = reinterpret_cast<IoQueue*>(arg);
+
+        util::SetProfilerThreadName("Io");
+
+        if (io_queue->IsCompletionPortEnabled() == true) {
+            io_queue->CompletionPortWorkerMain();
+        } else {
+            io_queue->BlockingWorkerMain();
+        }
+        return 0;
+    }
+
+    void IoQueue::CompletionPortWorkerMain() {
+
+        u32 exit_count = 0;
+        while (exit_count == 0) {
+
+            /* Harvest a batch of completions */
+            OVERLAPPED_ENTRY entry_array[MaxCompletionEntries] = {};
+            unsigned long entry_count = 0;
+            const bool result0 = ::GetQueuedCompletionStatusEx(m_completion_port, entry_array, MaxCompletionEntries, std::addressof(entry_count), INFINITE, false);
+            DD_ASSERT(result0 == true);
+
+            for (u32 i = 0; i < entry_count; ++i) {
+                if (entry_array[i].lpCompletionKey == ExitKey) {
+                    ++exit_count;
+                    continue;
+                }
+                if (entry_array[i].lpCompletionKey == SubmitKey) { continue; }
+
+                IoRequest *request = reinterpret_cast<IoRequest*>(reinterpret_cast<uintptr_t>(entry_array[i].lpOverlapped) - offsetof(IoRequest, overlapped));
+
+                unsigned long bytes_read = 0;
+                const bool result1 = ::GetOverlappedResult(request->file, std::addressof(request->overlapped), std::addressof(bytes_read), false);
+
+                this->CompleteRequest(request, (result1 == true) ? IoResult_Success : IoResult_ReadFailed, bytes_read);
+            }
+
+            /* Refill the disk queue, submissions only post a wake up */
+            this->IssuePending();
+        }
+
+        /* Hand exit packets meant for other workers back to the port */
+        for (u32 i = 1; i < exit_count; ++i) {
+            ::PostQueuedCompletionStatus(m_completion_port, 0, ExitKey, nullptr);
+        }
+    }
+
+    void IoQueue::BlockingWorkerMain() {
+        for (;;) {
+
+            /* Wait for work */
+            IoRequest *request = nullptr;
+            {
+                std::scoped_lock l(m_cs);
+                while (m_pending_head == nullptr && m_is_exit == false) {
+                    m_pending_cv.Wait(std::addressof(m_cs));
+                }
+                if (m_pending_head == nullptr) { return; }
+
+                request = this->PopPending(1);
+            }
+
+            DD_PROFILE_SCOPE("IoRead");
+
+            if (this->OpenRequest(request, false) == false) {
+                this->CompleteRequest(request, IoResult_OpenFailed, 0);
+                continue;
+            }
+
+            /* The overlapped offset is honoured by synchronous handles too */
+            unsigned long bytes_read = 0;
+            const bool result = ::ReadFile(request->file, request->buffer, request->size, std::addressof(bytes_read), std::addressof(request->overlapped));
+
+            this->CompleteRequest(request, (result == true) ? IoResult_Success : IoResult_ReadFailed, bytes_read);
+        }
+    }
+
+    IoRequest *IoQueue::PopPending(u32 max_count) {
+        DD_ASSERT(m_cs.IsLockedByCurrentThread() == true);
+
+        /* Detach up to max_count requests from the front */
+        IoRequest *head = m_pending_head;
+        IoRequest *tail = nullptr;
+        u32 count = 0;
+        for (IoRequest *iter = m_pending_head; iter != nullptr && count < max_count; iter = iter->pending_next) {
+            tail = iter;
+            ++count;
+        }
+        if (tail == nullptr) { return nullptr; }
+
+        m_pending_head = tail->pending_next;
+        if (m_pending_head == nullptr) {
+            m_pending_tail = nullptr;
+        }
+        tail->pending_next = nullptr;
+
+        m_in_flight_count += count;
+
+        return head;
+    }
+
+    bool IoQueue::OpenRequest(IoRequest *request, bool is_overlapped) {
+
+        /* Open file */
+        const u32 flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | ((is_overlapped == true) ? FILE_FLAG_OVERLAPPED : 0);
+        request->file = ::CreateFile(request->path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (request->file == INVALID_HANDLE_VALUE) {
+            request->file = nullptr;
+            return false;
+        }
+
+        /* Size to end of file */
+        if (request->size == 0) {
+            LARGE_INTEGER file_size = {};
+            const bool result0 = ::GetFileSizeEx(request->file, std::addressof(file_size));
+            if (result0 == false || static_cast<u64>(file_size.QuadPart) <= request->offset || 0xffff'ffff < static_cast<u64>(file_size.QuadPart) - request->offset) { return false; }
+
+            request->size = static_cast<u32>(static_cast<u64>(file_size.QuadPart) - request->offset);
+        }
+
+        if (request->buffer == nullptr) {
+            request->buffer = new (std::nothrow) char[request->size];
+            DD_ASSERT(request->buffer != nullptr);
+        }
+
+        request->overlapped.Offset     = static_cast<u32>(request->offset);
+        request->overlapped.OffsetHigh = static_cast<u32>(request->offset >> 32);
+
+        return true;
+    }
+
+    void IoQueue::IssuePending() {
+
+        IoRequest *iter = nullptr;
+        {
+            std::scoped_lock l(m_cs);
+            if (m_pending_head == nullptr || m_max_in_flight <= m_in_flight_count) { return; }
+
+            iter = this->PopPending(m_max_in_flight - m_in_flight_count);
+        }
+
+        DD_PROFILE_SCOPE("IoIssue");
+
+        /* Open and queue reads outside the lock, completions are harvested by any worker */
+        while (iter != nullptr) {
+            IoRequest *request = iter;
+            iter = iter->pending_next;
+
+            if (this->OpenRequest(request, true) == false) {
+                this->CompleteRequest(request, IoResult_OpenFailed, 0);
+                continue;
+            }
+
+            const Handle port = ::CreateIoCompletionPort(request->file, m_completion_port, ReadKey, 0);
+            DD_ASSERT(port == m_completion_port);
+
+            const bool result = ::ReadFile(request->file, request->buffer, request->size, nullptr, std::addressof(request->overlapped));
+            if (result == false && ::GetLastError() != ERROR_IO_PENDING) {
+                this->CompleteRequest(request, IoResult_ReadFailed, 0);
+            }
+        }
+    }
+
+    void IoQueue::CompleteRequest(IoRequest *request, IoResult result, u32 bytes_read) {
+
+        if (request->file != nullptr) {
+            ::CloseHandle(request->file);
+            request->file = nullptr;
+        }
+
+        request->bytes_read = bytes_read;
+        request->result     = result;
+        impl::RecordCopiedBytes(bytes_read);
+
+        {
+            std::scoped_lock l(m_cs);
+            m_in_flight_count -= 1;
+        }
+
+        /* Deliver */
+        if (request->callback != nullptr) {
+            (request->callback)(request);
+        } else {
+            m_completion_queue.Push(*request);
+        }
+
+        std::scoped_lock l(m_cs);
+        m_outstanding_count -= 1;
+        if (m_outstanding_count == 0) {
+            m_idle_cv.Broadcast();
+        }
+    }
+
+    void IoQueue::Initialize(const IoQueueInfo *io_queue_info) {
+        DD_ASSERT(io_queue_info->worker_count != 0 && io_queue_info->worker_count <= MaxWorkers);
+        DD_ASSERT(io_queue_info->max_in_flight != 0);
+
+        m_worker_count      = io_queue_info->worker_count;
+        m_max_in_flight     = io_queue_info->max_in_flight;
+        m_in_flight_count   = 0;
+        m_outstanding_count = 0;
+        m_is_exit           = false;
+        m_pending_head      = nullptr;
+        m_pending_tail      = nullptr;
+        m_completion_port   = nullptr;
+
+        /* Create completion port, a failure falls back to blocking workers */
+        if (io_queue_info->is_completion_port_disabled == false) {
+            m_completion_port = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, m_worker_count);
+        }
+
+        /* Create workers */
+        for (u32 i = 0; i < m_worker_count; ++i) {
+            m_worker_thread_array[i] = ::CreateThread(nullptr, io_queue_info->worker_stack_size, WorkerThreadMain, this, 0, nullptr);
+            DD_ASSERT(m_worker_thread_array[i] != nullptr);
+        }
+    }
+
+    void IoQueue::Finalize() {
+        this->WaitIdle();
+
+        /* Signal exit */
+        if (m_completion_port != nullptr) {
+            for (u32 i = 0; i < m_worker_count; ++i) {
+                ::PostQueuedCompletionStatus(m_completion_port, 0, ExitKey, nullptr);
+            }
+        } else {
+            std::scoped_lock l(m_cs);
+            m_is_exit = true;
+            m_pending_cv.Broadcast();
+        }
+
+        /* Join workers */
+        for (u32 i = 0; i < m_worker_count; ++i) {
+            ::WaitForSingleObject(m_worker_thread_array[i], INFINITE);
+            ::CloseHandle(m_worker_thread_array[i]);
+            m_worker_thread_array[i] = nullptr;
+        }
+        m_worker_count = 0;
+
+        if (m_completion_port != nullptr) {
+            ::CloseHandle(m_completion_port);
+        }
+        m_completion_port = nullptr;
+    }
+
+    void IoQueue::Submit(IoRequest *request_array, u32 request_count) {
+        if (request_count == 0) { return; }
+
+        /* Reset outputs and link the batch */
+        for (u32 i = 0; i < request_count; ++i) {
+            IoRequest *request    = std::addressof(request_array[i]);
+            request->bytes_read   = 0;
+            request->result       = IoResult_Pending;
+            request->overlapped   = {};
+            request->file         = nullptr;
+            request->pending_next = (i + 1 < request_count) ? std::addressof(request_array[i + 1]) : nullptr;
+        }
+
+        {
+            std::scoped_lock l(m_cs);
+            if (m_pending_tail != nullptr) {
+                m_pending_tail->pending_next = request_array;
+            } else {
+                m_pending_head = request_array;
+            }
+            m_pending_tail       = std::addressof(request_array[request_count - 1]);
+            m_outstanding_count += request_count;
+
+            if (m_completion_port == nullptr) {
+                m_pending_cv.Broadcast();
+            }
+        }
+
+        /* One wake up per batch */
+        if (m_completion_port != nullptr) {
+            ::PostQueuedCompletionStatus(m_completion_port, 0, SubmitKey, nullptr);
+        }
+    }
+
+    u32 IoQueue::PollCompletions(IoRequest **out_request_array, u32 max_count) {
+
+        if (m_poll_batch.IsEmpty() == true) {
+            m_poll_batch = m_completion_queue.PopAll();
+        }
+
+        u32 count = 0;
+        while (count < max_count) {
+            IoRequest *request = m_poll_batch.PopFront();
+            if (request == nullptr) { break; }
+
+            out_request_array[count] = request;
+            ++count;
+        }
+
+        return count;
+    }
+
+    void IoQueue::WaitIdle() {
+        std::scoped_lock l(m_cs);
+        while (m_outstanding_count != 0) {
+            m_idle_cv.Wait(std::addressof(m_cs));
+        }
+    }
+
+    bool IoQueue::IsIdle() {
+        std::scoped_lock l(m_cs);
+        return m_outstanding_count == 0;
+    }
+}
@@ -0,0 +1,188 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        constexpr u32 LzHashBits  = 14;
+        constexpr u32 LzHashCount = 1 << LzHashBits;
+
+        inline u32 LoadU32(const u8 *address) {
+            u32 value = 0;
+            ::memcpy(std::addressof(value), address, sizeof(u32));
+            return value;
+        }
+
+        inline u32 HashU32(u32 value) {
+            return (value * 2654435761u) >> (32 - LzHashBits);
+        }
+
+        /* Extra length bytes after a saturated nibble */
+        inline u8 *WriteLength(u8 *out, u8 *out_end, size_t length) {
+            while (255 <= length) {
+                if (out == out_end) { return nullptr; }
+                *out = 255;
+                ++out;
+                length -= 255;
+            }
+            if (out == out_end) { return nullptr; }
+            *out = static_cast<u8>(length);
+            return out + 1;
+        }
+
+        inline const u8 *ReadLength(const u8 *in, const u8 *in_end, size_t *out_length) {
+            u8 value = 255;
+            while (value == 255) {
+                if (in == in_end) { return nullptr; }
+                value = *in;
+                ++in;
+                *out_length += value;
+            }
+            return in;
+        }
+
+        u8 *WriteSequence(u8 *out, u8 *out_end, const u8 *literal, size_t literal_length, size_t offset, size_t match_length) {
+            if (out == out_end) { return nullptr; }
+
+            /* Token */
+            const size_t match_code = (match_length == 0) ? 0 : match_length - LzMinMatch;
+            u8 *token = out;
+            *token = static_cast<u8>(((literal_length < 15) ? literal_length : 15) << 4) | static_cast<u8>((match_code < 15) ? match_code : 15);
+            ++out;
+
+            /* Literals */
+            if (15 <= literal_length) {
+                out = WriteLength(out, out_end, literal_length - 15);
+                if (out == nullptr) { return nullptr; }
+            }
+            if (static_cast<size_t>(out_end - out) < literal_length) { return nullptr; }
+            ::memcpy(out, literal, literal_length);
+            out += literal_length;
+
+            if (match_length == 0) { return out; }
+
+            /* Match */
+            if (out_end - out < 2) { return nullptr; }
+            out[0] = static_cast<u8>(offset);
+            out[1] = static_cast<u8>(offset >> 8);
+            out += 2;
+
+            if (15 <= match_code) {
+                out = WriteLength(out, out_end, match_code - 15);
+            }
+            return out;
+        }
+    }
+
+    size_t CompressLz(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+
+        const u8 *in      = reinterpret_cast<const u8*>(src);
+        u8       *out     = reinterpret_cast<u8*>(dst);
+        u8       *out_end = out + dst_capacity;
+
+        /* Last position of each hashed 4 byte sequence, biased by 1 so 0 is empty */
+        u32 *hash_table = new (std::nothrow) u32[LzHashCount]{};
+        DD_ASSERT(hash_table != nullptr);
+
+        /* Greedy match */
+        size_t anchor = 0;
+        size_t i      = 0;
+        while (out != nullptr && i + LzMinMatch <= src_size) {
+            const u32    sequence  = LoadU32(in + i);
+            const u32    hash      = HashU32(sequence);
+            const size_t candidate = hash_table[hash];
+            hash_table[hash] = static_cast<u32>(i + 1);
+
+            if (candidate == 0 || LzMaxOffset < i - (candidate - 1) || LoadU32(in + candidate - 1) != sequence) {
+                ++i;
+                continue;
+            }
+
+            const size_t match = candidate - 1;
+            size_t match_length = LzMinMatch;
+            while (i + match_length < src_size && in[match + match_length] == in[i + match_length]) {
+                ++match_length;
+            }
+
+            out = WriteSequence(out, out_end, in + anchor, i - anchor, i - match, match_length);
+
+            i      += match_length;
+            anchor  = i;
+        }
+
+        /* Trailing literals */
+        if (out != nullptr) {
+            out = WriteSequence(out, out_end, in + anchor, src_size - anchor, 0, 0);
+        }
+
+        delete[] hash_table;
+
+        return (out == nullptr) ? 0 : static_cast<size_t>(out - reinterpret_cast<u8*>(dst));
+    }
+
+    bool DecompressLz(const void *src, size_t src_size, void *dst, size_t dst_size) {
+
+        const u8 *in      = reinterpret_cast<const u8*>(src);
+        const u8 *in_end  = in + src_size;
+        u8       *out     = reinterpret_cast<u8*>(dst);
+        u8       *out_end = out + dst_size;
+
+        while (in < in_end) {
+            const u8 token = *in;
+            ++in;
+
+            /* Literals */
+            size_t literal_length = token >> 4;
+            if (literal_length == 15) {
+                in = ReadLength(in, in_end, std::addressof(literal_length));
+                if (in == nullptr) { return false; }
+            }
+            if (static_cast<size_t>(in_end - in) < literal_length || static_cast<size_t>(out_end - out) < literal_length) { return false; }
+
+            ::memcpy(out, in, literal_length);
+            in  += literal_length;
+            out += literal_length;
+
+            /* The final sequence ends after its literals */
+            if (in == in_end) { break; }
+
+            /* Match */
+            if (in_end - in < 2) { return false; }
+            const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+            if (offset == 0 || static_cast<size_t>(out - reinterpret_cast<u8*>(dst)) < offset) { return false; }
+
+            size_t match_length = token & 0xf;
+            if (match_length == 15) {
+                in = ReadLength(in, in_end, std::addressof(match_length));
+                if (in == nullptr) { return false; }
+            }
+            match_length += LzMinMatch;
+            if (static_cast<size_t>(out_end - out) < match_length) { return false; }
+
+            /* Byte copy, the match may overlap the output */
+            const u8 *match = out - offset;
+            for (size_t i = 0; i < match_length; ++i) {
+                out[i] = match[i];
+            }
+            out += match_length;
+        }
+
+        return out == out_end;
+    }
+}
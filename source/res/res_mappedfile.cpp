@@ -0,0 +1,74 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    void MappedFile::Initialize(const char *path, MappedFileAccess access) {
+
+        /* Open file */
+        const u32 flags = (access == MappedFileAccess_Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        m_file = ::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+        DD_ASSERT(m_file != INVALID_HANDLE_VALUE);
+
+        /* Get file size */
+        LARGE_INTEGER file_size = {};
+        const bool result0 = ::GetFileSizeEx(m_file, std::addressof(file_size));
+        DD_ASSERT(result0 == true && file_size.QuadPart != 0);
+        m_size = file_size.QuadPart;
+
+        /* Map the whole file */
+        m_mapping = ::CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        DD_ASSERT(m_mapping != nullptr);
+
+        m_view = ::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        DD_ASSERT(m_view != nullptr);
+
+        impl::RecordMappedBytes(m_size);
+
+        if (access == MappedFileAccess_WillNeed) {
+            this->Prefetch(0, m_size);
+        }
+    }
+
+    void MappedFile::Finalize() {
+        if (m_view != nullptr) {
+            ::UnmapViewOfFile(m_view);
+        }
+        if (m_mapping != nullptr) {
+            ::CloseHandle(m_mapping);
+        }
+        if (m_file != nullptr) {
+            ::CloseHandle(m_file);
+        }
+        m_file    = nullptr;
+        m_mapping = nullptr;
+        m_view    = nullptr;
+        m_size    = 0;
+    }
+
+    void MappedFile::Prefetch(u64 offset, u64 size) {
+        DD_ASSERT(offset + size <= m_size);
+
+        WIN32_MEMORY_RANGE_ENTRY range = {
+            .VirtualAddress = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(m_view) + offset),
+            .NumberOfBytes  = size
+        };
+
+        /* Best effort, a failure only loses the hint */
+        ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, std::addressof(range), 0);
+    }
+}
@@ -0,0 +1,141 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        vk::Buffer *CreateMeshBuffer(const vk::Context *context, vk::MemoryPool *memory_pool, const MeshStream *stream, u32 vk_usage) {
+
+            const vk::BufferInfo buffer_info = {
+                .size     = stream->size,
+                .offset   = stream->offset,
+                .vk_usage = vk_usage
+            };
+            DD_ASSERT((stream->offset % vk::Buffer::GetAlignment(context, std::addressof(buffer_info))) == 0);
+
+            vk::Buffer *buffer = new (std::nothrow) vk::Buffer();
+            DD_ASSERT(buffer != nullptr);
+            buffer->Initialize(context, std::addressof(buffer_info), memory_pool);
+
+            return buffer;
+        }
+    }
+
+    void LoadMesh(const vk::Context *context, const char *path, Mesh *out_mesh) {
+
+        /* Map and validate */
+        MappedFile file = {};
+        file.Initialize(path, MappedFileAccess_Sequential);
+        DD_ASSERT(sizeof(MeshHeader) <= file.GetSize());
+
+        const MeshHeader *header = file.GetViewAs<MeshHeader>(0);
+        DD_ASSERT(header->magic == MeshMagic && header->version == MeshVersion);
+        DD_ASSERT(1 <= header->lod_count && header->lod_count <= MaxMeshLods);
+        const u32 submesh_count = header->submesh_count * header->lod_count;
+        DD_ASSERT(header->submesh_count != 0 && sizeof(MeshHeader) + sizeof(MeshSubmesh) * submesh_count <= header->data_offset);
+        DD_ASSERT(header->data_offset + header->data_size <= file.GetSize());
+        DD_ASSERT(header->index_stream.offset + header->index_stream.size <= header->data_size);
+
+        out_mesh->header = *header;
+
+        out_mesh->submesh_array = new (std::nothrow) MeshSubmesh[submesh_count];
+        DD_ASSERT(out_mesh->submesh_array != nullptr);
+        ::memcpy(out_mesh->submesh_array, file.GetViewAs<MeshSubmesh>(sizeof(MeshHeader)), sizeof(MeshSubmesh) * submesh_count);
+
+        /* The data region is already in buffer layout, one copy fills every buffer */
+        out_mesh->memory_pool = new (std::nothrow) vk::MemoryPool();
+        DD_ASSERT(out_mesh->memory_pool != nullptr);
+
+        const vk::MemoryPoolInfo memory_pool_info = {
+            .size = util::AlignUp(header->data_size, vk::Context::TargetMemoryPoolAlignment),
+            .vk_memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            .import_memory = nullptr
+        };
+        out_mesh->memory_pool->Initialize(context, std::addressof(memory_pool_info));
+
+        /* Meshes cooked without optimization are reordered in a heap copy, the pool may be write combined */
+        const void *data = file.GetViewAs<u8>(header->data_offset);
+        u8 *optimized_data = nullptr;
+        if ((header->flags & MeshFlag_Optimized) == 0) {
+            optimized_data = new (std::nothrow) u8[header->data_size];
+            DD_ASSERT(optimized_data != nullptr);
+            ::memcpy(optimized_data, data, header->data_size);
+
+            OptimizeMeshInfo optimize_mesh_info = {};
+            optimize_mesh_info.SetDefaults();
+            OptimizeMeshData(std::addressof(out_mesh->header), out_mesh->submesh_array, optimized_data, std::addressof(optimize_mesh_info), nullptr);
+            data = optimized_data;
+        }
+
+        void *mapped_data = out_mesh->memory_pool->Map();
+        ::memcpy(mapped_data, data, header->data_size);
+        out_mesh->memory_pool->Unmap();
+
+        if (optimized_data != nullptr) {
+            delete[] optimized_data;
+        }
+
+        file.Finalize();
+
+        /* Create buffers */
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            out_mesh->stream_buffer_array[i] = nullptr;
+            if (out_mesh->HasAttribute(static_cast<MeshAttribute>(i)) == false) { continue; }
+
+            DD_ASSERT(out_mesh->header.stream_array[i].offset + out_mesh->header.stream_array[i].size <= out_mesh->header.data_size);
+            out_mesh->stream_buffer_array[i] = CreateMeshBuffer(context, out_mesh->memory_pool, std::addressof(out_mesh->header.stream_array[i]), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        }
+        out_mesh->index_buffer = CreateMeshBuffer(context, out_mesh->memory_pool, std::addressof(out_mesh->header.index_stream), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    void FreeMesh(const vk::Context *context, Mesh *mesh) {
+
+        if (mesh->index_buffer != nullptr) {
+            mesh->index_buffer->Finalize(context);
+            delete mesh->index_buffer;
+        }
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            if (mesh->stream_buffer_array[i] == nullptr) { continue; }
+            mesh->stream_buffer_array[i]->Finalize(context);
+            delete mesh->stream_buffer_array[i];
+        }
+        if (mesh->memory_pool != nullptr) {
+            mesh->memory_pool->Finalize(context);
+            delete mesh->memory_pool;
+        }
+        if (mesh->submesh_array != nullptr) {
+            delete[] mesh->submesh_array;
+        }
+        *mesh = {};
+    }
+
+    u32 SelectMeshLod(const MeshHeader *header, float distance, const util::PerspectiveProjection *projection, float viewport_height, float max_pixel_error) {
+
+        /* Inside the bounds every error is visible */
+        if (distance <= 0.0f) { return 0; }
+
+        /* Lod errors only grow, the first lod over budget ends the search */
+        const float pixels_per_unit = projection->GetProjectedScale(viewport_height) / distance;
+        u32 lod = 0;
+        for (u32 i = 1; i < header->lod_count; ++i) {
+            if (max_pixel_error < header->lod_array[i].error * pixels_per_unit) { break; }
+            lod = i;
+        }
+        return lod;
+    }
+}
@@ -0,0 +1,345 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        void WriteMeshData(Handle file, const void *data, u64 size) {
+            DD_ASSERT(size <= 0xffff'ffff);
+
+            long unsigned int size_written = 0;
+            const bool result = ::WriteFile(file, data, static_cast<u32>(size), std::addressof(size_written), nullptr);
+            DD_ASSERT(result == true && size_written == size);
+        }
+
+        void WriteMeshPadding(Handle file, u64 offset) {
+            constexpr u8 zero_array[MeshDataAlignment] = {};
+            const u64 padding = util::AlignUp(offset, MeshDataAlignment) - offset;
+            if (padding != 0) {
+                WriteMeshData(file, zero_array, padding);
+            }
+        }
+
+        /* Round to nearest even, overflow saturates to infinity and nan stays nan */
+        u16 FloatToHalf(float value) {
+            u32 bits = 0;
+            ::memcpy(std::addressof(bits), std::addressof(value), sizeof(u32));
+
+            const u32 sign = (bits >> 16) & 0x8000;
+            u32 magnitude  = bits & 0x7fff'ffff;
+
+            if (0x4780'0000 <= magnitude) {
+                return static_cast<u16>(sign | ((0x7f80'0000 < magnitude) ? 0x7e00 : 0x7c00));
+            }
+
+            /* Subnormals, adding 0.5 lets the fpu round the shifted mantissa */
+            if (magnitude < 0x3880'0000) {
+                float shifted = 0.0f;
+                ::memcpy(std::addressof(shifted), std::addressof(magnitude), sizeof(u32));
+                shifted += 0.5f;
+
+                u32 shifted_bits = 0;
+                ::memcpy(std::addressof(shifted_bits), std::addressof(shifted), sizeof(u32));
+                return static_cast<u16>(sign | (shifted_bits - 0x3f00'0000));
+            }
+
+            const u32 mantissa_odd = (magnitude >> 13) & 1;
+            magnitude += 0xc800'0fff + mantissa_odd; /* Rebias exponent from 127 to 15 and round */
+            return static_cast<u16>(sign | (magnitude >> 13));
+        }
+
+        inline s16 FloatToSnorm16(float value) {
+            const float clamped = std::min(std::max(value, -1.0f), 1.0f);
+            return static_cast<s16>(::lroundf(clamped * 32767.0f));
+        }
+
+        void CalculateBounds(MeshBounds *out_bounds, const float *position_array, const u32 *index_array, u32 index_count) {
+
+            /* Bounding sphere is centered on the box, it is loose but never misses a vertex */
+            if (index_count == 0) {
+                *out_bounds = {};
+                return;
+            }
+
+            const float *first_position = position_array + index_array[0] * 3;
+            float aabb_min[3] = { first_position[0], first_position[1], first_position[2] };
+            float aabb_max[3] = { first_position[0], first_position[1], first_position[2] };
+            for (u32 i = 1; i < index_count; ++i) {
+                const float *position = position_array + index_array[i] * 3;
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    aabb_min[axis] = std::min(aabb_min[axis], position[axis]);
+                    aabb_max[axis] = std::max(aabb_max[axis], position[axis]);
+                }
+            }
+
+            float center[3] = {};
+            for (u32 axis = 0; axis < 3; ++axis) {
+                center[axis] = (aabb_min[axis] + aabb_max[axis]) * 0.5f;
+            }
+
+            float radius_squared = 0.0f;
+            for (u32 i = 0; i < index_count; ++i) {
+                const float *position = position_array + index_array[i] * 3;
+                const float dx = position[0] - center[0];
+                const float dy = position[1] - center[1];
+                const float dz = position[2] - center[2];
+                radius_squared = std::max(radius_squared, dx * dx + dy * dy + dz * dz);
+            }
+
+            for (u32 axis = 0; axis < 3; ++axis) {
+                out_bounds->aabb_min[axis]      = aabb_min[axis];
+                out_bounds->aabb_max[axis]      = aabb_max[axis];
+                out_bounds->sphere_center[axis] = center[axis];
+            }
+            out_bounds->sphere_radius = ::sqrtf(radius_squared);
+        }
+
+        /* Encodes one attribute into a new[] stream */
+        u8 *EncodeMeshStream(MeshStream *out_stream, const SourceMesh *source_mesh, MeshAttribute attribute, const CookMeshInfo *cook_mesh_info, const MeshHeader *header) {
+            const u32 vertex_count = source_mesh->vertex_count;
+
+            u8 *stream = nullptr;
+            switch (attribute) {
+                case MeshAttribute_Position:
+                {
+                    if (cook_mesh_info->is_position_quantized == false) {
+                        *out_stream = { .size = vertex_count * sizeof(float) * 3, .vk_format = VK_FORMAT_R32G32B32_SFLOAT, .stride = sizeof(float) * 3 };
+                        stream = new (std::nothrow) u8[out_stream->size];
+                        DD_ASSERT(stream != nullptr);
+                        ::memcpy(stream, source_mesh->position_array, out_stream->size);
+                        break;
+                    }
+
+                    /* Four components keep the stride aligned, w is one */
+                    *out_stream = { .size = vertex_count * sizeof(s16) * 4, .vk_format = VK_FORMAT_R16G16B16A16_SNORM, .stride = sizeof(s16) * 4 };
+                    stream = new (std::nothrow) u8[out_stream->size];
+                    DD_ASSERT(stream != nullptr);
+
+                    s16 *snorm_array = reinterpret_cast<s16*>(stream);
+                    for (u32 i = 0; i < vertex_count; ++i) {
+                        for (u32 axis = 0; axis < 3; ++axis) {
+                            snorm_array[i * 4 + axis] = FloatToSnorm16((source_mesh->position_array[i * 3 + axis] - header->position_offset[axis]) / header->position_scale[axis]);
+                        }
+                        snorm_array[i * 4 + 3] = 32767;
+                    }
+                    break;
+                }
+                case MeshAttribute_Normal:
+                {
+                    if (source_mesh->normal_array == nullptr) { *out_stream = {}; break; }
+
+                    if (cook_mesh_info->is_normal_quantized == false) {
+                        *out_stream = { .size = vertex_count * sizeof(float) * 3, .vk_format = VK_FORMAT_R32G32B32_SFLOAT, .stride = sizeof(float) * 3 };
+                        stream = new (std::nothrow) u8[out_stream->size];
+                        DD_ASSERT(stream != nullptr);
+                        ::memcpy(stream, source_mesh->normal_array, out_stream->size);
+                        break;
+                    }
+
+                    *out_stream = { .size = vertex_count * sizeof(s16) * 4, .vk_format = VK_FORMAT_R16G16B16A16_SNORM, .stride = sizeof(s16) * 4 };
+                    stream = new (std::nothrow) u8[out_stream->size];
+                    DD_ASSERT(stream != nullptr);
+
+                    s16 *snorm_array = reinterpret_cast<s16*>(stream);
+                    for (u32 i = 0; i < vertex_count; ++i) {
+                        for (u32 axis = 0; axis < 3; ++axis) {
+                            snorm_array[i * 4 + axis] = FloatToSnorm16(source_mesh->normal_array[i * 3 + axis]);
+                        }
+                        snorm_array[i * 4 + 3] = 0;
+                    }
+                    break;
+                }
+                case MeshAttribute_TexCoord:
+                {
+                    if (source_mesh->texcoord_array == nullptr) { *out_stream = {}; break; }
+
+                    if (cook_mesh_info->is_texcoord_half == false) {
+                        *out_stream = { .size = vertex_count * sizeof(float) * 2, .vk_format = VK_FORMAT_R32G32_SFLOAT, .stride = sizeof(float) * 2 };
+                        stream = new (std::nothrow) u8[out_stream->size];
+                        DD_ASSERT(stream != nullptr);
+                        ::memcpy(stream, source_mesh->texcoord_array, out_stream->size);
+                        break;
+                    }
+
+                    *out_stream = { .size = vertex_count * sizeof(u16) * 2, .vk_format = VK_FORMAT_R16G16_SFLOAT, .stride = sizeof(u16) * 2 };
+                    stream = new (std::nothrow) u8[out_stream->size];
+                    DD_ASSERT(stream != nullptr);
+
+                    u16 *half_array = reinterpret_cast<u16*>(stream);
+                    for (u32 i = 0; i < vertex_count * 2; ++i) {
+                        half_array[i] = FloatToHalf(source_mesh->texcoord_array[i]);
+                    }
+                    break;
+                }
+                default:
+                    DD_ASSERT(false);
+            }
+            return stream;
+        }
+    }
+
+    void WriteMesh(const char *mesh_path, const SourceMesh *source_mesh, const SourceMeshLods *source_lods, const CookMeshInfo *cook_mesh_info) {
+        DD_ASSERT(source_mesh->vertex_count != 0 && source_mesh->index_count != 0 && source_mesh->submesh_count != 0);
+
+        const u32 lod_count     = 1 + ((source_lods != nullptr) ? source_lods->lod_count : 0);
+        const u32 index_count   = source_mesh->index_count + ((source_lods != nullptr) ? source_lods->index_count : 0);
+        const u32 submesh_count = source_mesh->submesh_count * lod_count;
+        DD_ASSERT(lod_count <= MaxMeshLods);
+
+        MeshHeader header = {
+            .magic         = MeshMagic,
+            .version       = MeshVersion,
+            .vertex_count  = source_mesh->vertex_count,
+            .index_count   = index_count,
+            .submesh_count = source_mesh->submesh_count,
+            .lod_count     = lod_count,
+        };
+        header.flags |= (cook_mesh_info->is_position_quantized == true)                                       ? MeshFlag_QuantizedPosition : MeshFlag_None;
+        header.flags |= (cook_mesh_info->is_normal_quantized == true && source_mesh->normal_array != nullptr) ? MeshFlag_QuantizedNormal   : MeshFlag_None;
+        header.flags |= (cook_mesh_info->is_texcoord_half == true && source_mesh->texcoord_array != nullptr)  ? MeshFlag_HalfTexCoord      : MeshFlag_None;
+        header.flags |= (cook_mesh_info->is_optimized == true)                                                ? MeshFlag_Optimized         : MeshFlag_None;
+
+        /* Bounds */
+        CalculateBounds(std::addressof(header.bounds), source_mesh->position_array, source_mesh->index_array, source_mesh->index_count);
+
+        /* Lods past lod 0 follow it in the index stream */
+        header.lod_array[0] = { .index_offset = 0, .index_count = source_mesh->index_count };
+        for (u32 i = 1; i < lod_count; ++i) {
+            const MeshLod *source_lod = std::addressof(source_lods->lod_array[i - 1]);
+            header.lod_array[i] = {
+                .index_offset = source_mesh->index_count + source_lod->index_offset,
+                .index_count  = source_lod->index_count,
+                .error        = source_lod->error,
+            };
+        }
+
+        MeshSubmesh *submesh_array = new (std::nothrow) MeshSubmesh[submesh_count];
+        DD_ASSERT(submesh_array != nullptr);
+        for (u32 i = 0; i < submesh_count; ++i) {
+            const bool           is_lod_0           = i < source_mesh->submesh_count;
+            const SourceSubmesh *source_submesh     = (is_lod_0 == true) ? std::addressof(source_mesh->submesh_array[i]) : std::addressof(source_lods->submesh_array[i - source_mesh->submesh_count]);
+            const u32           *source_index_array = (is_lod_0 == true) ? source_mesh->index_array : source_lods->index_array;
+            const u32            index_offset       = (is_lod_0 == true) ? 0 : source_mesh->index_count;
+            DD_ASSERT(index_offset + source_submesh->index_offset + source_submesh->index_count <= index_count);
+
+            submesh_array[i] = {
+                .index_offset  = index_offset + source_submesh->index_offset,
+                .index_count   = source_submesh->index_count,
+                .material_hash = source_submesh->material_hash,
+            };
+            CalculateBounds(std::addressof(submesh_array[i].bounds), source_mesh->position_array, source_index_array + source_submesh->index_offset, source_submesh->index_count);
+        }
+
+        /* Quantized positions map the box onto the unit cube, flat axes keep a scale of 1 */
+        for (u32 axis = 0; axis < 3; ++axis) {
+            const float half_extent = (header.bounds.aabb_max[axis] - header.bounds.aabb_min[axis]) * 0.5f;
+            header.position_offset[axis] = (cook_mesh_info->is_position_quantized == true) ? header.bounds.sphere_center[axis] : 0.0f;
+            header.position_scale[axis]  = (cook_mesh_info->is_position_quantized == true && 0.0f < half_extent) ? half_extent : 1.0f;
+        }
+
+        /* Encode streams */
+        u8 *stream_data_array[MeshAttribute_Count] = {};
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            stream_data_array[i] = EncodeMeshStream(std::addressof(header.stream_array[i]), source_mesh, static_cast<MeshAttribute>(i), cook_mesh_info, std::addressof(header));
+        }
+
+        /* Small meshes take 16 bit indices */
+        const bool is_index_16 = source_mesh->vertex_count <= 0x1'0000;
+        header.vk_index_type = (is_index_16 == true) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        header.index_stream  = { .size = index_count * ((is_index_16 == true) ? sizeof(u16) : sizeof(u32)), .stride = (is_index_16 == true) ? static_cast<u32>(sizeof(u16)) : static_cast<u32>(sizeof(u32)) };
+
+        u16 *index_16_array = nullptr;
+        u32 *index_32_array = nullptr;
+        if (is_index_16 == true) {
+            index_16_array = new (std::nothrow) u16[index_count];
+            DD_ASSERT(index_16_array != nullptr);
+            for (u32 i = 0; i < index_count; ++i) {
+                index_16_array[i] = static_cast<u16>((i < source_mesh->index_count) ? source_mesh->index_array[i] : source_lods->index_array[i - source_mesh->index_count]);
+            }
+        } else if (lod_count != 1) {
+            index_32_array = new (std::nothrow) u32[index_count];
+            DD_ASSERT(index_32_array != nullptr);
+            ::memcpy(index_32_array, source_mesh->index_array, sizeof(u32) * source_mesh->index_count);
+            ::memcpy(index_32_array + source_mesh->index_count, source_lods->index_array, sizeof(u32) * source_lods->index_count);
+        }
+
+        /* Layout */
+        header.data_offset = util::AlignUp(sizeof(MeshHeader) + sizeof(MeshSubmesh) * submesh_count, MeshDataAlignment);
+        u64 offset = 0;
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            header.stream_array[i].offset = offset;
+            offset = util::AlignUp(offset + header.stream_array[i].size, MeshDataAlignment);
+        }
+        header.index_stream.offset = offset;
+        header.data_size           = util::AlignUp(offset + header.index_stream.size, MeshDataAlignment);
+
+        /* Write */
+        Handle mesh_file = ::CreateFile(mesh_path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        DD_ASSERT(mesh_file != INVALID_HANDLE_VALUE);
+
+        WriteMeshData(mesh_file, std::addressof(header), sizeof(MeshHeader));
+        WriteMeshData(mesh_file, submesh_array, sizeof(MeshSubmesh) * submesh_count);
+        WriteMeshPadding(mesh_file, sizeof(MeshHeader) + sizeof(MeshSubmesh) * submesh_count);
+
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            if (stream_data_array[i] == nullptr) { continue; }
+            WriteMeshData(mesh_file, stream_data_array[i], header.stream_array[i].size);
+            WriteMeshPadding(mesh_file, header.stream_array[i].offset + header.stream_array[i].size);
+        }
+
+        const void *index_data = (is_index_16 == true) ? static_cast<const void*>(index_16_array) : (index_32_array != nullptr) ? static_cast<const void*>(index_32_array) : static_cast<const void*>(source_mesh->index_array);
+        WriteMeshData(mesh_file, index_data, header.index_stream.size);
+        WriteMeshPadding(mesh_file, header.index_stream.offset + header.index_stream.size);
+
+        ::CloseHandle(mesh_file);
+
+        if (index_16_array != nullptr) {
+            delete[] index_16_array;
+        }
+        if (index_32_array != nullptr) {
+            delete[] index_32_array;
+        }
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            if (stream_data_array[i] != nullptr) {
+                delete[] stream_data_array[i];
+            }
+        }
+        delete[] submesh_array;
+    }
+
+    void CookMesh(const char *mesh_path, const char *source_path, const CookMeshInfo *cook_mesh_info, MeshOptimizeStats *out_optimize_stats) {
+
+        /* Only obj is supported for now */
+        const size_t length = ::strlen(source_path);
+        DD_ASSERT(4 <= length && ::strcmp(source_path + length - 4, ".obj") == 0);
+
+        SourceMesh source_mesh = {};
+        ImportObj(source_path, std::addressof(source_mesh));
+        if (cook_mesh_info->is_optimized == true) {
+            OptimizeSourceMesh(std::addressof(source_mesh), std::addressof(cook_mesh_info->optimize_mesh_info), out_optimize_stats);
+        }
+
+        /* Lods index the optimized vertices, so they are generated last */
+        SourceMeshLods source_lods = {};
+        GenerateMeshLods(std::addressof(source_lods), std::addressof(source_mesh), std::addressof(cook_mesh_info->mesh_lod_info));
+
+        WriteMesh(mesh_path, std::addressof(source_mesh), std::addressof(source_lods), cook_mesh_info);
+        FreeSourceMeshLods(std::addressof(source_lods));
+        FreeSourceMesh(std::addressof(source_mesh));
+    }
+}
@@ -0,0 +1,534 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace impl {
+
+        void BuildVertexAdjacency(VertexAdjacency *out_adjacency, const u32 *index_array, u32 index_count, u32 vertex_count) {
+
+            out_adjacency->offset_array = new (std::nothrow) u32[vertex_count + 1];
+            DD_ASSERT(out_adjacency->offset_array != nullptr);
+            out_adjacency->triangle_array = new (std::nothrow) u32[index_count];
+            DD_ASSERT(out_adjacency->triangle_array != nullptr);
+            out_adjacency->live_count_array = new (std::nothrow) u32[vertex_count];
+            DD_ASSERT(out_adjacency->live_count_array != nullptr);
+
+            u32 *live_count_array = out_adjacency->live_count_array;
+            u32 *offset_array     = out_adjacency->offset_array;
+            ::memset(live_count_array, 0, sizeof(u32) * vertex_count);
+            for (u32 i = 0; i < index_count; ++i) {
+                DD_ASSERT(index_array[i] < vertex_count);
+                ++live_count_array[index_array[i]];
+            }
+
+            offset_array[0] = 0;
+            for (u32 i = 0; i < vertex_count; ++i) {
+                offset_array[i + 1] = offset_array[i] + live_count_array[i];
+            }
+
+            /* Fill using the offsets as write cursors, then shift them back */
+            for (u32 i = 0; i < index_count; ++i) {
+                out_adjacency->triangle_array[offset_array[index_array[i]]] = i / 3;
+                ++offset_array[index_array[i]];
+            }
+            for (u32 i = vertex_count; 0 < i; --i) {
+                offset_array[i] = offset_array[i - 1];
+            }
+            offset_array[0] = 0;
+        }
+
+        void FreeVertexAdjacency(VertexAdjacency *adjacency) {
+            delete[] adjacency->offset_array;
+            delete[] adjacency->triangle_array;
+            delete[] adjacency->live_count_array;
+        }
+    }
+
+    namespace {
+
+        constexpr u32 InvalidVertex = 0xffff'ffff;
+
+        /* Fifo cache, a vertex is resident until cache_size misses follow its own */
+        inline bool IsCacheMiss(u32 *cache_time_array, u32 *time, u32 vertex, u32 cache_size) {
+            if ((*time - cache_time_array[vertex]) <= cache_size) { return false; }
+            cache_time_array[vertex] = *time;
+            *time += 1;
+            return true;
+        }
+
+        int CompareVertexAttributes(const SourceMesh *source_mesh, u32 lhs, u32 rhs) {
+            int result = ::memcmp(source_mesh->position_array + lhs * 3, source_mesh->position_array + rhs * 3, sizeof(float) * 3);
+            if (result == 0 && source_mesh->normal_array != nullptr) {
+                result = ::memcmp(source_mesh->normal_array + lhs * 3, source_mesh->normal_array + rhs * 3, sizeof(float) * 3);
+            }
+            if (result == 0 && source_mesh->texcoord_array != nullptr) {
+                result = ::memcmp(source_mesh->texcoord_array + lhs * 2, source_mesh->texcoord_array + rhs * 2, sizeof(float) * 2);
+            }
+            return result;
+        }
+
+        void RemapSourceAttribute(float **attribute_array, u32 component_count, u32 vertex_count, const u32 *remap_array) {
+            if (*attribute_array == nullptr) { return; }
+
+            float *remapped_array = new (std::nothrow) float[vertex_count * component_count];
+            DD_ASSERT(remapped_array != nullptr);
+            RemapVertexStream(remapped_array, *attribute_array, sizeof(float) * component_count, vertex_count, remap_array);
+
+            delete[] *attribute_array;
+            *attribute_array = remapped_array;
+        }
+    }
+
+    void AnalyzeVertexCache(VertexCacheStats *out_stats, const u32 *index_array, u32 index_count, u32 vertex_count, u32 cache_size) {
+        DD_ASSERT((index_count % 3) == 0);
+
+        u32 *cache_time_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(cache_time_array != nullptr);
+        ::memset(cache_time_array, 0, sizeof(u32) * vertex_count);
+
+        /* Never transformed vertices still read as a time of 0 */
+        u32 time                = cache_size + 1;
+        u32 transform_count     = 0;
+        u32 unique_vertex_count = 0;
+        for (u32 i = 0; i < index_count; ++i) {
+            const u32 vertex = index_array[i];
+            DD_ASSERT(vertex < vertex_count);
+            unique_vertex_count += (cache_time_array[vertex] == 0) ? 1 : 0;
+            transform_count     += (IsCacheMiss(cache_time_array, std::addressof(time), vertex, cache_size) == true) ? 1 : 0;
+        }
+
+        delete[] cache_time_array;
+
+        out_stats->transform_count     = transform_count;
+        out_stats->triangle_count      = index_count / 3;
+        out_stats->unique_vertex_count = unique_vertex_count;
+        out_stats->acmr                = (index_count != 0)         ? static_cast<float>(transform_count) / static_cast<float>(index_count / 3) : 0.0f;
+        out_stats->atvr                = (unique_vertex_count != 0) ? static_cast<float>(transform_count) / static_cast<float>(unique_vertex_count) : 0.0f;
+    }
+
+    void OptimizeVertexCache(u32 *out_index_array, const u32 *index_array, u32 index_count, u32 vertex_count, u32 cache_size) {
+        DD_ASSERT((index_count % 3) == 0 && out_index_array != index_array);
+        if (index_count == 0) { return; }
+
+        const u32 triangle_count = index_count / 3;
+
+        impl::VertexAdjacency adjacency = {};
+        impl::BuildVertexAdjacency(std::addressof(adjacency), index_array, index_count, vertex_count);
+        u32 *live_count_array = adjacency.live_count_array;
+
+        u32 *cache_time_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(cache_time_array != nullptr);
+        ::memset(cache_time_array, 0, sizeof(u32) * vertex_count);
+
+        /* Every emitted index is pushed once, so both stacks are bounded by the index count */
+        u32 *dead_end_stack = new (std::nothrow) u32[index_count];
+        DD_ASSERT(dead_end_stack != nullptr);
+        u32 *candidate_array = new (std::nothrow) u32[index_count];
+        DD_ASSERT(candidate_array != nullptr);
+        bool *is_emitted_array = new (std::nothrow) bool[triangle_count];
+        DD_ASSERT(is_emitted_array != nullptr);
+        ::memset(is_emitted_array, 0, sizeof(bool) * triangle_count);
+
+        u32 time           = cache_size + 1;
+        u32 cursor         = 0;
+        u32 dead_end_count = 0;
+        u32 output_count   = 0;
+        u32 fan_vertex     = 0;
+        while (fan_vertex != InvalidVertex) {
+
+            /* Emit every remaining triangle around the fan vertex */
+            u32 candidate_count = 0;
+            for (u32 i = adjacency.offset_array[fan_vertex]; i < adjacency.offset_array[fan_vertex + 1]; ++i) {
+                const u32 triangle = adjacency.triangle_array[i];
+                if (is_emitted_array[triangle] == true) { continue; }
+
+                for (u32 corner = 0; corner < 3; ++corner) {
+                    const u32 vertex = index_array[triangle * 3 + corner];
+                    out_index_array[output_count] = vertex;
+                    ++output_count;
+                    dead_end_stack[dead_end_count] = vertex;
+                    ++dead_end_count;
+                    candidate_array[candidate_count] = vertex;
+                    ++candidate_count;
+                    --live_count_array[vertex];
+                    IsCacheMiss(cache_time_array, std::addressof(time), vertex, cache_size);
+                }
+                is_emitted_array[triangle] = true;
+            }
+
+            /* Prefer the oldest candidate that will still be resident after its own remaining triangles */
+            u32 next_vertex   = InvalidVertex;
+            s64 best_priority = -1;
+            for (u32 i = 0; i < candidate_count; ++i) {
+                const u32 vertex = candidate_array[i];
+                if (live_count_array[vertex] == 0) { continue; }
+
+                const u32 age      = time - cache_time_array[vertex];
+                const s64 priority = (age + 2 * live_count_array[vertex] <= cache_size) ? age : 0;
+                if (best_priority < priority) {
+                    best_priority = priority;
+                    next_vertex   = vertex;
+                }
+            }
+
+            /* Dead end, fall back to recently used vertices and then to input order */
+            while (next_vertex == InvalidVertex && dead_end_count != 0) {
+                --dead_end_count;
+                if (live_count_array[dead_end_stack[dead_end_count]] != 0) {
+                    next_vertex = dead_end_stack[dead_end_count];
+                }
+            }
+            while (next_vertex == InvalidVertex && cursor < vertex_count) {
+                if (live_count_array[cursor] != 0) {
+                    next_vertex = cursor;
+                }
+                ++cursor;
+            }
+            fan_vertex = next_vertex;
+        }
+        DD_ASSERT(output_count == index_count);
+
+        delete[] is_emitted_array;
+        delete[] candidate_array;
+        delete[] dead_end_stack;
+        delete[] cache_time_array;
+        impl::FreeVertexAdjacency(std::addressof(adjacency));
+    }
+
+    void OptimizeOverdraw(u32 *out_index_array, const u32 *index_array, u32 index_count, const float *position_array, u32 vertex_count, u32 cache_size, float threshold) {
+        DD_ASSERT((index_count % 3) == 0 && out_index_array != index_array);
+        if (index_count == 0) { return; }
+
+        const u32 triangle_count = index_count / 3;
+
+        VertexCacheStats mesh_stats = {};
+        AnalyzeVertexCache(std::addressof(mesh_stats), index_array, index_count, vertex_count, cache_size);
+
+        u32 *cache_time_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(cache_time_array != nullptr);
+        ::memset(cache_time_array, 0, sizeof(u32) * vertex_count);
+        u32 *cluster_start_array = new (std::nothrow) u32[triangle_count + 1];
+        DD_ASSERT(cluster_start_array != nullptr);
+
+        /* Split into clusters, a split that is not a natural cache restart flushes the cache since the clusters may be reordered */
+        u32 time                    = cache_size + 1;
+        u32 cluster_count           = 0;
+        u32 cluster_transform_count = 0;
+        u32 cluster_triangle_count  = 0;
+        for (u32 i = 0; i < triangle_count; ++i) {
+            const bool is_soft_split = cluster_triangle_count != 0 && static_cast<float>(cluster_transform_count) <= threshold * mesh_stats.acmr * static_cast<float>(cluster_triangle_count);
+            if (is_soft_split == true) {
+                time += cache_size + 1;
+            }
+
+            u32 miss_count = 0;
+            for (u32 corner = 0; corner < 3; ++corner) {
+                miss_count += (IsCacheMiss(cache_time_array, std::addressof(time), index_array[i * 3 + corner], cache_size) == true) ? 1 : 0;
+            }
+
+            if (i == 0 || is_soft_split == true || miss_count == 3) {
+                cluster_start_array[cluster_count] = i;
+                ++cluster_count;
+                cluster_transform_count = 0;
+                cluster_triangle_count  = 0;
+            }
+            cluster_transform_count += miss_count;
+            cluster_triangle_count  += 1;
+        }
+        cluster_start_array[cluster_count] = triangle_count;
+
+        /* Area weighted centroid and normal of every cluster */
+        float *cluster_data_array = new (std::nothrow) float[cluster_count * 7];
+        DD_ASSERT(cluster_data_array != nullptr);
+        ::memset(cluster_data_array, 0, sizeof(float) * cluster_count * 7);
+
+        float mesh_centroid[3] = {};
+        float mesh_area        = 0.0f;
+        for (u32 cluster = 0; cluster < cluster_count; ++cluster) {
+            float *cluster_data = cluster_data_array + cluster * 7;
+            for (u32 i = cluster_start_array[cluster]; i < cluster_start_array[cluster + 1]; ++i) {
+                const float *p0 = position_array + index_array[i * 3 + 0] * 3;
+                const float *p1 = position_array + index_array[i * 3 + 1] * 3;
+                const float *p2 = position_array + index_array[i * 3 + 2] * 3;
+
+                const float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                const float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                const float normal[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+                const float area = ::sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    const float centroid = (p0[axis] + p1[axis] + p2[axis]) * (1.0f / 3.0f);
+                    cluster_data[axis]     += centroid * area;
+                    cluster_data[axis + 3] += normal[axis];
+                    mesh_centroid[axis]    += centroid * area;
+                }
+                cluster_data[6] += area;
+                mesh_area       += area;
+            }
+        }
+        for (u32 axis = 0; axis < 3; ++axis) {
+            mesh_centroid[axis] = (0.0f < mesh_area) ? mesh_centroid[axis] / mesh_area : 0.0f;
+        }
+
+        /* Clusters far out along their own normal are likely occluders, draw them first */
+        float *sort_key_array = new (std::nothrow) float[cluster_count];
+        DD_ASSERT(sort_key_array != nullptr);
+        u32 *cluster_order_array = new (std::nothrow) u32[cluster_count];
+        DD_ASSERT(cluster_order_array != nullptr);
+        for (u32 cluster = 0; cluster < cluster_count; ++cluster) {
+            const float *cluster_data  = cluster_data_array + cluster * 7;
+            const float  area          = cluster_data[6];
+            const float  normal_length = ::sqrtf(cluster_data[3] * cluster_data[3] + cluster_data[4] * cluster_data[4] + cluster_data[5] * cluster_data[5]);
+
+            float key = 0.0f;
+            if (0.0f < area && 0.0f < normal_length) {
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    key += (cluster_data[axis] / area - mesh_centroid[axis]) * (cluster_data[axis + 3] / normal_length);
+                }
+            }
+            sort_key_array[cluster]      = key;
+            cluster_order_array[cluster] = cluster;
+        }
+        std::stable_sort(cluster_order_array, cluster_order_array + cluster_count, [sort_key_array](u32 lhs, u32 rhs) { return sort_key_array[rhs] < sort_key_array[lhs]; });
+
+        u32 output_count = 0;
+        for (u32 i = 0; i < cluster_count; ++i) {
+            const u32 cluster     = cluster_order_array[i];
+            const u32 index_begin = cluster_start_array[cluster] * 3;
+            const u32 index_end   = cluster_start_array[cluster + 1] * 3;
+            ::memcpy(out_index_array + output_count, index_array + index_begin, sizeof(u32) * (index_end - index_begin));
+            output_count += index_end - index_begin;
+        }
+
+        delete[] cluster_order_array;
+        delete[] sort_key_array;
+        delete[] cluster_data_array;
+        delete[] cluster_start_array;
+        delete[] cache_time_array;
+    }
+
+    u32 BuildVertexFetchRemap(u32 *out_remap_array, u32 *index_array, u32 index_count, u32 vertex_count) {
+        ::memset(out_remap_array, 0xff, sizeof(u32) * vertex_count);
+
+        u32 next_vertex = 0;
+        for (u32 i = 0; i < index_count; ++i) {
+            const u32 vertex = index_array[i];
+            DD_ASSERT(vertex < vertex_count);
+            if (out_remap_array[vertex] == InvalidVertex) {
+                out_remap_array[vertex] = next_vertex;
+                ++next_vertex;
+            }
+            index_array[i] = out_remap_array[vertex];
+        }
+
+        const u32 referenced_count = next_vertex;
+        for (u32 i = 0; i < vertex_count; ++i) {
+            if (out_remap_array[i] == InvalidVertex) {
+                out_remap_array[i] = next_vertex;
+                ++next_vertex;
+            }
+        }
+        return referenced_count;
+    }
+
+    void RemapVertexStream(void *out_stream, const void *stream, u32 stride, u32 vertex_count, const u32 *remap_array) {
+        DD_ASSERT(out_stream != stream);
+
+        u8       *output = reinterpret_cast<u8*>(out_stream);
+        const u8 *input  = reinterpret_cast<const u8*>(stream);
+        for (u32 i = 0; i < vertex_count; ++i) {
+            ::memcpy(output + remap_array[i] * stride, input + i * stride, stride);
+        }
+    }
+
+    u32 WeldVertices(SourceMesh *source_mesh) {
+        const u32 vertex_count = source_mesh->vertex_count;
+
+        /* Sort so identical vertices are adjacent, ties keep index order so the first use is the representative */
+        u32 *order_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(order_array != nullptr);
+        u32 *remap_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(remap_array != nullptr);
+        for (u32 i = 0; i < vertex_count; ++i) {
+            order_array[i] = i;
+        }
+        std::sort(order_array, order_array + vertex_count, [source_mesh](u32 lhs, u32 rhs) {
+            const int result = CompareVertexAttributes(source_mesh, lhs, rhs);
+            return (result != 0) ? (result < 0) : (lhs < rhs);
+        });
+
+        u32 representative = 0;
+        for (u32 i = 0; i < vertex_count; ++i) {
+            if (i == 0 || CompareVertexAttributes(source_mesh, order_array[i - 1], order_array[i]) != 0) {
+                representative = order_array[i];
+            }
+            remap_array[order_array[i]] = representative;
+        }
+
+        /* Compact in place, representatives precede their duplicates so their new slot is already final */
+        u32 new_vertex_count = 0;
+        for (u32 i = 0; i < vertex_count; ++i) {
+            if (remap_array[i] != i) {
+                remap_array[i] = remap_array[remap_array[i]];
+                continue;
+            }
+            remap_array[i] = new_vertex_count;
+
+            ::memmove(source_mesh->position_array + new_vertex_count * 3, source_mesh->position_array + i * 3, sizeof(float) * 3);
+            if (source_mesh->normal_array != nullptr) {
+                ::memmove(source_mesh->normal_array + new_vertex_count * 3, source_mesh->normal_array + i * 3, sizeof(float) * 3);
+            }
+            if (source_mesh->texcoord_array != nullptr) {
+                ::memmove(source_mesh->texcoord_array + new_vertex_count * 2, source_mesh->texcoord_array + i * 2, sizeof(float) * 2);
+            }
+            ++new_vertex_count;
+        }
+
+        for (u32 i = 0; i < source_mesh->index_count; ++i) {
+            source_mesh->index_array[i] = remap_array[source_mesh->index_array[i]];
+        }
+        source_mesh->vertex_count = new_vertex_count;
+
+        delete[] remap_array;
+        delete[] order_array;
+        return new_vertex_count;
+    }
+
+    void OptimizeSourceMesh(SourceMesh *source_mesh, const OptimizeMeshInfo *optimize_mesh_info, MeshOptimizeStats *out_stats) {
+        const u32 index_count = source_mesh->index_count;
+        const u32 cache_size  = optimize_mesh_info->cache_size;
+
+        if (out_stats != nullptr) {
+            out_stats->source_vertex_count = source_mesh->vertex_count;
+            AnalyzeVertexCache(std::addressof(out_stats->before), source_mesh->index_array, index_count, source_mesh->vertex_count, cache_size);
+        }
+
+        if (optimize_mesh_info->is_welded == true) {
+            WeldVertices(source_mesh);
+        }
+
+        /* Reorder triangles within each submesh */
+        u32 *scratch_index_array = new (std::nothrow) u32[index_count];
+        DD_ASSERT(scratch_index_array != nullptr);
+        for (u32 i = 0; i < source_mesh->submesh_count; ++i) {
+            const SourceSubmesh *submesh = std::addressof(source_mesh->submesh_array[i]);
+            u32 *submesh_index_array = source_mesh->index_array + submesh->index_offset;
+            u32 *scratch_array       = scratch_index_array + submesh->index_offset;
+
+            OptimizeVertexCache(scratch_array, submesh_index_array, submesh->index_count, source_mesh->vertex_count, cache_size);
+            if (optimize_mesh_info->is_overdraw_optimized == true) {
+                OptimizeOverdraw(submesh_index_array, scratch_array, submesh->index_count, source_mesh->position_array, source_mesh->vertex_count, cache_size, optimize_mesh_info->overdraw_threshold);
+            } else {
+                ::memcpy(submesh_index_array, scratch_array, sizeof(u32) * submesh->index_count);
+            }
+        }
+        delete[] scratch_index_array;
+
+        /* Store vertices in the order the triangles fetch them */
+        u32 *remap_array = new (std::nothrow) u32[source_mesh->vertex_count];
+        DD_ASSERT(remap_array != nullptr);
+        const u32 referenced_count = BuildVertexFetchRemap(remap_array, source_mesh->index_array, index_count, source_mesh->vertex_count);
+
+        RemapSourceAttribute(std::addressof(source_mesh->position_array), 3, source_mesh->vertex_count, remap_array);
+        RemapSourceAttribute(std::addressof(source_mesh->normal_array),   3, source_mesh->vertex_count, remap_array);
+        RemapSourceAttribute(std::addressof(source_mesh->texcoord_array), 2, source_mesh->vertex_count, remap_array);
+        /* Unreferenced vertices were moved past the referenced count and are dropped */
+        source_mesh->vertex_count = referenced_count;
+
+        delete[] remap_array;
+
+        if (out_stats != nullptr) {
+            out_stats->vertex_count = source_mesh->vertex_count;
+            AnalyzeVertexCache(std::addressof(out_stats->after), source_mesh->index_array, index_count, source_mesh->vertex_count, cache_size);
+        }
+    }
+
+    void OptimizeMeshData(MeshHeader *header, const MeshSubmesh *submesh_array, void *data, const OptimizeMeshInfo *optimize_mesh_info, MeshOptimizeStats *out_stats) {
+        const u32  index_count  = header->index_count;
+        const u32  vertex_count = header->vertex_count;
+        const u32  cache_size   = optimize_mesh_info->cache_size;
+        const bool is_index_16  = header->vk_index_type == VK_INDEX_TYPE_UINT16;
+        u8 *data_bytes = reinterpret_cast<u8*>(data);
+
+        /* Widen indices */
+        u32 *index_array = new (std::nothrow) u32[index_count];
+        DD_ASSERT(index_array != nullptr);
+        u32 *scratch_index_array = new (std::nothrow) u32[index_count];
+        DD_ASSERT(scratch_index_array != nullptr);
+
+        u16 *index_16_array = reinterpret_cast<u16*>(data_bytes + header->index_stream.offset);
+        u32 *index_32_array = reinterpret_cast<u32*>(data_bytes + header->index_stream.offset);
+        for (u32 i = 0; i < index_count; ++i) {
+            index_array[i] = (is_index_16 == true) ? index_16_array[i] : index_32_array[i];
+        }
+
+        if (out_stats != nullptr) {
+            out_stats->source_vertex_count = vertex_count;
+            AnalyzeVertexCache(std::addressof(out_stats->before), index_array, index_count, vertex_count, cache_size);
+        }
+
+        /* Every lod is ordered, vertex fetch order follows lod 0 as it comes first */
+        for (u32 i = 0; i < header->submesh_count * header->lod_count; ++i) {
+            const MeshSubmesh *submesh = std::addressof(submesh_array[i]);
+            DD_ASSERT(submesh->index_offset + submesh->index_count <= index_count);
+
+            OptimizeVertexCache(scratch_index_array, index_array + submesh->index_offset, submesh->index_count, vertex_count, cache_size);
+            ::memcpy(index_array + submesh->index_offset, scratch_index_array, sizeof(u32) * submesh->index_count);
+        }
+
+        /* Permute every stream, unreferenced vertices stay at the end so stream sizes are unchanged */
+        u32 *remap_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(remap_array != nullptr);
+        const u32 referenced_count = BuildVertexFetchRemap(remap_array, index_array, index_count, vertex_count);
+
+        u64 max_stream_size = 0;
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            max_stream_size = std::max(max_stream_size, header->stream_array[i].size);
+        }
+        u8 *scratch_stream = new (std::nothrow) u8[max_stream_size];
+        DD_ASSERT(scratch_stream != nullptr);
+        for (u32 i = 0; i < MeshAttribute_Count; ++i) {
+            const MeshStream *stream = std::addressof(header->stream_array[i]);
+            if (stream->vk_format == VK_FORMAT_UNDEFINED) { continue; }
+            DD_ASSERT(stream->size == static_cast<u64>(stream->stride) * vertex_count);
+
+            ::memcpy(scratch_stream, data_bytes + stream->offset, stream->size);
+            RemapVertexStream(data_bytes + stream->offset, scratch_stream, stream->stride, vertex_count, remap_array);
+        }
+
+        /* Narrow indices */
+        for (u32 i = 0; i < index_count; ++i) {
+            if (is_index_16 == true) {
+                index_16_array[i] = static_cast<u16>(index_array[i]);
+            } else {
+                index_32_array[i] = index_array[i];
+            }
+        }
+        header->flags |= MeshFlag_Optimized;
+
+        if (out_stats != nullptr) {
+            out_stats->vertex_count = referenced_count;
+            AnalyzeVertexCache(std::addressof(out_stats->after), index_array, index_count, vertex_count, cache_size);
+        }
+
+        delete[] scratch_stream;
+        delete[] remap_array;
+        delete[] scratch_index_array;
+        delete[] index_array;
+    }
+}
@@ -0,0 +1,568 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        constexpr u32    InvalidVertex     = 0xffff'ffff;
+        constexpr u32    AttributeCount    = 5;
+        constexpr double BorderPlaneWeight = 10.0;
+
+        /* Cosine of the largest normal rotation one collapse may cause, about 75 degrees */
+        constexpr double MaxCollapseRotationCos = 0.25;
+
+        enum VertexKind : u8 {
+            VertexKind_Manifold = 0,
+            VertexKind_Border   = 1,
+            VertexKind_Locked   = 2,
+        };
+
+        /* Compared by bits so every vertex at a position lands in one group */
+        struct PositionKey {
+            u32 bit_array[3];
+
+            constexpr bool operator==(const PositionKey& rhs) const = default;
+        };
+
+        /* Sum of weighted squared plane distances as a symmetric matrix, vector and constant. weight is the triangle area behind it */
+        struct Quadric {
+            double a00, a01, a02, a11, a12, a22;
+            double b0, b1, b2;
+            double c;
+            double weight;
+        };
+
+        /*
+         * Attributes are linear over each triangle, a = dot(gradient, p) + offset. The squared gradient terms live in the
+         * position quadric, these are the terms linear in the attribute value so a collapse along a linear field costs nothing
+         */
+        struct AttributeQuadric {
+            double gradient_array[AttributeCount][3];
+            double offset_array[AttributeCount];
+            double weight;
+        };
+
+        /* Half edge collapse, from moves onto to and keeps its attributes */
+        struct Collapse {
+            u32    from;
+            u32    to;
+            double cost;
+        };
+
+        constexpr ALWAYS_INLINE u64 MakeEdgeKey(u32 lhs, u32 rhs) {
+            return (lhs < rhs) ? ((static_cast<u64>(lhs) << 32) | rhs) : ((static_cast<u64>(rhs) << 32) | lhs);
+        }
+
+        float CalculateExtent(const float *position_array, u32 vertex_count) {
+            if (vertex_count == 0) { return 0.0f; }
+
+            float aabb_min[3] = { position_array[0], position_array[1], position_array[2] };
+            float aabb_max[3] = { position_array[0], position_array[1], position_array[2] };
+            for (u32 i = 1; i < vertex_count; ++i) {
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    aabb_min[axis] = std::min(aabb_min[axis], position_array[i * 3 + axis]);
+                    aabb_max[axis] = std::max(aabb_max[axis], position_array[i * 3 + axis]);
+                }
+            }
+            return std::max(std::max(aabb_max[0] - aabb_min[0], aabb_max[1] - aabb_min[1]), aabb_max[2] - aabb_min[2]);
+        }
+
+        /* Unnormalized, its length is twice the triangle area */
+        inline void CalculateTriangleNormal(double *out_normal, const float *p0, const float *p1, const float *p2) {
+            const double e0[3] = { static_cast<double>(p1[0]) - p0[0], static_cast<double>(p1[1]) - p0[1], static_cast<double>(p1[2]) - p0[2] };
+            const double e1[3] = { static_cast<double>(p2[0]) - p0[0], static_cast<double>(p2[1]) - p0[1], static_cast<double>(p2[2]) - p0[2] };
+            out_normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+            out_normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+            out_normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+        }
+
+        /* normal must be unit length */
+        void AddPlaneQuadric(Quadric *quadric, const double *normal, double distance, double weight) {
+            quadric->a00 += weight * normal[0] * normal[0];
+            quadric->a01 += weight * normal[0] * normal[1];
+            quadric->a02 += weight * normal[0] * normal[2];
+            quadric->a11 += weight * normal[1] * normal[1];
+            quadric->a12 += weight * normal[1] * normal[2];
+            quadric->a22 += weight * normal[2] * normal[2];
+            quadric->b0  += weight * normal[0] * distance;
+            quadric->b1  += weight * normal[1] * distance;
+            quadric->b2  += weight * normal[2] * distance;
+            quadric->c   += weight * distance * distance;
+        }
+
+        void AddQuadric(Quadric *out_quadric, const Quadric *quadric) {
+            out_quadric->a00    += quadric->a00;
+            out_quadric->a01    += quadric->a01;
+            out_quadric->a02    += quadric->a02;
+            out_quadric->a11    += quadric->a11;
+            out_quadric->a12    += quadric->a12;
+            out_quadric->a22    += quadric->a22;
+            out_quadric->b0     += quadric->b0;
+            out_quadric->b1     += quadric->b1;
+            out_quadric->b2     += quadric->b2;
+            out_quadric->c      += quadric->c;
+            out_quadric->weight += quadric->weight;
+        }
+
+        double EvaluateQuadric(const Quadric *quadric, const float *position) {
+            const double x = position[0];
+            const double y = position[1];
+            const double z = position[2];
+            return quadric->a00 * x * x + quadric->a11 * y * y + quadric->a22 * z * z
+                 + 2.0 * (quadric->a01 * x * y + quadric->a02 * x * z + quadric->a12 * y * z)
+                 + 2.0 * (quadric->b0 * x + quadric->b1 * y + quadric->b2 * z)
+                 + quadric->c;
+        }
+
+        /* Absent attributes read as zero and cost nothing */
+        void GetVertexAttributes(double *out_attribute_array, const SourceMesh *source_mesh, u32 vertex) {
+            for (u32 i = 0; i < AttributeCount; ++i) {
+                out_attribute_array[i] = 0.0;
+            }
+            if (source_mesh->normal_array != nullptr) {
+                for (u32 i = 0; i < 3; ++i) {
+                    out_attribute_array[i] = source_mesh->normal_array[vertex * 3 + i];
+                }
+            }
+            if (source_mesh->texcoord_array != nullptr) {
+                for (u32 i = 0; i < 2; ++i) {
+                    out_attribute_array[3 + i] = source_mesh->texcoord_array[vertex * 2 + i];
+                }
+            }
+        }
+
+        /* Gradient of the linear function through the corner values, in the plane of the triangle. normal is unnormalized */
+        void AddAttributeGradients(Quadric *out_quadric, AttributeQuadric *out_attribute_quadric, const float *p0, const float *p1, const float *p2, const double *normal, const double (*attribute_array)[AttributeCount], double weight) {
+            const double e0[3] = { static_cast<double>(p1[0]) - p0[0], static_cast<double>(p1[1]) - p0[1], static_cast<double>(p1[2]) - p0[2] };
+            const double e1[3] = { static_cast<double>(p2[0]) - p0[0], static_cast<double>(p2[1]) - p0[1], static_cast<double>(p2[2]) - p0[2] };
+            const double length_squared = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+
+            /* cross(e1, n) and cross(n, e0) */
+            const double d0[3] = { e1[1] * normal[2] - e1[2] * normal[1], e1[2] * normal[0] - e1[0] * normal[2], e1[0] * normal[1] - e1[1] * normal[0] };
+            const double d1[3] = { normal[1] * e0[2] - normal[2] * e0[1], normal[2] * e0[0] - normal[0] * e0[2], normal[0] * e0[1] - normal[1] * e0[0] };
+
+            for (u32 i = 0; i < AttributeCount; ++i) {
+                const double delta0 = attribute_array[1][i] - attribute_array[0][i];
+                const double delta1 = attribute_array[2][i] - attribute_array[0][i];
+
+                const double gradient[3] = {
+                    (delta0 * d0[0] + delta1 * d1[0]) / length_squared,
+                    (delta0 * d0[1] + delta1 * d1[1]) / length_squared,
+                    (delta0 * d0[2] + delta1 * d1[2]) / length_squared,
+                };
+                const double offset = attribute_array[0][i] - (gradient[0] * p0[0] + gradient[1] * p0[1] + gradient[2] * p0[2]);
+
+                AddPlaneQuadric(out_quadric, gradient, offset, weight);
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    out_attribute_quadric->gradient_array[i][axis] += weight * gradient[axis];
+                }
+                out_attribute_quadric->offset_array[i] += weight * offset;
+            }
+            out_attribute_quadric->weight += weight;
+        }
+
+        void AddAttributeQuadric(AttributeQuadric *out_quadric, const AttributeQuadric *quadric) {
+            for (u32 i = 0; i < AttributeCount; ++i) {
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    out_quadric->gradient_array[i][axis] += quadric->gradient_array[i][axis];
+                }
+                out_quadric->offset_array[i] += quadric->offset_array[i];
+            }
+            out_quadric->weight += quadric->weight;
+        }
+
+        /* Completes the square started by the gradient terms of the position quadric */
+        double EvaluateAttributeQuadric(const AttributeQuadric *quadric, const float *position, const double *attribute_array) {
+            double result = 0.0;
+            for (u32 i = 0; i < AttributeCount; ++i) {
+                const double *gradient = quadric->gradient_array[i];
+                const double  expected = gradient[0] * position[0] + gradient[1] * position[1] + gradient[2] * position[2] + quadric->offset_array[i];
+                result += quadric->weight * attribute_array[i] * attribute_array[i] - 2.0 * attribute_array[i] * expected;
+            }
+            return result;
+        }
+
+        /*
+         * Rejects collapses that rotate a triangle's normal by more than about 75 degrees or make it degenerate.
+         * Only rejecting past 90 degrees lets a triangle turn over through a series of near 90 degree collapses across passes,
+         * leaving inverted triangles and slivers standing perpendicular to the surface.
+         */
+        bool IsCollapseFlipping(const impl::VertexAdjacency *adjacency, const u32 *index_array, const float *position_array, u32 from, u32 to) {
+            for (u32 i = adjacency->offset_array[from]; i < adjacency->offset_array[from + 1]; ++i) {
+                const u32 *triangle = index_array + adjacency->triangle_array[i] * 3;
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) { continue; }
+
+                const float *position_array_before[3] = { position_array + triangle[0] * 3, position_array + triangle[1] * 3, position_array + triangle[2] * 3 };
+                const float *position_array_after[3]  = { position_array_before[0], position_array_before[1], position_array_before[2] };
+                for (u32 corner = 0; corner < 3; ++corner) {
+                    if (triangle[corner] == from) { position_array_after[corner] = position_array + to * 3; }
+                }
+
+                double normal_before[3] = {};
+                double normal_after[3]  = {};
+                CalculateTriangleNormal(normal_before, position_array_before[0], position_array_before[1], position_array_before[2]);
+                CalculateTriangleNormal(normal_after,  position_array_after[0],  position_array_after[1],  position_array_after[2]);
+                const double dot            = normal_before[0] * normal_after[0] + normal_before[1] * normal_after[1] + normal_before[2] * normal_after[2];
+                const double length2_before = normal_before[0] * normal_before[0] + normal_before[1] * normal_before[1] + normal_before[2] * normal_before[2];
+                const double length2_after  = normal_after[0] * normal_after[0] + normal_after[1] * normal_after[1] + normal_after[2] * normal_after[2];
+                if (dot <= MaxCollapseRotationCos * ::sqrt(length2_before * length2_after)) { return true; }
+            }
+            return false;
+        }
+    }
+
+    u32 SimplifyMesh(u32 *out_index_array, const u32 *index_array, u32 index_count, const SourceMesh *source_mesh, const SimplifyMeshInfo *simplify_mesh_info, float *out_error) {
+        DD_ASSERT((index_count % 3) == 0);
+
+        const u32    vertex_count   = source_mesh->vertex_count;
+        const float *position_array = source_mesh->position_array;
+
+        ::memcpy(out_index_array, index_array, sizeof(u32) * index_count);
+        if (out_error != nullptr) {
+            *out_error = 0.0f;
+        }
+
+        const float extent = CalculateExtent(position_array, vertex_count);
+        if (index_count == 0 || extent <= 0.0f) { return index_count; }
+
+        /* Group vertices by position, seams are groups with more than one referenced vertex */
+        u32 *group_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(group_array != nullptr);
+        {
+            util::FlatHashMap<PositionKey, u32> position_map;
+            position_map.Initialize(vertex_count);
+            for (u32 i = 0; i < vertex_count; ++i) {
+                PositionKey key = {};
+                ::memcpy(key.bit_array, position_array + i * 3, sizeof(key.bit_array));
+
+                const u32 *group = position_map.Find(key);
+                group_array[i] = (group != nullptr) ? *group : i;
+                if (group == nullptr) {
+                    position_map.Insert(key, i);
+                }
+            }
+            position_map.Finalize();
+        }
+
+        /* Errors are mean squared distances, attributes are scaled into position units by the mesh extent */
+        const double attribute_scale       = static_cast<double>(simplify_mesh_info->attribute_weight) * extent * static_cast<double>(simplify_mesh_info->attribute_weight) * extent;
+        const double error_limit           = static_cast<double>(simplify_mesh_info->target_error) * extent * static_cast<double>(simplify_mesh_info->target_error) * extent;
+        const u32    target_triangle_count = simplify_mesh_info->target_index_count / 3;
+
+        /* Area weighted plane and attribute quadrics of the input triangles */
+        Quadric *quadric_array = new (std::nothrow) Quadric[vertex_count];
+        DD_ASSERT(quadric_array != nullptr);
+        AttributeQuadric *attribute_quadric_array = new (std::nothrow) AttributeQuadric[vertex_count];
+        DD_ASSERT(attribute_quadric_array != nullptr);
+        ::memset(quadric_array, 0, sizeof(Quadric) * vertex_count);
+        ::memset(attribute_quadric_array, 0, sizeof(AttributeQuadric) * vertex_count);
+
+        for (u32 i = 0; i < index_count; i += 3) {
+            double normal[3] = {};
+            CalculateTriangleNormal(normal, position_array + index_array[i] * 3, position_array + index_array[i + 1] * 3, position_array + index_array[i + 2] * 3);
+            const double length = ::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length == 0.0) { continue; }
+
+            const double  area           = length * 0.5;
+            const double  unit_normal[3] = { normal[0] / length, normal[1] / length, normal[2] / length };
+            const float  *p0             = position_array + index_array[i] * 3;
+            const float  *p1             = position_array + index_array[i + 1] * 3;
+            const float  *p2             = position_array + index_array[i + 2] * 3;
+            const double  distance       = -(unit_normal[0] * p0[0] + unit_normal[1] * p0[1] + unit_normal[2] * p0[2]);
+
+            double attribute_array[3][AttributeCount] = {};
+            for (u32 corner = 0; corner < 3; ++corner) {
+                GetVertexAttributes(attribute_array[corner], source_mesh, index_array[i + corner]);
+            }
+
+            Quadric          triangle_quadric           = {};
+            AttributeQuadric triangle_attribute_quadric = {};
+            AddPlaneQuadric(std::addressof(triangle_quadric), unit_normal, distance, area);
+            AddAttributeGradients(std::addressof(triangle_quadric), std::addressof(triangle_attribute_quadric), p0, p1, p2, normal, attribute_array, area * attribute_scale);
+            triangle_quadric.weight = area;
+
+            for (u32 corner = 0; corner < 3; ++corner) {
+                AddQuadric(std::addressof(quadric_array[index_array[i + corner]]), std::addressof(triangle_quadric));
+                AddAttributeQuadric(std::addressof(attribute_quadric_array[index_array[i + corner]]), std::addressof(triangle_attribute_quadric));
+            }
+        }
+
+        /* Edge use counts by position group, 1 is a border and more than 2 is non manifold */
+        util::FlatHashMap<u64, u32> edge_map;
+        edge_map.Initialize(index_count);
+        for (u32 i = 0; i < index_count; i += 3) {
+            for (u32 corner = 0; corner < 3; ++corner) {
+                const u32 v0 = group_array[index_array[i + corner]];
+                const u32 v1 = group_array[index_array[i + (corner + 1) % 3]];
+                *edge_map.FindOrInsert(MakeEdgeKey(v0, v1)) += 1;
+            }
+        }
+
+        /* Sliding borders get a plane through each border edge perpendicular to its triangle to keep the outline */
+        if (simplify_mesh_info->is_border_locked == false) {
+            for (u32 i = 0; i < index_count; i += 3) {
+                double normal[3] = {};
+                CalculateTriangleNormal(normal, position_array + index_array[i] * 3, position_array + index_array[i + 1] * 3, position_array + index_array[i + 2] * 3);
+                const double length = ::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                if (length == 0.0) { continue; }
+
+                for (u32 corner = 0; corner < 3; ++corner) {
+                    const u32 v0 = index_array[i + corner];
+                    const u32 v1 = index_array[i + (corner + 1) % 3];
+                    if (*edge_map.Find(MakeEdgeKey(group_array[v0], group_array[v1])) != 1) { continue; }
+
+                    const float  *p0      = position_array + v0 * 3;
+                    const float  *p1      = position_array + v1 * 3;
+                    const double  edge[3] = { static_cast<double>(p1[0]) - p0[0], static_cast<double>(p1[1]) - p0[1], static_cast<double>(p1[2]) - p0[2] };
+                    double plane_normal[3] = {
+                        (edge[1] * normal[2] - edge[2] * normal[1]) / length,
+                        (edge[2] * normal[0] - edge[0] * normal[2]) / length,
+                        (edge[0] * normal[1] - edge[1] * normal[0]) / length,
+                    };
+                    const double edge_length = ::sqrt(plane_normal[0] * plane_normal[0] + plane_normal[1] * plane_normal[1] + plane_normal[2] * plane_normal[2]);
+                    if (edge_length == 0.0) { continue; }
+
+                    for (u32 axis = 0; axis < 3; ++axis) {
+                        plane_normal[axis] /= edge_length;
+                    }
+                    const double distance = -(plane_normal[0] * p0[0] + plane_normal[1] * p0[1] + plane_normal[2] * p0[2]);
+                    AddPlaneQuadric(std::addressof(quadric_array[v0]), plane_normal, distance, edge_length * edge_length * BorderPlaneWeight);
+                    AddPlaneQuadric(std::addressof(quadric_array[v1]), plane_normal, distance, edge_length * edge_length * BorderPlaneWeight);
+                }
+            }
+        }
+
+        u8 *kind_array = new (std::nothrow) u8[vertex_count];
+        DD_ASSERT(kind_array != nullptr);
+        u32 *group_vertex_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(group_vertex_array != nullptr);
+        u32 *remap_array = new (std::nothrow) u32[vertex_count];
+        DD_ASSERT(remap_array != nullptr);
+        bool *is_locked_array = new (std::nothrow) bool[vertex_count];
+        DD_ASSERT(is_locked_array != nullptr);
+        Collapse *collapse_array = new (std::nothrow) Collapse[index_count * 2];
+        DD_ASSERT(collapse_array != nullptr);
+
+        u32    result_index_count = index_count;
+        double max_cost           = 0.0;
+        while (target_triangle_count < result_index_count / 3) {
+
+            /* Classify position groups against the current triangles */
+            ::memset(kind_array, VertexKind_Manifold, vertex_count);
+            ::memset(group_vertex_array, 0xff, sizeof(u32) * vertex_count);
+            edge_map.Clear();
+            for (u32 i = 0; i < result_index_count; ++i) {
+                const u32 vertex = out_index_array[i];
+                const u32 group  = group_array[vertex];
+                if (group_vertex_array[group] == InvalidVertex) {
+                    group_vertex_array[group] = vertex;
+                } else if (group_vertex_array[group] != vertex) {
+                    kind_array[group] = VertexKind_Locked;
+                }
+
+                const u32 next_vertex = out_index_array[i - (i % 3) + (i + 1) % 3];
+                *edge_map.FindOrInsert(MakeEdgeKey(group, group_array[next_vertex])) += 1;
+            }
+            for (u32 i = 0; i < result_index_count; ++i) {
+                const u32 v0    = group_array[out_index_array[i]];
+                const u32 v1    = group_array[out_index_array[i - (i % 3) + (i + 1) % 3]];
+                const u32 count = *edge_map.Find(MakeEdgeKey(v0, v1));
+                const u8  kind  = (count == 1) ? ((simplify_mesh_info->is_border_locked == true) ? VertexKind_Locked : VertexKind_Border) : (2 < count) ? VertexKind_Locked : VertexKind_Manifold;
+                kind_array[v0] = std::max(kind_array[v0], kind);
+                kind_array[v1] = std::max(kind_array[v1], kind);
+            }
+
+            /* Gather both directions of every edge, borders only collapse along the border */
+            u32 collapse_count = 0;
+            for (u32 i = 0; i < result_index_count; ++i) {
+                const u32 vertex_array[2] = { out_index_array[i], out_index_array[i - (i % 3) + (i + 1) % 3] };
+                for (u32 direction = 0; direction < 2; ++direction) {
+                    const u32 from = vertex_array[direction];
+                    const u32 to   = vertex_array[direction ^ 1];
+                    if (group_array[from] == group_array[to]) { continue; }
+
+                    const u8 kind = kind_array[group_array[from]];
+                    if (kind == VertexKind_Locked) { continue; }
+                    if (kind == VertexKind_Border && *edge_map.Find(MakeEdgeKey(group_array[from], group_array[to])) != 1) { continue; }
+
+                    double attribute_array[AttributeCount] = {};
+                    GetVertexAttributes(attribute_array, source_mesh, to);
+                    const double weight = quadric_array[from].weight;
+                    const double error  = EvaluateQuadric(std::addressof(quadric_array[from]), position_array + to * 3) + EvaluateAttributeQuadric(std::addressof(attribute_quadric_array[from]), position_array + to * 3, attribute_array);
+                    const double cost   = (0.0 < weight) ? std::max(error / weight, 0.0) : 0.0;
+                    if (error_limit < cost) { continue; }
+
+                    collapse_array[collapse_count] = { from, to, cost };
+                    ++collapse_count;
+                }
+            }
+            if (collapse_count == 0) { break; }
+
+            std::sort(collapse_array, collapse_array + collapse_count, [](const Collapse& lhs, const Collapse& rhs) { return lhs.cost < rhs.cost; });
+
+            /* Cheapest first, each collapse locks the ring around from so later flip checks see final positions */
+            impl::VertexAdjacency adjacency = {};
+            impl::BuildVertexAdjacency(std::addressof(adjacency), out_index_array, result_index_count, vertex_count);
+            for (u32 i = 0; i < vertex_count; ++i) {
+                remap_array[i]     = i;
+                is_locked_array[i] = false;
+            }
+
+            u32 triangle_count = result_index_count / 3;
+            u32 applied_count  = 0;
+            for (u32 i = 0; i < collapse_count && target_triangle_count < triangle_count; ++i) {
+                const Collapse *collapse = std::addressof(collapse_array[i]);
+                if (is_locked_array[collapse->from] == true || is_locked_array[collapse->to] == true) { continue; }
+                if (IsCollapseFlipping(std::addressof(adjacency), out_index_array, position_array, collapse->from, collapse->to) == true) { continue; }
+
+                for (u32 j = adjacency.offset_array[collapse->from]; j < adjacency.offset_array[collapse->from + 1]; ++j) {
+                    const u32 *triangle = out_index_array + adjacency.triangle_array[j] * 3;
+                    is_locked_array[triangle[0]] = true;
+                    is_locked_array[triangle[1]] = true;
+                    is_locked_array[triangle[2]] = true;
+                    if (triangle[0] == collapse->to || triangle[1] == collapse->to || triangle[2] == collapse->to) {
+                        --triangle_count;
+                    }
+                }
+
+                remap_array[collapse->from] = collapse->to;
+                AddQuadric(std::addressof(quadric_array[collapse->to]), std::addressof(quadric_array[collapse->from]));
+                AddAttributeQuadric(std::addressof(attribute_quadric_array[collapse->to]), std::addressof(attribute_quadric_array[collapse->from]));
+                max_cost = std::max(max_cost, collapse->cost);
+                ++applied_count;
+            }
+            impl::FreeVertexAdjacency(std::addressof(adjacency));
+
+            if (applied_count == 0) { break; }
+
+            /* Targets never move in the same pass, so one remap is final. Collapsed triangles drop out */
+            u32 write_count = 0;
+            for (u32 i = 0; i < result_index_count; i += 3) {
+                const u32 v0 = remap_array[out_index_array[i]];
+                const u32 v1 = remap_array[out_index_array[i + 1]];
+                const u32 v2 = remap_array[out_index_array[i + 2]];
+                if (v0 == v1 || v1 == v2 || v0 == v2) { continue; }
+
+                out_index_array[write_count]     = v0;
+                out_index_array[write_count + 1] = v1;
+                out_index_array[write_count + 2] = v2;
+                write_count += 3;
+            }
+            result_index_count = write_count;
+        }
+
+        if (out_error != nullptr) {
+            *out_error = static_cast<float>(::sqrt(max_cost)) / extent;
+        }
+
+        edge_map.Finalize();
+        delete[] collapse_array;
+        delete[] is_locked_array;
+        delete[] remap_array;
+        delete[] group_vertex_array;
+        delete[] kind_array;
+        delete[] attribute_quadric_array;
+        delete[] quadric_array;
+        delete[] group_array;
+
+        return result_index_count;
+    }
+
+    void GenerateMeshLods(SourceMeshLods *out_source_lods, const SourceMesh *source_mesh, const MeshLodInfo *mesh_lod_info) {
+        DD_ASSERT(1 <= mesh_lod_info->lod_count && mesh_lod_info->lod_count <= MaxMeshLods);
+
+        *out_source_lods = {};
+        const u32 max_lod_count = mesh_lod_info->lod_count - 1;
+        if (max_lod_count == 0 || source_mesh->index_count == 0) { return; }
+
+        /* Every lod is at most 9/10 of the previous one, so each fits in the size of lod 0 */
+        const u32 submesh_count = source_mesh->submesh_count;
+        out_source_lods->index_array = new (std::nothrow) u32[source_mesh->index_count * max_lod_count];
+        DD_ASSERT(out_source_lods->index_array != nullptr);
+        out_source_lods->submesh_array = new (std::nothrow) SourceSubmesh[submesh_count * max_lod_count];
+        DD_ASSERT(out_source_lods->submesh_array != nullptr);
+        u32 *scratch_index_array = new (std::nothrow) u32[source_mesh->index_count];
+        DD_ASSERT(scratch_index_array != nullptr);
+
+        SimplifyMeshInfo simplify_mesh_info = {};
+        simplify_mesh_info.SetDefaults();
+        simplify_mesh_info.target_error     = mesh_lod_info->max_error;
+        simplify_mesh_info.attribute_weight = mesh_lod_info->attribute_weight;
+        simplify_mesh_info.is_border_locked = mesh_lod_info->is_border_locked;
+
+        const float extent = CalculateExtent(source_mesh->position_array, source_mesh->vertex_count);
+
+        const u32           *previous_index_array   = source_mesh->index_array;
+        const SourceSubmesh *previous_submesh_array = source_mesh->submesh_array;
+        u32                  previous_index_count   = source_mesh->index_count;
+        float                previous_error         = 0.0f;
+        for (u32 lod = 0; lod < max_lod_count; ++lod) {
+            u32           *lod_index_array   = out_source_lods->index_array + out_source_lods->index_count;
+            SourceSubmesh *lod_submesh_array = out_source_lods->submesh_array + lod * submesh_count;
+
+            u32   lod_index_count = 0;
+            float lod_error       = 0.0f;
+            for (u32 i = 0; i < submesh_count; ++i) {
+                const SourceSubmesh *previous_submesh = std::addressof(previous_submesh_array[i]);
+                simplify_mesh_info.target_index_count = static_cast<u32>(previous_submesh->index_count * mesh_lod_info->index_ratio) / 3 * 3;
+
+                float error = 0.0f;
+                const u32 index_count = SimplifyMesh(scratch_index_array, previous_index_array + previous_submesh->index_offset, previous_submesh->index_count, source_mesh, std::addressof(simplify_mesh_info), std::addressof(error));
+                OptimizeVertexCache(lod_index_array + lod_index_count, scratch_index_array, index_count, source_mesh->vertex_count, DefaultVertexCacheSize);
+
+                lod_submesh_array[i] = {
+                    .index_offset  = out_source_lods->index_count + lod_index_count,
+                    .index_count   = index_count,
+                    .material_hash = previous_submesh->material_hash,
+                };
+                lod_index_count += index_count;
+                lod_error        = std::max(lod_error, error);
+            }
+
+            /* A lod saving less than a tenth is not worth its memory, coarser ones would fail the same way */
+            if (lod_index_count == 0 || (previous_index_count * 9) < (lod_index_count * 10)) { break; }
+
+            /* Each lod is simplified from the previous one so their errors add up */
+            const float error = previous_error + lod_error * extent;
+            out_source_lods->lod_array[lod] = {
+                .index_offset = out_source_lods->index_count,
+                .index_count  = lod_index_count,
+                .error        = error,
+            };
+            out_source_lods->index_count += lod_index_count;
+            out_source_lods->lod_count    = lod + 1;
+
+            previous_index_array   = out_source_lods->index_array;
+            previous_submesh_array = lod_submesh_array;
+            previous_index_count   = lod_index_count;
+            previous_error         = error;
+        }
+
+        delete[] scratch_index_array;
+    }
+
+    void FreeSourceMeshLods(SourceMeshLods *source_lods) {
+        if (source_lods->index_array != nullptr) {
+            delete[] source_lods->index_array;
+        }
+        if (source_lods->submesh_array != nullptr) {
+            delete[] source_lods->submesh_array;
+        }
+        *source_lods = {};
+    }
+}
@@ -0,0 +1,224 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        using v4s  = util::sse4::v4s;
+        using v4si = util::sse4::v4si;
+
+        constexpr u32 LinearToSrgbTableSize = 0x4000;
+        constexpr u32 KaiserTapCount        = 8;
+
+        constexpr float CalcSrgbToLinear(float value) {
+            return (value <= 0.04045f) ? value / 12.92f : __builtin_powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        constexpr float CalcLinearToSrgb(float value) {
+            return (value <= 0.0031308f) ? value * 12.92f : 1.055f * __builtin_powf(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        struct SrgbTable {
+            float linear_array[256];
+
+            constexpr SrgbTable() : linear_array{} {
+                for (u32 i = 0; i < 256; ++i) {
+                    linear_array[i] = CalcSrgbToLinear(static_cast<float>(i) / 255.0f);
+                }
+            }
+        };
+
+        /* Linear is quantized to 14 bits, fine enough that every sRGB code is reachable */
+        struct LinearToSrgbTable {
+            u8 srgb_array[LinearToSrgbTableSize];
+
+            constexpr LinearToSrgbTable() : srgb_array{} {
+                for (u32 i = 0; i < LinearToSrgbTableSize; ++i) {
+                    srgb_array[i] = static_cast<u8>(CalcLinearToSrgb(static_cast<float>(i) / (LinearToSrgbTableSize - 1)) * 255.0f + 0.5f);
+                }
+            }
+        };
+
+        constexpr float CalcBesselI0(float x) {
+            float sum  = 1.0f;
+            float term = 1.0f;
+            for (u32 k = 1; k < 16; ++k) {
+                term = term * (x * 0.5f / k) * (x * 0.5f / k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        /* Taps sit at +-0.25, 0.75, 1.25 and 1.75 destination texels from the center, radius 2 and beta 4 */
+        struct KaiserWeights {
+            float weight_array[KaiserTapCount];
+
+            constexpr KaiserWeights() : weight_array{} {
+                constexpr float Pi     = 3.14159265358979f;
+                constexpr float Radius = 2.0f;
+                constexpr float Beta   = 4.0f;
+
+                float sum = 0.0f;
+                for (u32 i = 0; i < KaiserTapCount; ++i) {
+                    const float x      = (static_cast<float>(i) - 3.5f) * 0.5f;
+                    const float sinc   = __builtin_sinf(Pi * x) / (Pi * x);
+                    const float window = x / Radius;
+                    weight_array[i]    = sinc * CalcBesselI0(Beta * __builtin_sqrtf(1.0f - window * window)) / CalcBesselI0(Beta);
+                    sum               += weight_array[i];
+                }
+                for (u32 i = 0; i < KaiserTapCount; ++i) {
+                    weight_array[i] = weight_array[i] / sum;
+                }
+            }
+        };
+
+        constexpr SrgbTable         SrgbToLinearTable = {};
+        constexpr LinearToSrgbTable LinearToSrgb      = {};
+        constexpr KaiserWeights     Kaiser            = {};
+
+        inline v4s LoadTexel(const u8 *texel, bool is_srgb) {
+            if (is_srgb == true) {
+                return v4s{ SrgbToLinearTable.linear_array[texel[0]], SrgbToLinearTable.linear_array[texel[1]], SrgbToLinearTable.linear_array[texel[2]], texel[3] * (1.0f / 255.0f) };
+            }
+            return v4s{ static_cast<float>(texel[0]), static_cast<float>(texel[1]), static_cast<float>(texel[2]), static_cast<float>(texel[3]) } * (1.0f / 255.0f);
+        }
+
+        inline void StoreTexel(u8 *out_texel, v4s value, bool is_srgb) {
+            const v4s zero = {};
+            const v4s one  = zero + 1.0f;
+            value = (value < zero) ? zero : value;
+            value = (one < value) ? one : value;
+
+            if (is_srgb == true) {
+                const v4si index = __builtin_convertvector(value * static_cast<float>(LinearToSrgbTableSize - 1) + 0.5f, v4si);
+                out_texel[0] = LinearToSrgb.srgb_array[index[0]];
+                out_texel[1] = LinearToSrgb.srgb_array[index[1]];
+                out_texel[2] = LinearToSrgb.srgb_array[index[2]];
+                out_texel[3] = static_cast<u8>(value[3] * 255.0f + 0.5f);
+                return;
+            }
+
+            const v4si unorm = __builtin_convertvector(value * 255.0f + 0.5f, v4si);
+            out_texel[0] = static_cast<u8>(unorm[0]);
+            out_texel[1] = static_cast<u8>(unorm[1]);
+            out_texel[2] = static_cast<u8>(unorm[2]);
+            out_texel[3] = static_cast<u8>(unorm[3]);
+        }
+
+        constexpr ALWAYS_INLINE u32 ClampTap(s32 index, u32 size) {
+            return (index < 0) ? 0 : (static_cast<s32>(size) <= index) ? size - 1 : static_cast<u32>(index);
+        }
+
+        void DownsampleBox(u8 *out_mip, const u8 *mip, u32 width, u32 height, bool is_srgb) {
+            const u32 out_width  = CalcMipDimension(width, 1);
+            const u32 out_height = CalcMipDimension(height, 1);
+
+            for (u32 y = 0; y < out_height; ++y) {
+                const u32 y0   = y * 2;
+                const u32 y1   = (y0 + 1 < height) ? y0 + 1 : y0;
+                const u8 *row0 = mip + static_cast<size_t>(y0) * width * 4;
+                const u8 *row1 = mip + static_cast<size_t>(y1) * width * 4;
+                u8       *out  = out_mip + static_cast<size_t>(y) * out_width * 4;
+
+                for (u32 x = 0; x < out_width; ++x) {
+                    const u32 x0 = x * 2 * 4;
+                    const u32 x1 = ((x * 2 + 1 < width) ? x * 2 + 1 : x * 2) * 4;
+
+                    const v4s sum = LoadTexel(row0 + x0, is_srgb) + LoadTexel(row0 + x1, is_srgb) + LoadTexel(row1 + x0, is_srgb) + LoadTexel(row1 + x1, is_srgb);
+                    StoreTexel(out + x * 4, sum * 0.25f, is_srgb);
+                }
+            }
+        }
+
+        void DownsampleKaiser(u8 *out_mip, const u8 *mip, u32 width, u32 height, bool is_srgb) {
+            const u32 out_width  = CalcMipDimension(width, 1);
+            const u32 out_height = CalcMipDimension(height, 1);
+
+            /* Horizontal pass into linear float rows, each source row is converted once */
+            v4s *row_array = new (std::nothrow) v4s[static_cast<size_t>(out_width) * height + width];
+            DD_ASSERT(row_array != nullptr);
+
+            v4s *line = row_array + static_cast<size_t>(out_width) * height;
+            for (u32 y = 0; y < height; ++y) {
+                const u8 *row = mip + static_cast<size_t>(y) * width * 4;
+                for (u32 x = 0; x < width; ++x) {
+                    line[x] = LoadTexel(row + x * 4, is_srgb);
+                }
+
+                v4s *out_row = row_array + static_cast<size_t>(y) * out_width;
+                for (u32 x = 0; x < out_width; ++x) {
+                    v4s sum = {};
+                    for (u32 i = 0; i < KaiserTapCount; ++i) {
+                        sum += line[ClampTap(static_cast<s32>(x * 2 + i) - 3, width)] * Kaiser.weight_array[i];
+                    }
+                    out_row[x] = sum;
+                }
+            }
+
+            /* Vertical pass */
+            for (u32 y = 0; y < out_height; ++y) {
+                const v4s *tap_row_array[KaiserTapCount] = {};
+                for (u32 i = 0; i < KaiserTapCount; ++i) {
+                    tap_row_array[i] = row_array + static_cast<size_t>(ClampTap(static_cast<s32>(y * 2 + i) - 3, height)) * out_width;
+                }
+
+                u8 *out = out_mip + static_cast<size_t>(y) * out_width * 4;
+                for (u32 x = 0; x < out_width; ++x) {
+                    v4s sum = {};
+                    for (u32 i = 0; i < KaiserTapCount; ++i) {
+                        sum += tap_row_array[i][x] * Kaiser.weight_array[i];
+                    }
+                    StoreTexel(out + x * 4, sum, is_srgb);
+                }
+            }
+
+            delete[] row_array;
+        }
+    }
+
+    float ConvertSrgbToLinear(u8 value) {
+        return SrgbToLinearTable.linear_array[value];
+    }
+
+    u8 ConvertLinearToSrgb(float value) {
+        value = (value <= 0.0f) ? 0.0f : (1.0f <= value) ? 1.0f : value;
+        return LinearToSrgb.srgb_array[static_cast<u32>(value * (LinearToSrgbTableSize - 1) + 0.5f)];
+    }
+
+    void DownsampleMipRgba8(u8 *out_mip, const u8 *mip, u32 width, u32 height, bool is_srgb, MipFilter filter) {
+        DD_PROFILE_SCOPE("DownsampleMip");
+
+        if (filter == MipFilter_Kaiser) {
+            DownsampleKaiser(out_mip, mip, width, height, is_srgb);
+        } else {
+            DownsampleBox(out_mip, mip, width, height, is_srgb);
+        }
+    }
+
+    void GenerateMipChainRgba8(u8 *chain, u32 width, u32 height, u32 mip_levels, bool is_srgb, MipFilter filter) {
+        u8 *mip = chain;
+        for (u32 i = 1; i < mip_levels; ++i) {
+            const u32 mip_width  = CalcMipDimension(width, i - 1);
+            const u32 mip_height = CalcMipDimension(height, i - 1);
+            u8       *next_mip   = mip + static_cast<size_t>(mip_width) * mip_height * 4;
+
+            DownsampleMipRgba8(next_mip, mip, mip_width, mip_height, is_srgb, filter);
+            mip = next_mip;
+        }
+    }
+}
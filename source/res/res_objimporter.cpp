@@ -0,0 +1,294 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        constexpr u32 InvalidObjIndex = 0xffff'ffff;
+
+        struct ObjVertexKey {
+            u32 position;
+            u32 texcoord;
+            u32 normal;
+
+            constexpr bool operator==(const ObjVertexKey& rhs) const = default;
+        };
+
+        struct ObjCounts {
+            u32 position_count;
+            u32 texcoord_count;
+            u32 normal_count;
+            u32 corner_count;
+            u32 submesh_count;
+        };
+
+        constexpr ALWAYS_INLINE bool IsObjSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        inline const char *SkipObjSpace(const char *iter) {
+            while (IsObjSpace(*iter) == true) { ++iter; }
+            return iter;
+        }
+
+        inline const char *SkipObjLine(const char *iter) {
+            while (*iter != '\n' && *iter != '\0') { ++iter; }
+            return (*iter == '\n') ? iter + 1 : iter;
+        }
+
+        /* Keywords must be followed by whitespace so "v" does not match "vt" */
+        inline bool IsObjKeyword(const char *iter, const char *keyword) {
+            u32 i = 0;
+            for (; keyword[i] != '\0'; ++i) {
+                if (iter[i] != keyword[i]) { return false; }
+            }
+            return IsObjSpace(iter[i]);
+        }
+
+        inline const char *ParseObjFloats(const char *iter, float *out_value_array, u32 value_count) {
+            for (u32 i = 0; i < value_count; ++i) {
+                char *end = nullptr;
+                out_value_array[i] = ::strtof(iter, std::addressof(end));
+                iter = end;
+            }
+            return iter;
+        }
+
+        /* Obj indices are one based, negative indices are relative to the current end of the list */
+        inline u32 ResolveObjIndex(long index, u32 count) {
+            if (index < 0)  { index = static_cast<long>(count) + index + 1; }
+            DD_ASSERT(0 < index && static_cast<u32>(index) <= count);
+            return static_cast<u32>(index - 1);
+        }
+
+        /* Parses "p", "p/t", "p//n" or "p/t/n", returns nullptr at the end of the face */
+        const char *ParseObjCorner(const char *iter, const ObjCounts *counts, ObjVertexKey *out_key) {
+            iter = SkipObjSpace(iter);
+            if (*iter == '\n' || *iter == '\0' || *iter == '#') { return nullptr; }
+
+            char *end = nullptr;
+            out_key->position = ResolveObjIndex(::strtol(iter, std::addressof(end), 10), counts->position_count);
+            out_key->texcoord = InvalidObjIndex;
+            out_key->normal   = InvalidObjIndex;
+            iter = end;
+
+            if (*iter != '/') { return iter; }
+            ++iter;
+            if (*iter != '/') {
+                out_key->texcoord = ResolveObjIndex(::strtol(iter, std::addressof(end), 10), counts->texcoord_count);
+                iter = end;
+            }
+
+            if (*iter != '/') { return iter; }
+            ++iter;
+            out_key->normal = ResolveObjIndex(::strtol(iter, std::addressof(end), 10), counts->normal_count);
+            return end;
+        }
+
+        void CountObj(const char *text, ObjCounts *out_counts) {
+            *out_counts = {};
+            out_counts->submesh_count = 1;
+
+            const char *iter = text;
+            while (*iter != '\0') {
+                iter = SkipObjSpace(iter);
+                if (IsObjKeyword(iter, "v") == true)      { ++out_counts->position_count; }
+                if (IsObjKeyword(iter, "vt") == true)     { ++out_counts->texcoord_count; }
+                if (IsObjKeyword(iter, "vn") == true)     { ++out_counts->normal_count; }
+                if (IsObjKeyword(iter, "usemtl") == true) { ++out_counts->submesh_count; }
+                if (IsObjKeyword(iter, "f") == true) {
+
+                    /* Fans emit three corners per triangle */
+                    u32 face_corner_count = 0;
+                    const char *corner = iter + 1;
+                    while (*corner != '\n' && *corner != '\0' && *corner != '#') {
+                        corner = SkipObjSpace(corner);
+                        if (*corner == '\n' || *corner == '\0' || *corner == '#') { break; }
+                        ++face_corner_count;
+                        while (IsObjSpace(*corner) == false && *corner != '\n' && *corner != '\0') { ++corner; }
+                    }
+                    if (3 <= face_corner_count) {
+                        out_counts->corner_count += (face_corner_count - 2) * 3;
+                    }
+                }
+                iter = SkipObjLine(iter);
+            }
+        }
+    }
+
+    void ImportObj(const char *path, SourceMesh *out_source_mesh) {
+
+        char *text      = nullptr;
+        u32   text_size = 0;
+        LoadTextFile(path, std::addressof(text), std::addressof(text_size));
+
+        /* Size every array with a counting pass */
+        ObjCounts counts = {};
+        CountObj(text, std::addressof(counts));
+        DD_ASSERT(counts.position_count != 0 && counts.corner_count != 0);
+
+        float *obj_position_array = new (std::nothrow) float[counts.position_count * 3];
+        DD_ASSERT(obj_position_array != nullptr);
+        float *obj_texcoord_array = nullptr;
+        if (counts.texcoord_count != 0) {
+            obj_texcoord_array = new (std::nothrow) float[counts.texcoord_count * 2];
+            DD_ASSERT(obj_texcoord_array != nullptr);
+        }
+        float *obj_normal_array = nullptr;
+        if (counts.normal_count != 0) {
+            obj_normal_array = new (std::nothrow) float[counts.normal_count * 3];
+            DD_ASSERT(obj_normal_array != nullptr);
+        }
+
+        /* Welded vertices never outnumber corners */
+        SourceMesh *mesh = out_source_mesh;
+        *mesh = {};
+        mesh->position_array = new (std::nothrow) float[counts.corner_count * 3];
+        DD_ASSERT(mesh->position_array != nullptr);
+        if (counts.texcoord_count != 0) {
+            mesh->texcoord_array = new (std::nothrow) float[counts.corner_count * 2];
+            DD_ASSERT(mesh->texcoord_array != nullptr);
+        }
+        if (counts.normal_count != 0) {
+            mesh->normal_array = new (std::nothrow) float[counts.corner_count * 3];
+            DD_ASSERT(mesh->normal_array != nullptr);
+        }
+        mesh->index_array = new (std::nothrow) u32[counts.corner_count];
+        DD_ASSERT(mesh->index_array != nullptr);
+        mesh->submesh_array = new (std::nothrow) SourceSubmesh[counts.submesh_count];
+        DD_ASSERT(mesh->submesh_array != nullptr);
+
+        mesh->submesh_count    = 1;
+        mesh->submesh_array[0] = {};
+
+        util::FlatHashMap<ObjVertexKey, u32> vertex_map;
+        vertex_map.Initialize(counts.corner_count);
+
+        /* Counts grow as lines are read so relative indices resolve against the elements seen so far */
+        ObjCounts read_counts = {};
+        const char *iter = text;
+        while (*iter != '\0') {
+            iter = SkipObjSpace(iter);
+
+            if (IsObjKeyword(iter, "v") == true) {
+                ParseObjFloats(iter + 1, obj_position_array + read_counts.position_count * 3, 3);
+                ++read_counts.position_count;
+            } else if (IsObjKeyword(iter, "vt") == true) {
+                ParseObjFloats(iter + 2, obj_texcoord_array + read_counts.texcoord_count * 2, 2);
+                ++read_counts.texcoord_count;
+            } else if (IsObjKeyword(iter, "vn") == true) {
+                ParseObjFloats(iter + 2, obj_normal_array + read_counts.normal_count * 3, 3);
+                ++read_counts.normal_count;
+            } else if (IsObjKeyword(iter, "usemtl") == true) {
+
+                /* Only start a submesh once the current one has faces */
+                SourceSubmesh *submesh = std::addressof(mesh->submesh_array[mesh->submesh_count - 1]);
+                if (submesh->index_count != 0) {
+                    submesh = std::addressof(mesh->submesh_array[mesh->submesh_count]);
+                    *submesh = { .index_offset = mesh->index_count };
+                    ++mesh->submesh_count;
+                }
+
+                const char *name = SkipObjSpace(iter + 6);
+                size_t name_length = 0;
+                while (name[name_length] != '\n' && name[name_length] != '\0' && name[name_length] != '\r') { ++name_length; }
+                submesh->material_hash = util::Hash64(name, name_length);
+            } else if (IsObjKeyword(iter, "f") == true) {
+
+                /* Triangulate as a fan around the first corner */
+                u32 first_vertex    = 0;
+                u32 previous_vertex = 0;
+                u32 corner_index    = 0;
+                ObjVertexKey key = {};
+                const char *corner = ParseObjCorner(iter + 1, std::addressof(read_counts), std::addressof(key));
+                while (corner != nullptr) {
+
+                    u32 vertex = 0;
+                    const u32 *found_vertex = vertex_map.Find(key);
+                    if (found_vertex != nullptr) {
+                        vertex = *found_vertex;
+                    } else {
+                        vertex = mesh->vertex_count;
+                        ::memcpy(mesh->position_array + vertex * 3, obj_position_array + key.position * 3, sizeof(float) * 3);
+                        if (mesh->texcoord_array != nullptr) {
+                            float *texcoord = mesh->texcoord_array + vertex * 2;
+                            texcoord[0] = (key.texcoord != InvalidObjIndex) ? obj_texcoord_array[key.texcoord * 2 + 0] : 0.0f;
+                            texcoord[1] = (key.texcoord != InvalidObjIndex) ? obj_texcoord_array[key.texcoord * 2 + 1] : 0.0f;
+                        }
+                        if (mesh->normal_array != nullptr) {
+                            float *normal = mesh->normal_array + vertex * 3;
+                            normal[0] = (key.normal != InvalidObjIndex) ? obj_normal_array[key.normal * 3 + 0] : 0.0f;
+                            normal[1] = (key.normal != InvalidObjIndex) ? obj_normal_array[key.normal * 3 + 1] : 0.0f;
+                            normal[2] = (key.normal != InvalidObjIndex) ? obj_normal_array[key.normal * 3 + 2] : 0.0f;
+                        }
+                        vertex_map.Insert(key, vertex);
+                        ++mesh->vertex_count;
+                    }
+
+                    if (corner_index == 0) {
+                        first_vertex = vertex;
+                    } else if (2 <= corner_index) {
+                        mesh->index_array[mesh->index_count + 0] = first_vertex;
+                        mesh->index_array[mesh->index_count + 1] = previous_vertex;
+                        mesh->index_array[mesh->index_count + 2] = vertex;
+                        mesh->index_count += 3;
+                        mesh->submesh_array[mesh->submesh_count - 1].index_count += 3;
+                    }
+                    previous_vertex = vertex;
+                    ++corner_index;
+
+                    corner = ParseObjCorner(corner, std::addressof(read_counts), std::addressof(key));
+                }
+            }
+            iter = SkipObjLine(iter);
+        }
+        DD_ASSERT(mesh->index_count == counts.corner_count);
+
+        /* Drop a trailing material switch with no faces */
+        if (1 < mesh->submesh_count && mesh->submesh_array[mesh->submesh_count - 1].index_count == 0) {
+            --mesh->submesh_count;
+        }
+
+        vertex_map.Finalize();
+        if (obj_normal_array != nullptr) {
+            delete[] obj_normal_array;
+        }
+        if (obj_texcoord_array != nullptr) {
+            delete[] obj_texcoord_array;
+        }
+        delete[] obj_position_array;
+        delete[] text;
+    }
+
+    void FreeSourceMesh(SourceMesh *source_mesh) {
+        if (source_mesh->position_array != nullptr) {
+            delete[] source_mesh->position_array;
+        }
+        if (source_mesh->normal_array != nullptr) {
+            delete[] source_mesh->normal_array;
+        }
+        if (source_mesh->texcoord_array != nullptr) {
+            delete[] source_mesh->texcoord_array;
+        }
+        if (source_mesh->index_array != nullptr) {
+            delete[] source_mesh->index_array;
+        }
+        if (source_mesh->submesh_array != nullptr) {
+            delete[] source_mesh->submesh_array;
+        }
+        *source_mesh = {};
+    }
+}
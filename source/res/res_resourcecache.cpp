@@ -0,0 +1,219 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    void ResourceCache::LinkLru(Entry *entry) {
+
+        /* Most recently released entries go to the tail */
+        entry->lru_prev = m_lru_tail;
+        entry->lru_next = nullptr;
+        if (m_lru_tail != nullptr) {
+            m_lru_tail->lru_next = entry;
+        } else {
+            m_lru_head = entry;
+        }
+        m_lru_tail = entry;
+    }
+
+    void ResourceCache::UnlinkLru(Entry *entry) {
+        if (entry->lru_prev != nullptr) {
+            entry->lru_prev->lru_next = entry->lru_next;
+        } else {
+            m_lru_head = entry->lru_next;
+        }
+        if (entry->lru_next != nullptr) {
+            entry->lru_next->lru_prev = entry->lru_prev;
+        } else {
+            m_lru_tail = entry->lru_prev;
+        }
+        entry->lru_prev = nullptr;
+        entry->lru_next = nullptr;
+    }
+
+    ResourceCache::Entry *ResourceCache::EvictLru(bool is_evict_all) {
+        Entry *evicted_head = nullptr;
+        while (m_lru_head != nullptr && (is_evict_all == true || m_memory_budget < m_memory_used)) {
+            Entry *entry = m_lru_head;
+            this->UnlinkLru(entry);
+
+            const bool result0 = m_entry_map.Remove(entry->key);
+            DD_ASSERT(result0 == true);
+
+            m_memory_used    -= entry->memory_size;
+            m_eviction_count += 1;
+
+            entry->lru_next = evicted_head;
+            evicted_head    = entry;
+        }
+        return evicted_head;
+    }
+
+    void ResourceCache::DestroyEntries(Entry *entry) {
+        while (entry != nullptr) {
+            Entry *next = entry->lru_next;
+            (entry->destroy_function)(entry->resource, entry->destroy_user_data);
+            delete entry;
+            entry = next;
+        }
+    }
+
+    ResourceCache::Entry *ResourceCache::FindEntry(u64 key, const void *type_tag) {
+        std::scoped_lock l(m_cache_cs);
+
+        Entry **entry_ptr = m_entry_map.Find(key);
+        if (entry_ptr == nullptr) {
+            m_miss_count += 1;
+            return nullptr;
+        }
+
+        Entry *entry = *entry_ptr;
+        DD_ASSERT(entry->type_tag == type_tag);
+
+        /* Revive an unreferenced entry */
+        if (entry->reference_count == 0) {
+            this->UnlinkLru(entry);
+        }
+        entry->reference_count += 1;
+        m_hit_count            += 1;
+
+        return entry;
+    }
+
+    ResourceCache::Entry *ResourceCache::InsertEntry(u64 key, const void *type_tag, void *resource, size_t memory_size, ResourceDestroyFunction destroy_function, void *destroy_user_data) {
+        DD_ASSERT(resource != nullptr && destroy_function != nullptr);
+
+        Entry *evicted_head = nullptr;
+        Entry *entry        = nullptr;
+        {
+            std::scoped_lock l(m_cache_cs);
+
+            /* Lost a race with another loader, keep theirs */
+            Entry **entry_ptr = m_entry_map.Find(key);
+            if (entry_ptr != nullptr) {
+                entry = *entry_ptr;
+                DD_ASSERT(entry->type_tag == type_tag);
+
+                if (entry->reference_count == 0) {
+                    this->UnlinkLru(entry);
+                }
+                entry->reference_count += 1;
+            } else {
+                entry = new (std::nothrow) Entry{
+                    .key               = key,
+                    .type_tag          = type_tag,
+                    .resource          = resource,
+                    .memory_size       = memory_size,
+                    .destroy_function  = destroy_function,
+                    .destroy_user_data = destroy_user_data,
+                    .reference_count   = 1,
+                    .lru_prev          = nullptr,
+                    .lru_next          = nullptr
+                };
+                DD_ASSERT(entry != nullptr);
+
+                m_entry_map.Insert(key, entry);
+                m_memory_used += memory_size;
+
+                evicted_head = this->EvictLru(false);
+            }
+        }
+
+        if (entry->resource != resource) {
+            (destroy_function)(resource, destroy_user_data);
+        }
+        DestroyEntries(evicted_head);
+
+        return entry;
+    }
+
+    void ResourceCache::AddReference(Entry *entry) {
+        std::scoped_lock l(m_cache_cs);
+
+        DD_ASSERT(entry->reference_count != 0);
+        entry->reference_count += 1;
+    }
+
+    void ResourceCache::ReleaseReference(Entry *entry) {
+        Entry *evicted_head = nullptr;
+        {
+            std::scoped_lock l(m_cache_cs);
+
+            DD_ASSERT(entry->reference_count != 0);
+            entry->reference_count -= 1;
+            if (entry->reference_count != 0) { return; }
+
+            this->LinkLru(entry);
+            evicted_head = this->EvictLru(false);
+        }
+
+        DestroyEntries(evicted_head);
+    }
+
+    void ResourceCache::Initialize(const ResourceCacheInfo *cache_info) {
+        m_entry_map.Initialize(cache_info->expected_count);
+        m_lru_head       = nullptr;
+        m_lru_tail       = nullptr;
+        m_memory_budget  = cache_info->memory_budget;
+        m_memory_used    = 0;
+        m_hit_count      = 0;
+        m_miss_count     = 0;
+        m_eviction_count = 0;
+    }
+
+    void ResourceCache::Finalize() {
+        this->Trim();
+
+        DD_ASSERT(m_entry_map.GetCount() == 0);
+        m_entry_map.Finalize();
+    }
+
+    void ResourceCache::Trim() {
+        Entry *evicted_head = nullptr;
+        {
+            std::scoped_lock l(m_cache_cs);
+
+            evicted_head = this->EvictLru(true);
+        }
+
+        DestroyEntries(evicted_head);
+    }
+
+    void ResourceCache::SetMemoryBudget(size_t memory_budget) {
+        Entry *evicted_head = nullptr;
+        {
+            std::scoped_lock l(m_cache_cs);
+
+            m_memory_budget = memory_budget;
+            evicted_head    = this->EvictLru(false);
+        }
+
+        DestroyEntries(evicted_head);
+    }
+
+    ResourceCacheStats ResourceCache::GetStats() {
+        std::scoped_lock l(m_cache_cs);
+
+        return ResourceCacheStats {
+            .hit_count      = m_hit_count,
+            .miss_count     = m_miss_count,
+            .eviction_count = m_eviction_count,
+            .memory_used    = m_memory_used,
+            .entry_count    = m_entry_map.GetCount()
+        };
+    }
+}
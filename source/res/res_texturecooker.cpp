@@ -0,0 +1,153 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::res {
+
+    namespace {
+
+        constexpr ALWAYS_INLINE u64 AlignCookedTextureOffset(u64 offset) {
+            return (offset + CookedTextureMipAlignment - 1) & ~static_cast<u64>(CookedTextureMipAlignment - 1);
+        }
+
+        void WriteCookedTexture(Handle file, const void *data, u64 size) {
+            DD_ASSERT(size <= 0xffff'ffff);
+
+            long unsigned int size_written = 0;
+            const bool result = ::WriteFile(file, data, static_cast<u32>(size), std::addressof(size_written), nullptr);
+            DD_ASSERT(result == true && size_written == size);
+        }
+
+        u32 GetCookedTextureFormat(const CookTextureInfo *cook_texture_info) {
+            const bool is_srgb = cook_texture_info->is_srgb;
+            if (cook_texture_info->is_block_compressed == false) {
+                return (is_srgb == true) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            switch (cook_texture_info->bc_format) {
+                case BcFormat_Bc1:
+                    return (is_srgb == true) ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+                case BcFormat_Bc3:
+                    return (is_srgb == true) ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+                case BcFormat_Bc7:
+                    return (is_srgb == true) ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+            }
+            DD_ASSERT(false);
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        void WriteCookedTexturePadding(Handle file, u64 offset) {
+            constexpr u8 zero_array[CookedTextureMipAlignment] = {};
+            const u64 padding = AlignCookedTextureOffset(offset) - offset;
+            if (padding != 0) {
+                WriteCookedTexture(file, zero_array, padding);
+            }
+        }
+    }
+
+    void CookTexture(const char *cooked_path, const char *source_path, const CookTextureInfo *cook_texture_info) {
+
+        /* Decode source, stb flips rows and expands to RGBA */
+        unsigned char *image_data = nullptr;
+        s32 width    = 0;
+        s32 height   = 0;
+        s32 channels = 0;
+        LoadStbImage(source_path, 4, std::addressof(image_data), std::addressof(width), std::addressof(height), std::addressof(channels));
+        DD_ASSERT(image_data != nullptr && 0 < width && 0 < height);
+
+        const u32  mip_levels          = (cook_texture_info->is_mipmapped == true) ? CalcMipLevels(width, height) : 1;
+        const bool is_block_compressed = cook_texture_info->is_block_compressed;
+        DD_ASSERT(mip_levels <= MaxCookedTextureMips);
+
+        CookedTextureHeader header = {
+            .magic           = CookedTextureMagic,
+            .version         = CookedTextureVersion,
+            .width           = static_cast<u32>(width),
+            .height          = static_cast<u32>(height),
+            .mip_levels      = mip_levels,
+            .vk_format       = GetCookedTextureFormat(cook_texture_info),
+            .flags           = CookedTextureFlag_FlippedRows | ((cook_texture_info->is_srgb == true) ? CookedTextureFlag_Srgb : CookedTextureFlag_None),
+            .block_dimension = static_cast<u16>((is_block_compressed == true) ? BcBlockDimension : 1),
+            .block_size      = static_cast<u16>((is_block_compressed == true) ? GetBcBlockSize(cook_texture_info->bc_format) : 4),
+        };
+
+        /* Place mips */
+        u64 offset      = AlignCookedTextureOffset(sizeof(CookedTextureHeader));
+        u64 chain_size  = 0;
+        u64 stored_size = 0;
+        for (u32 i = 0; i < mip_levels; ++i) {
+            CookedTextureMip *mip = std::addressof(header.mip_array[i]);
+            mip->width  = CalcMipDimension(width, i);
+            mip->height = CalcMipDimension(height, i);
+            mip->size   = (is_block_compressed == true) ? CalcBcImageSize(cook_texture_info->bc_format, mip->width, mip->height) : static_cast<u64>(mip->width) * mip->height * 4;
+            mip->offset = offset;
+
+            offset       = AlignCookedTextureOffset(offset + mip->size);
+            chain_size  += static_cast<u64>(mip->width) * mip->height * 4;
+            stored_size += mip->size;
+        }
+
+        /* Build mip chain, level 0 is the decoded image */
+        u8 *chain = new (std::nothrow) u8[chain_size];
+        DD_ASSERT(chain != nullptr);
+
+        ::memcpy(chain, image_data, static_cast<size_t>(width) * height * 4);
+        FreeStbImage(image_data);
+
+        GenerateMipChainRgba8(chain, width, height, mip_levels, cook_texture_info->is_srgb, cook_texture_info->mip_filter);
+
+        /* Encode every level, filtering happens before compression */
+        u8 *stored_chain = chain;
+        if (is_block_compressed == true) {
+            stored_chain = new (std::nothrow) u8[stored_size];
+            DD_ASSERT(stored_chain != nullptr);
+
+            BcEncodeInfo bc_encode_info = {};
+            bc_encode_info.SetDefaults();
+            bc_encode_info.format  = cook_texture_info->bc_format;
+            bc_encode_info.quality = cook_texture_info->bc_quality;
+
+            u8 *mip        = chain;
+            u8 *stored_mip = stored_chain;
+            for (u32 i = 0; i < mip_levels; ++i) {
+                EncodeBcImage(stored_mip, mip, header.mip_array[i].width, header.mip_array[i].height, std::addressof(bc_encode_info));
+                mip        += static_cast<size_t>(header.mip_array[i].width) * header.mip_array[i].height * 4;
+                stored_mip += header.mip_array[i].size;
+            }
+        }
+
+        /* Write cooked texture */
+        Handle cooked_file = ::CreateFile(cooked_path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        DD_ASSERT(cooked_file != INVALID_HANDLE_VALUE);
+
+        WriteCookedTexture(cooked_file, std::addressof(header), sizeof(CookedTextureHeader));
+        WriteCookedTexturePadding(cooked_file, sizeof(CookedTextureHeader));
+
+        const u8 *mip = stored_chain;
+        for (u32 i = 0; i < mip_levels; ++i) {
+            WriteCookedTexture(cooked_file, mip, header.mip_array[i].size);
+            WriteCookedTexturePadding(cooked_file, header.mip_array[i].offset + header.mip_array[i].size);
+            mip += header.mip_array[i].size;
+        }
+
+        ::CloseHandle(cooked_file);
+
+        if (stored_chain != chain) {
+            delete[] stored_chain;
+        }
+        delete[] chain;
+    }
+}
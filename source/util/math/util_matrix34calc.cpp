@@ -58,4 +58,20 @@ namespace dd::util::math {
         out_rot_matrix->m_arr2d[2][0] = (m31 * cos)                           + (out_rot_matrix->m_arr2d[2][1] * sin);
         out_rot_matrix->m_arr2d[2][1] = (out_rot_matrix->m_arr2d[2][1] * cos) - (m31 * sin);
     }
+
+    void MultiplyMatrix34(Matrix34f *out_matrix, const Matrix34f& lhs, const Matrix34f& rhs) {
+        const v4f translation_mask = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        /* Each output row is a linear combination of rhs rows plus the lhs translation */
+        const v4f lhs_row1 = lhs.m_row1.m_vec;
+        const v4f lhs_row2 = lhs.m_row2.m_vec;
+        const v4f lhs_row3 = lhs.m_row3.m_vec;
+        const v4f row1 = (lhs_row1[0] * rhs.m_row1.m_vec) + (lhs_row1[1] * rhs.m_row2.m_vec) + (lhs_row1[2] * rhs.m_row3.m_vec) + (lhs_row1 * translation_mask);
+        const v4f row2 = (lhs_row2[0] * rhs.m_row1.m_vec) + (lhs_row2[1] * rhs.m_row2.m_vec) + (lhs_row2[2] * rhs.m_row3.m_vec) + (lhs_row2 * translation_mask);
+        const v4f row3 = (lhs_row3[0] * rhs.m_row1.m_vec) + (lhs_row3[1] * rhs.m_row2.m_vec) + (lhs_row3[2] * rhs.m_row3.m_vec) + (lhs_row3 * translation_mask);
+
+        out_matrix->m_row1.m_vec = row1;
+        out_matrix->m_row2.m_vec = row2;
+        out_matrix->m_row3.m_vec = row3;
+    }
 }
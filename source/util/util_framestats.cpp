@@ -0,0 +1,174 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::util {
+
+    namespace {
+        bool        is_frame_stats_initialized = false;
+        const char *csv_path                   = nullptr;
+        double      tick_to_ms                 = 0.0;
+        double     *frame_time_array           = nullptr;
+        double     *sort_array                 = nullptr;
+        u32         window_size                = 0;
+        u32         window_index               = 0;
+        u32         sample_count               = 0;
+        u32        *histogram_array            = nullptr;
+        u32         histogram_bucket_count     = 0;
+        double      histogram_bucket_ms        = 0.0;
+        double      hitch_threshold_ms         = 0.0;
+        u32         hitch_count                = 0;
+        u64         frame_count                = 0;
+
+        double SelectPercentile(u32 count, double percentile) {
+            const u32 index = static_cast<u32>(percentile * static_cast<double>(count - 1) + 0.5);
+            std::nth_element(sort_array, sort_array + index, sort_array + count);
+            return sort_array[index];
+        }
+    }
+
+    void InitializeFrameStats(const FrameStatsInfo *frame_stats_info) {
+        DD_ASSERT(is_frame_stats_initialized == false);
+        DD_ASSERT(frame_stats_info->window_size != 0 && frame_stats_info->histogram_bucket_count != 0 && 0.0 < frame_stats_info->histogram_bucket_ms);
+
+        csv_path               = frame_stats_info->csv_path;
+        tick_to_ms             = 1000.0 / static_cast<double>(GetSystemTickFrequency());
+        window_size            = frame_stats_info->window_size;
+        window_index           = 0;
+        sample_count           = 0;
+        histogram_bucket_count = frame_stats_info->histogram_bucket_count;
+        histogram_bucket_ms    = frame_stats_info->histogram_bucket_ms;
+        hitch_threshold_ms     = frame_stats_info->hitch_threshold_ms;
+        hitch_count            = 0;
+        frame_count            = 0;
+
+        /* Allocate window and histogram */
+        frame_time_array = new (std::nothrow) double[window_size];
+        DD_ASSERT(frame_time_array != nullptr);
+        sort_array = new (std::nothrow) double[window_size];
+        DD_ASSERT(sort_array != nullptr);
+        histogram_array = new (std::nothrow) u32[histogram_bucket_count]{};
+        DD_ASSERT(histogram_array != nullptr);
+
+        is_frame_stats_initialized = true;
+    }
+
+    void FinalizeFrameStats() {
+        if (is_frame_stats_initialized == false) { return; }
+
+        /* Dump summary and histogram */
+        if (csv_path != nullptr && frame_count != 0) {
+            FrameStats stats = {};
+            CalcFrameStats(std::addressof(stats));
+
+            constexpr size_t CsvBufferSize = 0x4000;
+            char *csv_buffer = new (std::nothrow) char[CsvBufferSize];
+            DD_ASSERT(csv_buffer != nullptr);
+
+            s32 offset = ::snprintf(csv_buffer, CsvBufferSize,
+                "metric,value\nframes,%llu\nhitches,%u\nhitch_threshold_ms,%.3f\nwindow_frames,%u\nwindow_min_ms,%.3f\nwindow_avg_ms,%.3f\nwindow_p50_ms,%.3f\nwindow_p95_ms,%.3f\nwindow_p99_ms,%.3f\nwindow_max_ms,%.3f\nrun_p50_ms,%.3f\nrun_p95_ms,%.3f\nrun_p99_ms,%.3f\n",
+                static_cast<unsigned long long>(stats.frame_count), stats.hitch_count, hitch_threshold_ms, stats.sample_count,
+                stats.min_ms, stats.avg_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms,
+                CalcHistogramPercentile(0.50), CalcHistogramPercentile(0.95), CalcHistogramPercentile(0.99));
+            for (u32 i = 0; i < histogram_bucket_count && offset < static_cast<s32>(CsvBufferSize); ++i) {
+                offset += ::snprintf(csv_buffer + offset, CsvBufferSize - offset, "bucket_%.1f_ms,%u\n", static_cast<double>(i + 1) * histogram_bucket_ms, histogram_array[i]);
+            }
+            DD_ASSERT(offset < static_cast<s32>(CsvBufferSize));
+
+            Handle file = ::CreateFile(csv_path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            DD_ASSERT(file != INVALID_HANDLE_VALUE);
+
+            long unsigned int size_written = 0;
+            const bool result = ::WriteFile(file, csv_buffer, offset, std::addressof(size_written), nullptr);
+            DD_ASSERT(result == true && size_written == static_cast<u32>(offset));
+
+            ::CloseHandle(file);
+            delete[] csv_buffer;
+        }
+
+        delete[] frame_time_array;
+        delete[] sort_array;
+        delete[] histogram_array;
+        frame_time_array = nullptr;
+        sort_array       = nullptr;
+        histogram_array  = nullptr;
+
+        is_frame_stats_initialized = false;
+    }
+
+    void PushFrameTime(s64 delta_tick) {
+        if (is_frame_stats_initialized == false) { return; }
+
+        const double frame_ms = static_cast<double>(delta_tick) * tick_to_ms;
+
+        /* Write to rolling window */
+        frame_time_array[window_index] = frame_ms;
+        window_index = (window_index + 1 == window_size) ? 0 : window_index + 1;
+        sample_count = (sample_count == window_size) ? sample_count : sample_count + 1;
+
+        /* Update run counters */
+        const u32 bucket = static_cast<u32>(frame_ms / histogram_bucket_ms);
+        histogram_array[(bucket < histogram_bucket_count) ? bucket : histogram_bucket_count - 1] += 1;
+        hitch_count += (hitch_threshold_ms < frame_ms) ? 1 : 0;
+        frame_count += 1;
+    }
+
+    void CalcFrameStats(FrameStats *out_frame_stats) {
+        DD_ASSERT(is_frame_stats_initialized == true);
+
+        *out_frame_stats = FrameStats{ .sample_count = sample_count, .hitch_count = hitch_count, .frame_count = frame_count };
+        if (sample_count == 0) { return; }
+
+        /* Min, max and average */
+        double min_ms = frame_time_array[0];
+        double max_ms = frame_time_array[0];
+        double sum_ms = 0.0;
+        for (u32 i = 0; i < sample_count; ++i) {
+            min_ms  = (frame_time_array[i] < min_ms) ? frame_time_array[i] : min_ms;
+            max_ms  = (max_ms < frame_time_array[i]) ? frame_time_array[i] : max_ms;
+            sum_ms += frame_time_array[i];
+        }
+        out_frame_stats->min_ms = min_ms;
+        out_frame_stats->max_ms = max_ms;
+        out_frame_stats->avg_ms = sum_ms / static_cast<double>(sample_count);
+
+        /* Percentiles, each selection only partially orders the scratch copy */
+        ::memcpy(sort_array, frame_time_array, sample_count * sizeof(double));
+        out_frame_stats->p50_ms = SelectPercentile(sample_count, 0.50);
+        out_frame_stats->p95_ms = SelectPercentile(sample_count, 0.95);
+        out_frame_stats->p99_ms = SelectPercentile(sample_count, 0.99);
+    }
+
+    const u32 *GetFrameTimeHistogram(u32 *out_bucket_count, double *out_bucket_ms) {
+        DD_ASSERT(is_frame_stats_initialized == true);
+
+        *out_bucket_count = histogram_bucket_count;
+        *out_bucket_ms    = histogram_bucket_ms;
+        return histogram_array;
+    }
+
+    double CalcHistogramPercentile(double percentile) {
+        DD_ASSERT(is_frame_stats_initialized == true);
+
+        const u64 target = static_cast<u64>(percentile * static_cast<double>(frame_count));
+        u64 total = 0;
+        for (u32 i = 0; i < histogram_bucket_count; ++i) {
+            total += histogram_array[i];
+            if (target < total) { return static_cast<double>(i + 1) * histogram_bucket_ms; }
+        }
+        return static_cast<double>(histogram_bucket_count) * histogram_bucket_ms;
+    }
+}
@@ -0,0 +1,74 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::util {
+
+    namespace {
+
+        constexpr u32 Crc32cPolynomial = 0x82f6'3b78;
+
+        consteval std::array<u32, 256> MakeCrc32cTable() {
+            std::array<u32, 256> table = {};
+            for (u32 i = 0; i < 256; ++i) {
+                u32 crc = i;
+                for (u32 bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ ((crc & 1) * Crc32cPolynomial);
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+        constexpr std::array<u32, 256> Crc32cTable = MakeCrc32cTable();
+
+        u32 Crc32cSoftware(const u8 *data, size_t size, u32 crc) {
+            for (size_t i = 0; i < size; ++i) {
+                crc = Crc32cTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+        __attribute__((target("sse4.2"))) u32 Crc32cHardware(const u8 *data, size_t size, u32 crc) {
+
+            /* 8 bytes at a time, then the tail */
+            u64 crc64 = crc;
+            while (sizeof(u64) <= size) {
+                u64 value = 0;
+                ::memcpy(std::addressof(value), data, sizeof(u64));
+                crc64 = __builtin_ia32_crc32di(crc64, value);
+                data += sizeof(u64);
+                size -= sizeof(u64);
+            }
+
+            u32 crc32 = static_cast<u32>(crc64);
+            while (size != 0) {
+                crc32 = __builtin_ia32_crc32qi(crc32, *data);
+                ++data;
+                --size;
+            }
+            return crc32;
+        }
+    }
+
+    u32 Crc32c(const void *data, size_t size, u32 crc) {
+
+        /* The cpu is queried once, later calls only pay for the guard */
+        using Crc32cFunction = u32 (*)(const u8*, size_t, u32);
+        static const Crc32cFunction crc32c_function = (__builtin_cpu_supports("sse4.2")) ? Crc32cHardware : Crc32cSoftware;
+
+        return ~crc32c_function(reinterpret_cast<const u8*>(data), size, ~crc);
+    }
+}
@@ -0,0 +1,243 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+#if defined(DD_PROFILE)
+
+namespace dd::util {
+
+    namespace {
+
+        constexpr size_t WriteBufferSize      = 0x10000;
+        constexpr size_t MaxZoneEntryLength   = 256;
+        constexpr size_t MaxEscapedNameLength = 128;
+
+        using ProfileThreadBuffer = impl::ProfileThreadBuffer;
+        using RegisterStack       = IntrusiveMpscTraits<ProfileThreadBuffer, &ProfileThreadBuffer::register_node>::Stack;
+
+        volatile bool        is_profiler_active = false;
+        u32                  zones_per_thread   = 0;
+        u32                  flush_interval_ms  = 0;
+        s64                  profiler_base_tick = 0;
+        double               tick_to_us         = 0.0;
+        u32                  process_id         = 0;
+        HANDLE               trace_file         = INVALID_HANDLE_VALUE;
+        HANDLE               flush_thread       = nullptr;
+        HANDLE               flush_stop_event   = nullptr;
+        RegisterStack        register_stack;
+        ProfileThreadBuffer *flush_list         = nullptr;
+        char                *write_buffer       = nullptr;
+        size_t               write_offset       = 0;
+        bool                 is_first_entry     = true;
+
+        thread_local ProfileThreadBuffer *thread_buffer = nullptr;
+
+        ProfileThreadBuffer *CreateThreadBuffer(const char *name) {
+
+            /* Allocate buffer and ring, the ring is zeroed so zones never page fault */
+            ProfileThreadBuffer *buffer = new (std::nothrow) ProfileThreadBuffer{};
+            DD_ASSERT(buffer != nullptr);
+            buffer->zone_array = new (std::nothrow) ProfileZone[zones_per_thread]{};
+            DD_ASSERT(buffer->zone_array != nullptr);
+
+            buffer->zone_mask = zones_per_thread - 1;
+            buffer->thread_id = static_cast<u32>(::GetCurrentThreadId());
+            if (name != nullptr) {
+                ::snprintf(buffer->thread_name, sizeof(buffer->thread_name), "%s", name);
+            } else {
+                ::snprintf(buffer->thread_name, sizeof(buffer->thread_name), "Thread %u", buffer->thread_id);
+            }
+
+            /* Publish to the flush thread */
+            register_stack.Push(*buffer);
+            thread_buffer = buffer;
+
+            return buffer;
+        }
+
+        void FlushWriteBuffer() {
+            if (write_offset == 0) { return; }
+
+            long unsigned int size_written = 0;
+            const bool result = ::WriteFile(trace_file, write_buffer, static_cast<u32>(write_offset), std::addressof(size_written), nullptr);
+            DD_ASSERT(result == true && size_written == write_offset);
+            write_offset = 0;
+        }
+
+        void AppendEntry(const char *format, ...) {
+            if (WriteBufferSize - write_offset < MaxZoneEntryLength) {
+                FlushWriteBuffer();
+            }
+
+            /* Entries after the first need a separator */
+            if (is_first_entry == false) {
+                write_buffer[write_offset] = ',';
+                ++write_offset;
+            }
+            is_first_entry = false;
+
+            va_list args;
+            va_start(args, format);
+            const s32 length = ::vsnprintf(write_buffer + write_offset, MaxZoneEntryLength - 1, format, args);
+            va_end(args);
+            DD_ASSERT(0 < length && length < static_cast<s32>(MaxZoneEntryLength - 1));
+
+            write_offset += length;
+        }
+
+        void EscapeJsonString(char *output, size_t output_size, const char *input) {
+
+            /* Quotes and backslashes are escaped, control characters are replaced, and overlong names are truncated */
+            size_t offset = 0;
+            for (const char *iter = input; *iter != '\0' && offset + 2 < output_size; ++iter) {
+                const char character = *iter;
+                if (character == '"' || character == '\\') {
+                    output[offset]     = '\\';
+                    output[offset + 1] = character;
+                    offset += 2;
+                } else {
+                    output[offset] = (static_cast<u8>(character) < 0x20) ? ' ' : character;
+                    offset += 1;
+                }
+            }
+            output[offset] = '\0';
+        }
+
+        void FlushZones() {
+
+            /* Adopt newly registered threads */
+            auto batch = register_stack.PopAll();
+            char escaped_name[MaxEscapedNameLength];
+            batch.ForEach([&](ProfileThreadBuffer& buffer) {
+                EscapeJsonString(escaped_name, sizeof(escaped_name), buffer.thread_name);
+                AppendEntry("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", process_id, buffer.thread_id, escaped_name);
+                buffer.flush_next = flush_list;
+                flush_list        = std::addressof(buffer);
+            });
+
+            /* Drain each ring up to the producer's published index */
+            for (ProfileThreadBuffer *buffer = flush_list; buffer != nullptr; buffer = buffer->flush_next) {
+                const u64 write_index = __atomic_load_n(std::addressof(buffer->write_index), __ATOMIC_ACQUIRE);
+                for (u64 i = buffer->read_index; i < write_index; ++i) {
+                    const ProfileZone &zone = buffer->zone_array[i & buffer->zone_mask];
+                    const double begin_us = static_cast<double>(zone.begin_tick - profiler_base_tick) * tick_to_us;
+                    const double dur_us   = static_cast<double>(zone.end_tick - zone.begin_tick) * tick_to_us;
+                    EscapeJsonString(escaped_name, sizeof(escaped_name), zone.name);
+                    AppendEntry("\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}", escaped_name, begin_us, dur_us, process_id, buffer->thread_id);
+                }
+                __atomic_store_n(std::addressof(buffer->read_index), write_index, __ATOMIC_RELEASE);
+            }
+
+            FlushWriteBuffer();
+        }
+
+        long unsigned int ProfilerFlushThreadMain([[maybe_unused]] void *arg) {
+            SetProfilerThreadName("Profiler");
+
+            while (::WaitForSingleObject(flush_stop_event, flush_interval_ms) == WAIT_TIMEOUT) {
+                FlushZones();
+            }
+
+            return 0;
+        }
+    }
+
+    namespace impl {
+
+        ProfileThreadBuffer *GetProfileThreadBuffer() {
+            if (DD_UNLIKELY(is_profiler_active == false)) { return nullptr; }
+
+            ProfileThreadBuffer *buffer = thread_buffer;
+            if (DD_LIKELY(buffer != nullptr)) { return buffer; }
+
+            return CreateThreadBuffer(nullptr);
+        }
+    }
+
+    void InitializeProfiler(const ProfilerInfo *profiler_info) {
+        DD_ASSERT(is_profiler_active == false);
+        DD_ASSERT(profiler_info->zones_per_thread != 0 && (profiler_info->zones_per_thread & (profiler_info->zones_per_thread - 1)) == 0);
+
+        zones_per_thread   = profiler_info->zones_per_thread;
+        flush_interval_ms  = profiler_info->flush_interval_ms;
+        profiler_base_tick = GetSystemTick();
+        tick_to_us         = 1000000.0 / static_cast<double>(GetSystemTickFrequency());
+        process_id         = static_cast<u32>(::GetCurrentProcessId());
+
+        /* Open trace file and write header */
+        trace_file = ::CreateFile(profiler_info->trace_path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        DD_ASSERT(trace_file != INVALID_HANDLE_VALUE);
+
+        write_buffer = new (std::nothrow) char[WriteBufferSize];
+        DD_ASSERT(write_buffer != nullptr);
+
+        const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        ::memcpy(write_buffer, header, sizeof(header) - 1);
+        write_offset   = sizeof(header) - 1;
+        is_first_entry = true;
+
+        /* Start flush thread */
+        flush_stop_event = ::CreateEvent(nullptr, true, false, nullptr);
+        DD_ASSERT(flush_stop_event != nullptr);
+
+        is_profiler_active = true;
+
+        flush_thread = ::CreateThread(nullptr, profiler_info->flush_thread_stack_size, ProfilerFlushThreadMain, nullptr, 0, nullptr);
+        DD_ASSERT(flush_thread != nullptr);
+    }
+
+    void FinalizeProfiler() {
+        if (is_profiler_active == false) { return; }
+        is_profiler_active = false;
+
+        /* Join flush thread and drain what is left */
+        ::SetEvent(flush_stop_event);
+        ::WaitForSingleObject(flush_thread, INFINITE);
+        ::CloseHandle(flush_thread);
+        ::CloseHandle(flush_stop_event);
+
+        FlushZones();
+
+        const char footer[] = "\n]}\n";
+        ::memcpy(write_buffer + write_offset, footer, sizeof(footer) - 1);
+        write_offset += sizeof(footer) - 1;
+        FlushWriteBuffer();
+
+        ::CloseHandle(trace_file);
+        trace_file = INVALID_HANDLE_VALUE;
+
+        /* Free thread buffers */
+        ProfileThreadBuffer *buffer = flush_list;
+        while (buffer != nullptr) {
+            ProfileThreadBuffer *next = buffer->flush_next;
+            delete[] buffer->zone_array;
+            delete buffer;
+            buffer = next;
+        }
+        flush_list = nullptr;
+
+        delete[] write_buffer;
+        write_buffer = nullptr;
+    }
+
+    void SetProfilerThreadName(const char *name) {
+        if (is_profiler_active == false || thread_buffer != nullptr) { return; }
+
+        CreateThreadBuffer(name);
+    }
+}
+
+#endif
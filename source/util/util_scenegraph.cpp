@@ -0,0 +1,292 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with this program;
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::util {
+
+    void SceneGraph::ReserveRanges(u32 count) {
+        if (count <= m_range_capacity) { return; }
+
+        u32 capacity = (m_range_capacity == 0) ? DefaultCapacity : m_range_capacity;
+        while (capacity < count) {
+            capacity = capacity * 2;
+        }
+
+        DirtyRange *new_range_array = new (std::nothrow) DirtyRange[capacity];
+        DD_ASSERT(new_range_array != nullptr);
+
+        if (m_range_array != nullptr) {
+            ::memcpy(new_range_array, m_range_array, m_range_count * sizeof(DirtyRange));
+            delete[] m_range_array;
+        }
+
+        m_range_array    = new_range_array;
+        m_range_capacity = capacity;
+    }
+
+    void SceneGraph::PushRange(u32 begin, u32 end) {
+        this->ReserveRanges(m_range_count + 1);
+        m_range_array[m_range_count] = { begin, end };
+        ++m_range_count;
+    }
+
+    void SceneGraph::RebuildStructure() {
+
+        /* Invalidate old indices so detached nodes are ignored */
+        m_flat_tree.ForEachTopDown([](SceneNode& node, u32, u32) { node.m_flat_index = Tree::InvalidIndex; });
+
+        m_flat_tree.Build(m_root->GetTreeNode());
+        m_flat_tree.ForEachTopDown([](SceneNode& node, u32 index, u32) { node.m_flat_index = index; });
+
+        /* Resize world matrix array, everything is recomputed so nothing is copied */
+        const u32 count = m_flat_tree.GetCount();
+        if (m_world_matrix_capacity < count) {
+            if (m_world_matrix_array != nullptr) {
+                delete[] m_world_matrix_array;
+            }
+            m_world_matrix_array = new (std::nothrow) math::Matrix34f[count];
+            DD_ASSERT(m_world_matrix_array != nullptr);
+            m_world_matrix_capacity = count;
+        }
+
+        m_is_structure_dirty = false;
+    }
+
+    void SceneGraph::GatherDirtyRanges() {
+
+        /* Convert dirty nodes to subtree ranges */
+        m_range_count = 0;
+        for (u32 i = 0; i < m_dirty_node_count; ++i) {
+            SceneNode *node = m_dirty_node_array[i];
+            node->m_is_dirty = false;
+
+            const u32 index = node->m_flat_index;
+            if (index == Tree::InvalidIndex) { continue; }
+
+            this->PushRange(index, index + m_flat_tree.GetSubTreeSize(index));
+        }
+        m_dirty_node_count = 0;
+
+        if (m_range_count < 2) { return; }
+
+        /* Sort by start and drop ranges nested in an earlier dirty subtree */
+        std::sort(m_range_array, m_range_array + m_range_count, [](const DirtyRange& lhs, const DirtyRange& rhs) { return lhs.begin < rhs.begin; });
+
+        u32 out_count = 1;
+        for (u32 i = 1; i < m_range_count; ++i) {
+            if (m_range_array[i].begin < m_range_array[out_count - 1].end) { continue; }
+            m_range_array[out_count] = m_range_array[i];
+            ++out_count;
+        }
+        m_range_count = out_count;
+    }
+
+    void SceneGraph::SplitRangesForWorkers() {
+
+        /* Large subtrees are split into their child subtrees once their root is resolved */
+        u32 i = 0;
+        while (i < m_range_count) {
+            const DirtyRange range = m_range_array[i];
+            if ((range.end - range.begin) <= m_parallel_subtree_threshold || (range.end - range.begin) == 1) {
+                ++i;
+                continue;
+            }
+
+            this->UpdateRange(range.begin, range.begin + 1);
+
+            u32 child = range.begin + 1;
+            m_range_array[i] = { child, child + m_flat_tree.GetSubTreeSize(child) };
+            child += m_flat_tree.GetSubTreeSize(child);
+            while (child < range.end) {
+                this->PushRange(child, child + m_flat_tree.GetSubTreeSize(child));
+                child += m_flat_tree.GetSubTreeSize(child);
+            }
+        }
+    }
+
+    void SceneGraph::UpdateRange(u32 begin, u32 end) {
+
+        /* Parents always precede children, the parent of "begin" is outside the range and already resolved */
+        for (u32 i = begin; i < end; ++i) {
+            if (i + Tree::PrefetchDistance < end) {
+                __builtin_prefetch(std::addressof(m_flat_tree.GetNode(i + Tree::PrefetchDistance)));
+            }
+
+            const SceneNode &node  = m_flat_tree.GetNode(i);
+            const u32 parent_index = m_flat_tree.GetParentIndex(i);
+            if (parent_index == Tree::InvalidIndex) {
+                m_world_matrix_array[i] = node.m_local_matrix;
+            } else {
+                math::MultiplyMatrix34(std::addressof(m_world_matrix_array[i]), m_world_matrix_array[parent_index], node.m_local_matrix);
+            }
+        }
+    }
+
+    void SceneGraph::ProcessRanges() {
+        u32 index = static_cast<u32>(::InterlockedIncrement(std::addressof(m_next_range)) - 1);
+        while (index < m_range_count) {
+            this->UpdateRange(m_range_array[index].begin, m_range_array[index].end);
+            index = static_cast<u32>(::InterlockedIncrement(std::addressof(m_next_range)) - 1);
+        }
+    }
+
+    void SceneGraph::WorkerMain([[maybe_unused]] DelegateThread *thread, [[maybe_unused]] size_t message) {
+        this->ProcessRanges();
+
+        std::scoped_lock l(m_worker_cs);
+        m_pending_workers -= 1;
+        if (m_pending_workers == 0) {
+            m_worker_done_cv.Broadcast();
+        }
+    }
+
+    void SceneGraph::Initialize(SceneNode *root, const SceneGraphInfo *scene_graph_info) {
+        DD_ASSERT(root != nullptr);
+        DD_ASSERT(scene_graph_info->worker_count <= MaxWorkers);
+        DD_ASSERT(1 <= scene_graph_info->parallel_subtree_threshold);
+
+        m_root                       = root;
+        m_world_matrix_array         = nullptr;
+        m_world_matrix_capacity      = 0;
+        m_dirty_node_array           = nullptr;
+        m_dirty_node_count           = 0;
+        m_dirty_node_capacity        = 0;
+        m_range_array                = nullptr;
+        m_range_count                = 0;
+        m_range_capacity             = 0;
+        m_is_structure_dirty         = true;
+        m_parallel_subtree_threshold = scene_graph_info->parallel_subtree_threshold;
+        m_worker_count               = scene_graph_info->worker_count;
+        m_next_range                 = 0;
+        m_pending_workers            = 0;
+
+        /* Create workers */
+        if (m_worker_count == 0) { return; }
+
+        ConstructAt(m_worker_delegate, this, &SceneGraph::WorkerMain);
+        for (u32 i = 0; i < m_worker_count; ++i) {
+            ConstructAt(m_worker_thread_array[i], GetPointer(m_worker_delegate), scene_graph_info->worker_stack_size, WorkerExitCode, 4);
+        }
+    }
+
+    void SceneGraph::Finalize() {
+
+        /* Join workers */
+        for (u32 i = 0; i < m_worker_count; ++i) {
+            GetReference(m_worker_thread_array[i]).FinalizeThread();
+            DestructAt(m_worker_thread_array[i]);
+        }
+        if (m_worker_count != 0) {
+            DestructAt(m_worker_delegate);
+        }
+        m_worker_count = 0;
+
+        m_flat_tree.Finalize();
+        if (m_world_matrix_array != nullptr) {
+            delete[] m_world_matrix_array;
+        }
+        if (m_dirty_node_array != nullptr) {
+            delete[] m_dirty_node_array;
+        }
+        if (m_range_array != nullptr) {
+            delete[] m_range_array;
+        }
+        m_world_matrix_array = nullptr;
+        m_dirty_node_array   = nullptr;
+        m_range_array        = nullptr;
+    }
+
+    void SceneGraph::AddChild(SceneNode *parent, SceneNode *child) {
+        parent->GetTreeNode()->PushBackChild(child->GetTreeNode());
+        m_is_structure_dirty = true;
+    }
+
+    void SceneGraph::Detach(SceneNode *node) {
+        node->GetTreeNode()->DetachSubTree();
+        m_is_structure_dirty = true;
+    }
+
+    void SceneGraph::SetLocalMatrix(SceneNode *node, const math::Matrix34f& local_matrix) {
+        node->m_local_matrix = local_matrix;
+        this->MarkDirty(node);
+    }
+
+    void SceneGraph::MarkDirty(SceneNode *node) {
+        if (node->m_is_dirty == true) { return; }
+        node->m_is_dirty = true;
+
+        /* Grow dirty list if necessary */
+        if (m_dirty_node_count == m_dirty_node_capacity) {
+            const u32 capacity = (m_dirty_node_capacity == 0) ? DefaultCapacity : m_dirty_node_capacity * 2;
+
+            SceneNode **new_dirty_array = new (std::nothrow) SceneNode*[capacity];
+            DD_ASSERT(new_dirty_array != nullptr);
+
+            if (m_dirty_node_array != nullptr) {
+                ::memcpy(new_dirty_array, m_dirty_node_array, m_dirty_node_count * sizeof(SceneNode*));
+                delete[] m_dirty_node_array;
+            }
+            m_dirty_node_array    = new_dirty_array;
+            m_dirty_node_capacity = capacity;
+        }
+
+        m_dirty_node_array[m_dirty_node_count] = node;
+        ++m_dirty_node_count;
+    }
+
+    void SceneGraph::Update() {
+
+        /* Structural changes recompute the whole graph */
+        if (m_is_structure_dirty == true) {
+            this->RebuildStructure();
+
+            for (u32 i = 0; i < m_dirty_node_count; ++i) {
+                m_dirty_node_array[i]->m_is_dirty = false;
+            }
+            m_dirty_node_count = 0;
+            m_range_count      = 0;
+            this->PushRange(0, m_flat_tree.GetCount());
+        } else {
+            this->GatherDirtyRanges();
+        }
+
+        if (m_range_count == 0) { return; }
+
+        /* Update serially when there are no workers */
+        if (m_worker_count == 0) {
+            for (u32 i = 0; i < m_range_count; ++i) {
+                this->UpdateRange(m_range_array[i].begin, m_range_array[i].end);
+            }
+            return;
+        }
+
+        this->SplitRangesForWorkers();
+
+        /* Kick workers and help out on this thread */
+        m_next_range      = 0;
+        m_pending_workers = m_worker_count;
+        for (u32 i = 0; i < m_worker_count; ++i) {
+            GetReference(m_worker_thread_array[i]).SendMessage(WorkerRunMessage);
+        }
+
+        this->ProcessRanges();
+
+        std::scoped_lock l(m_worker_cs);
+        while (m_pending_workers != 0) {
+            m_worker_done_cv.Wait(std::addressof(m_worker_cs));
+        }
+    }
+}
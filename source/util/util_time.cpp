@@ -22,6 +22,67 @@ namespace dd::util {
         s64 last_frame_time = 0;
         s64 delta_tick = 0;
         double delta_time = 0;
+
+        bool is_tsc_clock = false;
+
+        /* Fixed point tick scales, value = (tick * scale) >> shift */
+        u64 ns_scale = 0;
+        u32 ns_shift = 0;
+        u64 ms_scale = 0;
+        u32 ms_shift = 0;
+
+        constexpr u32 TscCalibrationMs = 20;
+
+        s64 QueryCounter() {
+            LARGE_INTEGER tick = {};
+            const bool result = ::QueryPerformanceCounter(std::addressof(tick));
+            DD_ASSERT(result == true);
+            return tick.QuadPart;
+        }
+
+        bool IsInvariantTscSupported() {
+            u32 eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (__get_cpuid(0x8000'0007, std::addressof(eax), std::addressof(ebx), std::addressof(ecx), std::addressof(edx)) == 0) { return false; }
+            return (edx & (1 << 8)) != 0;
+        }
+
+        /* Brackets a counter read with two tsc reads and returns the tsc midpoint */
+        void SampleCounterAndTsc(s64 *out_counter, s64 *out_tsc) {
+            const u64 tsc_before = __rdtsc();
+            *out_counter         = QueryCounter();
+            const u64 tsc_after  = __rdtsc();
+            *out_tsc             = static_cast<s64>(tsc_before + ((tsc_after - tsc_before) >> 1));
+        }
+
+        s64 CalibrateTscFrequency(s64 counter_frequency) {
+            s64 counter_begin = 0, tsc_begin = 0;
+            SampleCounterAndTsc(std::addressof(counter_begin), std::addressof(tsc_begin));
+            ::Sleep(TscCalibrationMs);
+            s64 counter_end = 0, tsc_end = 0;
+            SampleCounterAndTsc(std::addressof(counter_end), std::addressof(tsc_end));
+
+            return static_cast<s64>((static_cast<unsigned __int128>(tsc_end - tsc_begin) * static_cast<u64>(counter_frequency)) / static_cast<u64>(counter_end - counter_begin));
+        }
+
+        /* Picks the largest shift that keeps the scale under 2^63, the only divides are done here */
+        void CalcTickScale(u64 units_per_second, u64 *out_scale, u32 *out_shift) {
+            const u64 frequency = static_cast<u64>(system_frequency);
+
+            u32 shift = 64;
+            while (((static_cast<unsigned __int128>(units_per_second) << shift) / frequency) >> 63 != 0) {
+                --shift;
+            }
+
+            /* Round up so whole seconds of ticks convert exactly */
+            *out_scale = static_cast<u64>(((static_cast<unsigned __int128>(units_per_second) << shift) + frequency - 1) / frequency);
+            *out_shift = shift;
+        }
+
+        inline s64 ScaleTick(s64 tick, u64 scale, u32 shift) {
+            const u64 magnitude = static_cast<u64>((tick < 0) ? -tick : tick);
+            const s64 value     = static_cast<s64>((static_cast<unsigned __int128>(magnitude) * scale) >> shift);
+            return (tick < 0) ? -value : value;
+        }
     }
 
     void InitializeTime() {
@@ -29,6 +90,15 @@ namespace dd::util {
         const bool result = ::QueryPerformanceFrequency(std::addressof(frequency));
         DD_ASSERT(result == true);
         system_frequency = frequency.QuadPart;
+
+        /* Prefer the tsc when it ticks at a constant rate across p-states and sleep states */
+        is_tsc_clock = IsInvariantTscSupported();
+        if (is_tsc_clock == true) {
+            system_frequency = CalibrateTscFrequency(frequency.QuadPart);
+        }
+
+        CalcTickScale(dd::util::math::TPow<u64, 10, 9>, std::addressof(ns_scale), std::addressof(ns_shift));
+        CalcTickScale(dd::util::math::TPow<u64, 10, 3>, std::addressof(ms_scale), std::addressof(ms_shift));
     }
 
     s64 GetSystemTickFrequency() {
@@ -36,23 +106,51 @@ namespace dd::util {
     }
 
     s64 GetSystemTick() {
-        LARGE_INTEGER tick = {};
-        const bool result = ::QueryPerformanceCounter(std::addressof(tick));
-        DD_ASSERT(result == true);
-        return tick.QuadPart;
+        if (is_tsc_clock == true) { return static_cast<s64>(__rdtsc()); }
+        return QueryCounter();
+    }
+
+    s64 GetSystemTickOrdered() {
+        if (is_tsc_clock == true) {
+            u32 aux = 0;
+            return static_cast<s64>(__rdtscp(std::addressof(aux)));
+        }
+        return QueryCounter();
+    }
+
+    bool IsTscClock() {
+        return is_tsc_clock;
     }
 
     void BeginFrame() {
         const s64 last_last_frame = last_frame_time;
         last_frame_time = GetSystemTick();
-        delta_tick = last_frame_time - last_last_frame;
+
+        /* The first frame has no previous frame to measure against, its delta would be the raw tick count */
+        delta_tick = (last_last_frame != 0) ? last_frame_time - last_last_frame : 0;
         delta_time = static_cast<double>(delta_tick) / static_cast<double>(system_frequency);
+
+        if (last_last_frame != 0) {
+            PushFrameTime(delta_tick);
+        }
     }
 
     s64 GetMillisecondsFromTick(s64 tick) {
-        return ((tick % system_frequency) * dd::util::math::TPow<s64, 10, 3> / system_frequency) + ((tick / system_frequency) * dd::util::math::TPow<s64, 10, 3>);
+        return ScaleTick(tick, ms_scale, ms_shift);
+    }
+
+    s64 GetNanosecondsFromTick(s64 tick) {
+        return ScaleTick(tick, ns_scale, ns_shift);
+    }
+    static_assert(dd::util::math::TPow<u64, 10, 3> == 1000);
+
+    void ResetFrameTime() {
+        last_frame_time = GetSystemTick();
+    }
+
+    s64 GetDeltaTick() {
+        return delta_tick;
     }
-    static_assert(dd::util::math::TPow<s64, 10, 3> == 1000);
 
     double GetDeltaTime() {
         return delta_time;
@@ -61,4 +159,129 @@ namespace dd::util {
     double CalcFps() {
         return static_cast<double>(system_frequency) / static_cast<double>(delta_tick);
     }
+
+    void FixedTimestep::Initialize(const FixedTimestepInfo *fixed_timestep_info) {
+        DD_ASSERT(fixed_timestep_info->step_rate != 0 && fixed_timestep_info->max_steps_per_frame != 0);
+
+        m_step_tick           = system_frequency / fixed_timestep_info->step_rate;
+        m_accumulated_tick    = 0;
+        m_dropped_tick        = 0;
+        m_step_count          = 0;
+        m_max_steps_per_frame = fixed_timestep_info->max_steps_per_frame;
+    }
+
+    void FixedTimestep::Accumulate(s64 delta_tick) {
+        m_accumulated_tick += delta_tick;
+
+        /* Clamp so a long frame can't demand more steps than the next frame can run */
+        const s64 max_tick = m_step_tick * m_max_steps_per_frame;
+        if (max_tick < m_accumulated_tick) {
+            m_dropped_tick     += m_accumulated_tick - max_tick;
+            m_accumulated_tick  = max_tick;
+        }
+    }
+
+    bool FixedTimestep::ConsumeStep() {
+        if (m_accumulated_tick < m_step_tick) { return false; }
+
+        m_accumulated_tick -= m_step_tick;
+        m_step_count       += 1;
+        return true;
+    }
+
+    float FixedTimestep::GetAlpha() const {
+        return static_cast<float>(static_cast<double>(m_accumulated_tick) / static_cast<double>(m_step_tick));
+    }
+
+    double FixedTimestep::GetStepTime() const {
+        return static_cast<double>(m_step_tick) / static_cast<double>(system_frequency);
+    }
+
+    void FrameLimiter::Initialize(const FrameLimiterInfo *frame_limiter_info) {
+        DD_ASSERT(frame_limiter_info->min_spin_margin_us <= frame_limiter_info->max_spin_margin_us);
+
+        const s64 tick_per_us = system_frequency / dd::util::math::TPow<s64, 10, 6>;
+
+        m_frame_tick           = (frame_limiter_info->target_rate == 0) ? 0 : system_frequency / frame_limiter_info->target_rate;
+        m_deadline_tick        = 0;
+        m_min_spin_margin_tick = frame_limiter_info->min_spin_margin_us * tick_per_us;
+        m_max_spin_margin_tick = frame_limiter_info->max_spin_margin_us * tick_per_us;
+        m_spin_margin_tick     = m_max_spin_margin_tick;
+        m_last_error_tick      = 0;
+        m_max_error_tick       = 0;
+        m_total_error_tick     = 0;
+        m_frame_count          = 0;
+
+        if (m_frame_tick == 0) { return; }
+
+        /* Prefer a high resolution timer, older systems fall back to the default timer resolution */
+        m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (m_timer == nullptr) {
+            m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+        DD_ASSERT(m_timer != nullptr);
+    }
+
+    void FrameLimiter::Finalize() {
+        if (m_timer != nullptr) {
+            ::CloseHandle(m_timer);
+        }
+        m_timer      = nullptr;
+        m_frame_tick = 0;
+    }
+
+    void FrameLimiter::SleepUntil(s64 wake_tick) {
+        const s64 sleep_tick = wake_tick - GetSystemTick();
+        if (sleep_tick <= 0) { return; }
+
+        /* Relative due time in 100ns units */
+        LARGE_INTEGER due_time = {};
+        due_time.QuadPart = -(GetNanosecondsFromTick(sleep_tick) / 100);
+        if (due_time.QuadPart == 0) { return; }
+
+        const bool result0 = ::SetWaitableTimer(m_timer, std::addressof(due_time), 0, nullptr, nullptr, false);
+        DD_ASSERT(result0 == true);
+        const u32 result1 = ::WaitForSingleObject(m_timer, INFINITE);
+        DD_ASSERT(result1 == WAIT_OBJECT_0);
+
+        /* Track oversleep, the margin rises at once and decays slowly */
+        const s64 oversleep_tick = GetSystemTick() - wake_tick;
+        const s64 decayed_tick   = m_spin_margin_tick - (m_spin_margin_tick >> 6);
+        const s64 margin_tick    = (decayed_tick < oversleep_tick) ? oversleep_tick + (oversleep_tick >> 2) : decayed_tick;
+        m_spin_margin_tick = (margin_tick < m_min_spin_margin_tick) ? m_min_spin_margin_tick : (m_max_spin_margin_tick < margin_tick) ? m_max_spin_margin_tick : margin_tick;
+    }
+
+    void FrameLimiter::Wait() {
+        if (m_frame_tick == 0) { return; }
+
+        /* Restart pacing after the first frame or a frame that overran by more than a full period */
+        const s64 now_tick = GetSystemTick();
+        m_deadline_tick += m_frame_tick;
+        if (m_deadline_tick + m_frame_tick < now_tick || m_frame_count == 0) {
+            m_deadline_tick = now_tick + m_frame_tick;
+        }
+
+        /* Sleep the bulk, spin the remainder */
+        this->SleepUntil(m_deadline_tick - m_spin_margin_tick);
+
+        s64 wake_tick = GetSystemTick();
+        while (wake_tick < m_deadline_tick) {
+            _mm_pause();
+            wake_tick = GetSystemTick();
+        }
+
+        /* Record pacing error */
+        m_last_error_tick   = wake_tick - m_deadline_tick;
+        m_max_error_tick    = (m_max_error_tick < m_last_error_tick) ? m_last_error_tick : m_max_error_tick;
+        m_total_error_tick += m_last_error_tick;
+        m_frame_count      += 1;
+    }
+
+    void FrameLimiter::GetPacingStats(FramePacingStats *out_pacing_stats) const {
+        out_pacing_stats->last_error_ns  = GetNanosecondsFromTick(m_last_error_tick);
+        out_pacing_stats->max_error_ns   = GetNanosecondsFromTick(m_max_error_tick);
+        out_pacing_stats->avg_error_ns   = (m_frame_count == 0) ? 0 : GetNanosecondsFromTick(m_total_error_tick) / static_cast<s64>(m_frame_count);
+        out_pacing_stats->spin_margin_ns = GetNanosecondsFromTick(m_spin_margin_tick);
+        out_pacing_stats->frame_count    = m_frame_count;
+    }
 }
@@ -687,6 +687,144 @@ namespace dd::vk {
         texture->SetImageLayout(barrier_state->vk_dst_layout);
     }
     
+    void CommandBuffer::SetTextureMipStateTransition(Texture *texture, const TextureBarrierCmdState *barrier_state, u32 base_mip, u32 mip_count) {
+
+        /* Image memory barrier over a mip range */
+        const VkImageMemoryBarrier2 image_barrier = {
+            .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask  = barrier_state->vk_src_stage_mask,
+            .srcAccessMask = barrier_state->vk_src_access_mask,
+            .dstStageMask  = barrier_state->vk_dst_stage_mask,
+            .dstAccessMask = barrier_state->vk_dst_access_mask,
+            .oldLayout     = barrier_state->vk_src_layout,
+            .newLayout     = barrier_state->vk_dst_layout,
+            .image         = texture->GetImage(),
+            .subresourceRange = {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel   = base_mip,
+                .levelCount     = mip_count,
+                .baseArrayLayer = 0,
+                .layerCount     = VK_REMAINING_ARRAY_LAYERS
+            }
+        };
+
+        const VkDependencyInfo dependency_info = {
+            .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers    = std::addressof(image_barrier)
+        };
+
+        ::pfn_vkCmdPipelineBarrier2(m_vk_command_buffer, std::addressof(dependency_info));
+    }
+
+    void CommandBuffer::GenerateMipmaps(const Context *context, Texture *texture) {
+
+        const u32 mip_levels = texture->GetMipLevels();
+        if (mip_levels <= 1) { return; }
+
+        /* Block compressed levels can't be blitted, they must be cooked with their mips */
+        DD_ASSERT(IsBlockCompressedFormat(texture->GetFormat()) == false);
+        DD_ASSERT(context->IsMipmapGenerationFormatSupported(static_cast<VkFormat>(texture->GetFormat())) == true);
+        DD_ASSERT((texture->GetUsageFlags() & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)) == (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+
+        this->EndRenderingIfRendering();
+
+        /* Relocate memory pool to device memory if required */
+        if (texture->RequiresRelocation() == true) {
+            texture->Relocate(m_vk_command_buffer);
+        }
+
+        /* Levels are handed back in the layout the texture was uploaded in, descriptors registered before the blits recorded it */
+        const VkImageLayout sample_layout = (texture->GetImageLayout() != VK_IMAGE_LAYOUT_UNDEFINED) ? texture->GetImageLayout() : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        /* Level 0 becomes the first blit source, the rest are overwritten so their contents are discarded */
+        const TextureBarrierCmdState source_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_BLIT_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+            .vk_dst_access_mask = VK_ACCESS_2_TRANSFER_READ_BIT,
+            .vk_src_layout      = texture->GetImageLayout(),
+            .vk_dst_layout      = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+        };
+        this->SetTextureMipStateTransition(texture, std::addressof(source_barrier_state), 0, 1);
+
+        const TextureBarrierCmdState destination_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_BLIT_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_NONE,
+            .vk_dst_access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .vk_src_layout      = VK_IMAGE_LAYOUT_UNDEFINED,
+            .vk_dst_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+        };
+        this->SetTextureMipStateTransition(texture, std::addressof(destination_barrier_state), 1, mip_levels - 1);
+
+        /* Each level is blitted from the previous one, sRGB formats are filtered in linear space by the blit */
+        const TextureBarrierCmdState blit_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_BLIT_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_BLIT_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .vk_dst_access_mask = VK_ACCESS_2_TRANSFER_READ_BIT,
+            .vk_src_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .vk_dst_layout      = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+        };
+
+        s32 mip_width  = static_cast<s32>(texture->GetWidth());
+        s32 mip_height = static_cast<s32>(texture->GetHeight());
+        for (u32 i = 1; i < mip_levels; ++i) {
+            const s32 next_width  = (1 < mip_width)  ? mip_width / 2  : 1;
+            const s32 next_height = (1 < mip_height) ? mip_height / 2 : 1;
+
+            const VkImageBlit2 blit_region = {
+                .sType          = VK_STRUCTURE_TYPE_IMAGE_BLIT_2,
+                .srcSubresource = {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = i - 1,
+                    .baseArrayLayer = 0,
+                    .layerCount     = texture->GetArrayLayers()
+                },
+                .srcOffsets     = { { 0, 0, 0 }, { mip_width, mip_height, 1 } },
+                .dstSubresource = {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = i,
+                    .baseArrayLayer = 0,
+                    .layerCount     = texture->GetArrayLayers()
+                },
+                .dstOffsets     = { { 0, 0, 0 }, { next_width, next_height, 1 } }
+            };
+
+            const VkBlitImageInfo2 blit_info = {
+                .sType          = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2,
+                .srcImage       = texture->GetImage(),
+                .srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .dstImage       = texture->GetImage(),
+                .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .regionCount    = 1,
+                .pRegions       = std::addressof(blit_region),
+                .filter         = VK_FILTER_LINEAR
+            };
+            ::pfn_vkCmdBlitImage2(m_vk_command_buffer, std::addressof(blit_info));
+
+            /* The written level is the next source */
+            this->SetTextureMipStateTransition(texture, std::addressof(blit_barrier_state), i, 1);
+
+            mip_width  = next_width;
+            mip_height = next_height;
+        }
+
+        /* Hand every level to the shaders */
+        const TextureBarrierCmdState read_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_BLIT_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .vk_dst_access_mask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+            .vk_src_layout      = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .vk_dst_layout      = sample_layout
+        };
+        this->SetTextureMipStateTransition(texture, std::addressof(read_barrier_state), 0, mip_levels);
+
+        texture->SetImageLayout(sample_layout);
+    }
+
     void CommandBuffer::SetDescriptorPool(const DescriptorPool *descriptor_pool) {
 
         VkDescriptorSet vk_descriptor_set = descriptor_pool->GetDescriptorSet();
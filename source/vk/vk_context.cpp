@@ -45,6 +45,11 @@ namespace dd::vk {
         };
         constexpr u32 DeviceExtensionCount = sizeof(DeviceExtensions) / sizeof(const char*);
         
+        /* Chained after the required features only when the device supports host image copy */
+        constinit VkPhysicalDeviceHostImageCopyFeaturesEXT TargetDeviceHostImageCopyFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+            .hostImageCopy = VK_TRUE
+        };
         constinit VkPhysicalDeviceExtendedDynamicState2FeaturesEXT TargetDeviceExtendedDynamicStateFeatures = {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT,
             .extendedDynamicState2LogicOp = VK_TRUE
@@ -331,6 +336,102 @@ namespace dd::vk {
         return false;
     }
 
+    void Context::QueryHostImageCopySupport(const ContextInfo *context_info) {
+
+        m_is_host_image_copy_supported = false;
+        m_vk_host_image_copy_layout    = VK_IMAGE_LAYOUT_GENERAL;
+        if (context_info->is_host_image_copy_allowed == false) { return; }
+
+        /* Check extension */
+        u32 extension_count = 0;
+        const u32 result0 = pfn_vkEnumerateDeviceExtensionProperties(m_vk_physical_device, nullptr, std::addressof(extension_count), nullptr);
+        DD_ASSERT(result0 == VK_SUCCESS);
+
+        VkExtensionProperties *extension_array = new (std::nothrow) VkExtensionProperties[extension_count];
+        DD_ASSERT(extension_array != nullptr);
+
+        const u32 result1 = pfn_vkEnumerateDeviceExtensionProperties(m_vk_physical_device, nullptr, std::addressof(extension_count), extension_array);
+        DD_ASSERT(result1 == VK_SUCCESS);
+
+        bool has_extension = false;
+        for (u32 i = 0; i < extension_count; ++i) {
+            if (::strcmp(extension_array[i].extensionName, VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME) == 0) {
+                has_extension = true;
+                break;
+            }
+        }
+        delete[] extension_array;
+
+        if (has_extension == false) { return; }
+
+        /* Check feature */
+        VkPhysicalDeviceHostImageCopyFeaturesEXT host_image_copy_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT
+        };
+        VkPhysicalDeviceFeatures2 features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = std::addressof(host_image_copy_features)
+        };
+        pfn_vkGetPhysicalDeviceFeatures2(m_vk_physical_device, std::addressof(features));
+
+        if (host_image_copy_features.hostImageCopy == VK_FALSE) { return; }
+
+        /* Textures are pooled by their regular memory requirements, host transfer usage must not change the memory type */
+        VkPhysicalDeviceHostImageCopyPropertiesEXT host_image_copy_properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT
+        };
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = std::addressof(host_image_copy_properties)
+        };
+        pfn_vkGetPhysicalDeviceProperties2(m_vk_physical_device, std::addressof(properties));
+
+        if (host_image_copy_properties.identicalMemoryTypeRequirements == VK_FALSE) { return; }
+
+        /* Prefer copying straight into the sampled layout, general is always a valid destination */
+        VkImageLayout *dst_layout_array = new (std::nothrow) VkImageLayout[host_image_copy_properties.copyDstLayoutCount];
+        DD_ASSERT(dst_layout_array != nullptr);
+
+        host_image_copy_properties.pCopyDstLayouts = dst_layout_array;
+        pfn_vkGetPhysicalDeviceProperties2(m_vk_physical_device, std::addressof(properties));
+
+        for (u32 i = 0; i < host_image_copy_properties.copyDstLayoutCount; ++i) {
+            if (dst_layout_array[i] == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+                m_vk_host_image_copy_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                break;
+            }
+        }
+        delete[] dst_layout_array;
+
+        m_is_host_image_copy_supported = true;
+    }
+
+    bool Context::IsHostImageCopyFormatSupported(VkFormat vk_format) const {
+        if (m_is_host_image_copy_supported == false) { return false; }
+
+        VkFormatProperties3 format_properties_3 = {
+            .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3
+        };
+        VkFormatProperties2 format_properties = {
+            .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+            .pNext = std::addressof(format_properties_3)
+        };
+        pfn_vkGetPhysicalDeviceFormatProperties2(m_vk_physical_device, vk_format, std::addressof(format_properties));
+
+        return (format_properties_3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) != 0;
+    }
+
+    bool Context::IsMipmapGenerationFormatSupported(VkFormat vk_format) const {
+
+        VkFormatProperties2 format_properties = {
+            .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2
+        };
+        pfn_vkGetPhysicalDeviceFormatProperties2(m_vk_physical_device, vk_format, std::addressof(format_properties));
+
+        constexpr VkFormatFeatureFlags RequiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (format_properties.formatProperties.optimalTilingFeatures & RequiredFeatures) == RequiredFeatures;
+    }
+
     bool Context::FindGraphicsQueueFamily(u32 *queue_family_index) {
         u32 queue_family_count = 0;
         pfn_vkGetPhysicalDeviceQueueFamilyProperties(m_vk_physical_device, std::addressof(queue_family_count), nullptr);
@@ -360,7 +461,7 @@ namespace dd::vk {
         return false;
     }
 
-    Context::Context() : m_window_cs(), m_present_cs() {
+    Context::Context(const ContextInfo *context_info) : m_window_cs(), m_present_cs() {
 
         dd::vk::SetGlobalContext(this);
         ::LoadInitialVkCProcs();
@@ -426,6 +527,10 @@ namespace dd::vk {
             DD_ASSERT(result == VK_SUCCESS);
         #endif
 
+        /* Drawable event is signalled whenever the window has a non zero size */
+        m_drawable_event = ::CreateEvent(nullptr, true, true, nullptr);
+        DD_ASSERT(m_drawable_event != nullptr);
+
         /* Create Window */
         const HINSTANCE process_handle = ::GetModuleHandle(nullptr);
         const WNDCLASS wc = {
@@ -468,6 +573,8 @@ namespace dd::vk {
         bool b_result0 = this->PickValidPhysicalDevice();
         DD_ASSERT(b_result0 == true);
 
+        this->QueryHostImageCopySupport(context_info);
+
         /* Obtain a valid graphics queue family */
         u32 graphics_queue_family_index = 0;
         bool b_result1 = this->FindGraphicsQueueFamily(std::addressof(graphics_queue_family_index));
@@ -484,13 +591,23 @@ namespace dd::vk {
             .pQueuePriorities = std::addressof(priority)
         };
 
+        /* Append optional extensions after the required ones */
+        const char *device_extension_array[DeviceExtensionCount + 1] = {};
+        ::memcpy(device_extension_array, DeviceExtensions, sizeof(DeviceExtensions));
+        u32 device_extension_count = DeviceExtensionCount;
+        if (m_is_host_image_copy_supported == true) {
+            device_extension_array[device_extension_count] = VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME;
+            ++device_extension_count;
+            TargetDeviceExtendedDynamicStateFeatures.pNext = std::addressof(TargetDeviceHostImageCopyFeatures);
+        }
+
         const VkDeviceCreateInfo device_info = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .pNext = std::addressof(TargetDeviceFeatures),
             .queueCreateInfoCount = 1,
             .pQueueCreateInfos = std::addressof(device_queue_info),
-            .enabledExtensionCount = DeviceExtensionCount,
-            .ppEnabledExtensionNames = DeviceExtensions,
+            .enabledExtensionCount = device_extension_count,
+            .ppEnabledExtensionNames = device_extension_array,
             .pEnabledFeatures = nullptr
         };
 
@@ -697,11 +814,15 @@ namespace dd::vk {
         if (m_vk_physical_device_array != nullptr) {
             delete[] m_vk_physical_device_array;
         }
+
+        ::CloseHandle(m_drawable_event);
     }
 
     /* Presentation */
     void Context::PresentAsync(util::DelegateThread *thread, size_t message) {
         DD_ASSERT(thread->GetExitCode() != message);
+        util::SetProfilerThreadName("Present");
+        DD_PROFILE_SCOPE("Present");
 
         this->Present(reinterpret_cast<CommandBuffer*>(message));
     }
@@ -754,6 +875,13 @@ namespace dd::vk {
         m_present_cs.Leave();
     }
 
+    void Context::SubmitGraphicsQueue(const VkSubmitInfo2 *submit_info, VkFence vk_fence) {
+        std::scoped_lock l(m_present_cs);
+
+        const u32 result0 = pfn_vkQueueSubmit2(m_vk_graphics_queue, 1, submit_info, vk_fence);
+        DD_ASSERT(result0 == VK_SUCCESS);
+    }
+
     void Context::WaitForGpu() {
 
         /* Bail if draw is skipped */
@@ -18,6 +18,7 @@
 #define DEFINE_VK_PROC(name) PFN_##name pfn_##name
 #define LOAD_INITIAL_VK_PROC(name) pfn_##name = reinterpret_cast<PFN_##name>(::GetProcAddress(vulkan_dll, #name)); DD_ASSERT(pfn_##name != nullptr);
 #define LOAD_DEVICE_VK_PROC(name) pfn_##name = reinterpret_cast<PFN_##name>(::pfn_vkGetDeviceProcAddr(device, #name)); DD_ASSERT(pfn_##name != nullptr);
+#define LOAD_OPTIONAL_DEVICE_VK_PROC(name) pfn_##name = reinterpret_cast<PFN_##name>(::pfn_vkGetDeviceProcAddr(device, #name));
 #define LOAD_INSTANCE_VK_PROC(name) pfn_##name = reinterpret_cast<PFN_##name>(::pfn_vkGetInstanceProcAddr(instance, #name)); DD_ASSERT(pfn_##name != nullptr);
 
 HMODULE vulkan_dll = nullptr;
@@ -328,6 +329,10 @@ DEFINE_VK_PROC(vkGetMemoryHostPointerPropertiesEXT);
 DEFINE_VK_PROC(vkCmdSetLogicOpEXT);
 DEFINE_VK_PROC(vkCmdSetVertexInputEXT);
 
+/* Optional device extension procs */
+DEFINE_VK_PROC(vkCopyMemoryToImageEXT);
+DEFINE_VK_PROC(vkTransitionImageLayoutEXT);
+
 void LoadCProcsDevice(VkDevice device) {
     LOAD_DEVICE_VK_PROC(vkAcquireNextImage2KHR);
     LOAD_DEVICE_VK_PROC(vkAcquireNextImageKHR);
@@ -525,4 +530,6 @@ void LoadCProcsDevice(VkDevice device) {
     LOAD_DEVICE_VK_PROC(vkGetMemoryHostPointerPropertiesEXT);
     LOAD_DEVICE_VK_PROC(vkCmdSetLogicOpEXT);
     LOAD_DEVICE_VK_PROC(vkCmdSetVertexInputEXT);
+    LOAD_OPTIONAL_DEVICE_VK_PROC(vkCopyMemoryToImageEXT);
+    LOAD_OPTIONAL_DEVICE_VK_PROC(vkTransitionImageLayoutEXT);
 }
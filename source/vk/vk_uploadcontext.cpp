@@ -0,0 +1,376 @@
+ /*
+ *  Copyright (C) W. Michael Knudson
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along with this program; 
+ *  if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <dd.hpp>
+
+namespace dd::vk {
+
+    namespace {
+
+        void RecordTextureBarrier(VkCommandBuffer vk_command_buffer, Texture *texture, const TextureBarrierCmdState *barrier_state) {
+
+            /* Image memory barrier over every subresource */
+            const VkImageMemoryBarrier2 image_barrier = {
+                .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .srcStageMask  = barrier_state->vk_src_stage_mask,
+                .srcAccessMask = barrier_state->vk_src_access_mask,
+                .dstStageMask  = barrier_state->vk_dst_stage_mask,
+                .dstAccessMask = barrier_state->vk_dst_access_mask,
+                .oldLayout     = barrier_state->vk_src_layout,
+                .newLayout     = barrier_state->vk_dst_layout,
+                .image         = texture->GetImage(),
+                .subresourceRange = {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel   = 0,
+                    .levelCount     = VK_REMAINING_MIP_LEVELS,
+                    .baseArrayLayer = 0,
+                    .layerCount     = VK_REMAINING_ARRAY_LAYERS
+                }
+            };
+
+            const VkDependencyInfo dependency_info = {
+                .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .imageMemoryBarrierCount = 1,
+                .pImageMemoryBarriers    = std::addressof(image_barrier)
+            };
+
+            ::pfn_vkCmdPipelineBarrier2(vk_command_buffer, std::addressof(dependency_info));
+
+            texture->SetImageLayout(barrier_state->vk_dst_layout);
+        }
+    }
+
+    void UploadContext::Initialize(Context *context, const UploadContextInfo *upload_context_info) {
+
+        /* Batches are submitted and retired on the context they were created with */
+        m_context = context;
+
+        /* Staging offsets must be a multiple of any texel or block size, the device's optimal copy alignment is used when larger */
+        const size_t optimal_alignment = context->GetPhysicalDeviceProperties()->properties.limits.optimalBufferCopyOffsetAlignment;
+        m_staging_alignment      = (MinStagingAlignment < optimal_alignment) ? optimal_alignment : MinStagingAlignment;
+        m_staging_size           = util::AlignUp(upload_context_info->staging_size, m_staging_alignment);
+        m_ring_head              = 0;
+        m_ring_tail              = 0;
+        m_current_batch          = 0;
+        m_oldest_batch           = 0;
+        m_pending_batch_count    = 0;
+        m_is_recording           = false;
+        m_is_staging_outstanding = false;
+
+        /* Create staging buffer */
+        const u32 queue_family_index = context->GetGraphicsQueueFamilyIndex();
+        const VkBufferCreateInfo buffer_create_info = {
+            .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size                  = m_staging_size,
+            .usage                 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices   = std::addressof(queue_family_index)
+        };
+
+        const u32 result0 = ::pfn_vkCreateBuffer(context->GetDevice(), std::addressof(buffer_create_info), nullptr, std::addressof(m_vk_staging_buffer));
+        DD_ASSERT(result0 == VK_SUCCESS);
+
+        /* Allocate staging memory */
+        VkMemoryRequirements memory_requirements = {};
+        ::pfn_vkGetBufferMemoryRequirements(context->GetDevice(), m_vk_staging_buffer, std::addressof(memory_requirements));
+
+        /* Decoders write straight into the ring and may read it back, prefer cached memory over write combined */
+        s32 host_memory_type = context->FindMemoryHeapIndex(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        if (host_memory_type == -1) {
+            host_memory_type = context->FindMemoryHeapIndex(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+        DD_ASSERT(host_memory_type != -1);
+
+        const VkMemoryAllocateInfo host_allocate_info = {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize  = memory_requirements.size,
+            .memoryTypeIndex = static_cast<u32>(host_memory_type)
+        };
+        const u32 result1 = ::pfn_vkAllocateMemory(context->GetDevice(), std::addressof(host_allocate_info), nullptr, std::addressof(m_vk_staging_memory));
+        DD_ASSERT(result1 == VK_SUCCESS);
+
+        const u32 result2 = ::pfn_vkBindBufferMemory(context->GetDevice(), m_vk_staging_buffer, m_vk_staging_memory, 0);
+        DD_ASSERT(result2 == VK_SUCCESS);
+
+        /* Map the ring for the lifetime of the context */
+        void *staging_address = nullptr;
+        const u32 result3 = ::pfn_vkMapMemory(context->GetDevice(), m_vk_staging_memory, 0, VK_WHOLE_SIZE, 0, std::addressof(staging_address));
+        DD_ASSERT(result3 == VK_SUCCESS);
+        m_staging_address = reinterpret_cast<u8*>(staging_address);
+
+        /* Create command pool, batch command buffers are reset when begun */
+        const VkCommandPoolCreateInfo command_pool_info = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = queue_family_index
+        };
+
+        const u32 result4 = ::pfn_vkCreateCommandPool(context->GetDevice(), std::addressof(command_pool_info), nullptr, std::addressof(m_vk_command_pool));
+        DD_ASSERT(result4 == VK_SUCCESS);
+
+        /* Create batches */
+        const VkCommandBufferAllocateInfo allocate_info = {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool        = m_vk_command_pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        const VkFenceCreateInfo fence_info = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+        };
+
+        for (u32 i = 0; i < MaxBatchesInFlight; ++i) {
+            const u32 result5 = ::pfn_vkAllocateCommandBuffers(context->GetDevice(), std::addressof(allocate_info), std::addressof(m_batch_array[i].vk_command_buffer));
+            DD_ASSERT(result5 == VK_SUCCESS);
+
+            const u32 result6 = ::pfn_vkCreateFence(context->GetDevice(), std::addressof(fence_info), nullptr, std::addressof(m_batch_array[i].vk_fence));
+            DD_ASSERT(result6 == VK_SUCCESS);
+
+            m_batch_array[i].ring_end = 0;
+        }
+    }
+
+    void UploadContext::Finalize(const Context *context) {
+
+        this->WaitIdle();
+
+        /* Destroy batches */
+        for (u32 i = 0; i < MaxBatchesInFlight; ++i) {
+            ::pfn_vkDestroyFence(context->GetDevice(), m_batch_array[i].vk_fence, nullptr);
+            ::pfn_vkFreeCommandBuffers(context->GetDevice(), m_vk_command_pool, 1, std::addressof(m_batch_array[i].vk_command_buffer));
+            m_batch_array[i].vk_fence          = 0;
+            m_batch_array[i].vk_command_buffer = nullptr;
+        }
+        ::pfn_vkDestroyCommandPool(context->GetDevice(), m_vk_command_pool, nullptr);
+        m_vk_command_pool = 0;
+
+        /* Destroy staging ring */
+        ::pfn_vkUnmapMemory(context->GetDevice(), m_vk_staging_memory);
+        ::pfn_vkDestroyBuffer(context->GetDevice(), m_vk_staging_buffer, nullptr);
+        ::pfn_vkFreeMemory(context->GetDevice(), m_vk_staging_memory, nullptr);
+        m_staging_address   = nullptr;
+        m_vk_staging_buffer = 0;
+        m_vk_staging_memory = 0;
+        m_context           = nullptr;
+    }
+
+    void UploadContext::BeginBatchIfNotRecording() {
+        if (m_is_recording == true) { return; }
+
+        /* Every batch is in flight, the next one to record is the oldest */
+        if (m_pending_batch_count == MaxBatchesInFlight) {
+            this->RetireOldestBatch();
+        }
+
+        const VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        };
+
+        const u32 result0 = ::pfn_vkBeginCommandBuffer(m_batch_array[m_current_batch].vk_command_buffer, std::addressof(begin_info));
+        DD_ASSERT(result0 == VK_SUCCESS);
+
+        m_is_recording = true;
+    }
+
+    void UploadContext::RetireOldestBatch() {
+        DD_ASSERT(m_pending_batch_count != 0);
+
+        /* Wait for the batch, its span of the ring is free afterwards */
+        Batch *batch = std::addressof(m_batch_array[m_oldest_batch]);
+
+        const u32 result0 = ::pfn_vkWaitForFences(m_context->GetDevice(), 1, std::addressof(batch->vk_fence), VK_TRUE, UINT64_MAX);
+        DD_ASSERT(result0 == VK_SUCCESS);
+
+        const u32 result1 = ::pfn_vkResetFences(m_context->GetDevice(), 1, std::addressof(batch->vk_fence));
+        DD_ASSERT(result1 == VK_SUCCESS);
+
+        m_ring_tail    = batch->ring_end;
+        m_oldest_batch = (m_oldest_batch + 1) % MaxBatchesInFlight;
+        --m_pending_batch_count;
+    }
+
+    void UploadContext::SetTextureCopyState(Texture *texture) {
+
+        /* Existing contents are kept so a texture can be filled over several calls */
+        const TextureBarrierCmdState copy_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_NONE,
+            .vk_dst_access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .vk_src_layout      = texture->GetImageLayout(),
+            .vk_dst_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+        };
+        RecordTextureBarrier(m_batch_array[m_current_batch].vk_command_buffer, texture, std::addressof(copy_barrier_state));
+    }
+
+    void UploadContext::SetTextureSampleState(Texture *texture) {
+
+        /* Later submissions on the graphics queue are ordered after this barrier */
+        const TextureBarrierCmdState sample_barrier_state = {
+            .vk_src_stage_mask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .vk_dst_stage_mask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .vk_src_access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .vk_dst_access_mask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT,
+            .vk_src_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .vk_dst_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+        RecordTextureBarrier(m_batch_array[m_current_batch].vk_command_buffer, texture, std::addressof(sample_barrier_state));
+    }
+
+    void UploadContext::RecordCopy(Texture *texture, VkDeviceSize staging_offset, u32 mip_level, u32 array_layer) {
+        DD_ASSERT(mip_level < texture->GetMipLevels() && array_layer < texture->GetArrayLayers());
+
+        /* Rows are tightly packed, block compressed mips use their texel extent */
+        const VkBufferImageCopy2 copy_region = {
+            .sType             = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+            .bufferOffset      = staging_offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel       = mip_level,
+                .baseArrayLayer = array_layer,
+                .layerCount     = 1
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { texture->GetMipWidth(mip_level), texture->GetMipHeight(mip_level), 1 }
+        };
+
+        const VkCopyBufferToImageInfo2 copy_info = {
+            .sType          = VK_STRUCTURE_TYPE_COPY_BUFFER_TO_IMAGE_INFO_2,
+            .srcBuffer      = m_vk_staging_buffer,
+            .dstImage       = texture->GetImage(),
+            .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .regionCount    = 1,
+            .pRegions       = std::addressof(copy_region)
+        };
+        ::pfn_vkCmdCopyBufferToImage2(m_batch_array[m_current_batch].vk_command_buffer, std::addressof(copy_info));
+    }
+
+    void *UploadContext::AllocateStaging(size_t size, VkDeviceSize *out_staging_offset) {
+        DD_ASSERT(m_is_staging_outstanding == false);
+
+        const u64 aligned_size = util::AlignUp(static_cast<u64>(size), m_staging_alignment);
+        DD_ASSERT(aligned_size <= m_staging_size);
+
+        this->RecycleCompletedBatches();
+
+        /* Allocations never straddle the end of the ring, the remainder is skipped */
+        u64 head              = m_ring_head;
+        const u64 ring_offset = head % m_staging_size;
+        if (m_staging_size < ring_offset + aligned_size) {
+            head += m_staging_size - ring_offset;
+        }
+
+        /* Wait on the oldest batches until enough of the ring is free */
+        while (m_staging_size < (head + aligned_size) - m_ring_tail) {
+
+            /* Once every batch has retired the skipped remainder is free as well */
+            if (m_pending_batch_count == 0 && m_is_recording == false) {
+                m_ring_tail = head;
+                break;
+            }
+
+            /* The batch being recorded holds the space, submit it first */
+            if (m_pending_batch_count == 0) {
+                this->Flush();
+            }
+            this->RetireOldestBatch();
+        }
+
+        this->BeginBatchIfNotRecording();
+
+        m_ring_head              = head + aligned_size;
+        m_is_staging_outstanding = true;
+
+        *out_staging_offset = head % m_staging_size;
+        return m_staging_address + *out_staging_offset;
+    }
+
+    void UploadContext::CopyStagingToTexture(Texture *texture, const TextureCopyRegion *region_array, u32 region_count) {
+
+        this->BeginBatchIfNotRecording();
+
+        this->SetTextureCopyState(texture);
+        for (u32 i = 0; i < region_count; ++i) {
+            this->RecordCopy(texture, region_array[i].staging_offset, region_array[i].mip_level, region_array[i].array_layer);
+        }
+        this->SetTextureSampleState(texture);
+
+        m_is_staging_outstanding = false;
+    }
+
+    void UploadContext::UploadTexture(Texture *texture, const TextureUploadRegion *region_array, u32 region_count) {
+
+        this->BeginBatchIfNotRecording();
+
+        /* A full ring may submit the batch between regions, the layout carries over to the next batch */
+        this->SetTextureCopyState(texture);
+        for (u32 i = 0; i < region_count; ++i) {
+            VkDeviceSize staging_offset = 0;
+            void *staging = this->AllocateStaging(region_array[i].size, std::addressof(staging_offset));
+            ::memcpy(staging, region_array[i].data, region_array[i].size);
+
+            this->RecordCopy(texture, staging_offset, region_array[i].mip_level, region_array[i].array_layer);
+            m_is_staging_outstanding = false;
+        }
+        this->SetTextureSampleState(texture);
+    }
+
+    void UploadContext::Flush() {
+        if (m_is_recording == false) { return; }
+        DD_ASSERT(m_is_staging_outstanding == false);
+
+        Batch *batch = std::addressof(m_batch_array[m_current_batch]);
+
+        const u32 result0 = ::pfn_vkEndCommandBuffer(batch->vk_command_buffer);
+        DD_ASSERT(result0 == VK_SUCCESS);
+
+        /* Submit batch */
+        const VkCommandBufferSubmitInfo command_submit_info = {
+            .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = batch->vk_command_buffer
+        };
+
+        const VkSubmitInfo2 submit_info = {
+            .sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos    = std::addressof(command_submit_info)
+        };
+
+        m_context->SubmitGraphicsQueue(std::addressof(submit_info), batch->vk_fence);
+
+        batch->ring_end = m_ring_head;
+
+        m_current_batch  = (m_current_batch + 1) % MaxBatchesInFlight;
+        m_is_recording   = false;
+        ++m_pending_batch_count;
+    }
+
+    void UploadContext::RecycleCompletedBatches() {
+        while (m_pending_batch_count != 0 && ::pfn_vkGetFenceStatus(m_context->GetDevice(), m_batch_array[m_oldest_batch].vk_fence) == VK_SUCCESS) {
+            this->RetireOldestBatch();
+        }
+    }
+
+    void UploadContext::WaitIdle() {
+        this->Flush();
+        while (m_pending_batch_count != 0) {
+            this->RetireOldestBatch();
+        }
+    }
+}